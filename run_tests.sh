@@ -1,7 +1,7 @@
 #!/bin/bash
 
 build_dir=build
-tests="game matrix neuralnet test stack"
+tests="game matrix neuralnet test stack opening_book tablebase position_rank pn_search game_state"
 
 for t in $tests
 do
@@ -1,18 +1,56 @@
 #ifndef __AI_H__
 #define __AI_H__
 
+#include <stdbool.h>
+
 #include "game.h"
 #include "models.h"
 
+// ai_cancel_t is a cancellation token: an AI searching on a thread returns as
+// soon as another thread cancels it. The movement is then the best one found
+// so far.
+typedef struct {
+    int cancelled;
+} ai_cancel_t;
+
+static inline void ai_cancel_reset(ai_cancel_t *cancel) {
+    __atomic_store_n(&cancel->cancelled, 0, __ATOMIC_RELAXED);
+}
+
+
+static inline void ai_cancel_set(ai_cancel_t *cancel) {
+    __atomic_store_n(&cancel->cancelled, 1, __ATOMIC_RELAXED);
+}
+
+
+static inline bool ai_cancel_is_set(const ai_cancel_t *cancel) {
+    return __atomic_load_n(&cancel->cancelled, __ATOMIC_RELAXED);
+}
+
+
 typedef mvt_t (*ai_get_mvt_callback_t)(void *context, game_t *game);
 typedef void * (*ai_new_callback_t)();
 typedef void (*ai_free_callback_t)(void *context);
 
+// ai_set_cancel_callback_t gives the token the next searches of the AI check.
+// NULL when the AI answers at once.
+typedef void (*ai_set_cancel_callback_t)(void *context, ai_cancel_t *cancel);
+
+// AI_INFO_LEN is the size of the buffers AIs describe their searches in.
+#define AI_INFO_LEN    256
+
+// ai_get_info_callback_t writes a one line summary of the last search of the
+// AI to `info`, which holds AI_INFO_LEN characters. NULL when the AI doesn't
+// search.
+typedef void (*ai_get_info_callback_t)(void *context, char *info);
+
 typedef struct {
-    ai_new_callback_t     new;
-    ai_free_callback_t    free;
-    ai_get_mvt_callback_t get_goat_mvt;
-    ai_get_mvt_callback_t get_tiger_mvt;
+    ai_new_callback_t        new;
+    ai_free_callback_t       free;
+    ai_get_mvt_callback_t    get_goat_mvt;
+    ai_get_mvt_callback_t    get_tiger_mvt;
+    ai_set_cancel_callback_t set_cancel;
+    ai_get_info_callback_t   get_info;
 } ai_callbacks_t;
 
 #endif
@@ -1,10 +1,18 @@
 #include <math.h>
+#include <stdio.h>
+#include <time.h>
 
 #include "ai_heuristic.h"
+#include "notation.h"
+#include "opening_book.h"
+#include "pn_search.h"
+#include "tablebase.h"
+#include "trace.h"
 
 // go_through_all_mvt calls the `action` function with each possible move from
 // the given board state (and the given context, and game).
-// Before every `action` call, the movement is done and undone afterward.
+// Before every `action` call, the movement is done and undone afterward,
+// without going through the checks and the history of `game_do_mvt`.
 // If the `action` function returns true, the functino stops.
 static void go_through_all_mvt(game_t *game,
                                void   *context,
@@ -25,9 +33,9 @@ static void go_through_all_mvt(game_t *game,
         for (mvt.from.c = 0; mvt.from.c < 5; mvt.from.c++) {
             for (mvt.from.r = 0; mvt.from.r < 5; mvt.from.r++) {
                 if (is_position_possible(&possible_from_pos, mvt.from)) {
-                    game_do_mvt(game, mvt);
+                    int eaten_goat = game_apply_legal_mvt(game, mvt);
                     done = action(context, game, mvt);
-                    game_undo(game);
+                    game_unapply_legal_mvt(game, mvt, eaten_goat);
 
                     if (done) {
                         return;
@@ -46,9 +54,10 @@ static void go_through_all_mvt(game_t *game,
                         for (mvt.to.r = 0; mvt.to.r < 5; mvt.to.r++) {
                             if (is_position_possible(&possible_to_pos,
                                                      mvt.to)) {
-                                game_do_mvt(game, mvt);
+                                int eaten_goat = game_apply_legal_mvt(game,
+                                                                      mvt);
                                 done = action(context, game, mvt);
-                                game_undo(game);
+                                game_unapply_legal_mvt(game, mvt, eaten_goat);
 
                                 if (done) {
                                     return;
@@ -63,20 +72,131 @@ static void go_through_all_mvt(game_t *game,
 }
 
 
+// try_mvt does the movement for `go_through_noisy_mvts`, calls `action` and
+// undoes it.
+// Returns the value returned by `action`.
+static bool try_mvt(game_t *game,
+                    void   *context,
+                    bool (*action)(void *context, game_t *game, mvt_t mvt),
+                    mvt_t mvt) {
+    int  eaten_goat = game_apply_legal_mvt(game, mvt);
+    bool done       = action(context, game, mvt);
+
+    game_unapply_legal_mvt(game, mvt, eaten_goat);
+    return done;
+}
+
+
+// go_through_noisy_mvts calls the `action` function like
+// `go_through_all_mvt`, but only with the movements which change the balance
+// of the game: captures of tigers, and movements of goats to a cell where a
+// tiger would land to eat a goat, which block the capture.
+static void go_through_noisy_mvts(game_t *game,
+                                  void   *context,
+                                  bool (*action)(void *context,
+                                                 game_t *game,
+                                                 mvt_t mvt)) {
+    board_t *board = &game->board;
+
+    if (game->turn == TIGER_TURN) {
+        for (bitboard_t t = game->tigers; t; t &= t - 1) {
+            int                         from = bitboard_first(t);
+            const bitboard_neighbours_t *n   = bitboard_neighbours(from);
+
+            for (int i = 0; i < n->num_jumps; i++) {
+                int   to  = n->jumps[i].to;
+                mvt_t mvt = {
+                    { from % 5, from / 5 }, { to % 5, to / 5 }
+                };
+
+                if ((board->tab[n->jumps[i].over] == GOAT_CELL) &&
+                    (board->tab[to] == EMPTY_CELL) &&
+                    try_mvt(game, context, action, mvt)) {
+                    return;
+                }
+            }
+        }
+        return;
+    }
+
+    game_threats_t threats;
+    game_get_threats(game, &threats);
+
+    for (bitboard_t l = threats.landing_cells; l; l &= l - 1) {
+        int to = bitboard_first(l);
+
+        if (game->num_goats_to_put > 0) {
+            mvt_t mvt = {
+                { to % 5, to / 5 }, { POSITION_NOT_SET, POSITION_NOT_SET }
+            };
+
+            if (try_mvt(game, context, action, mvt)) {
+                return;
+            }
+            continue;
+        }
+
+        const bitboard_neighbours_t *n = bitboard_neighbours(to);
+        for (int i = 0; i < n->num_neighbours; i++) {
+            int   from = n->neighbours[i];
+            mvt_t mvt  = {
+                { from % 5, from / 5 }, { to % 5, to / 5 }
+            };
+
+            if ((board->tab[from] == GOAT_CELL) &&
+                try_mvt(game, context, action, mvt)) {
+                return;
+            }
+        }
+    }
+}
+
+
+// AI_HEURISTIC_ASPIRATION_WINDOW is the half width of the window an iteration
+// of the search starts with, around the value of the previous one.
+#define AI_HEURISTIC_ASPIRATION_WINDOW    5.0
+
+// ai_heuristic_search_state holds what the nodes of a search share.
+struct ai_heuristic_search_state {
+    ai_heuristic_params_t params;
+    ai_heuristic_stats_t  stats;
+    int                   horizon; // Depth of the current iteration.
+
+    // The principal variation of each ply found by the current iteration
+    // (triangular table) and the one of the previous iteration, searched
+    // first while the search follows it.
+    mvt_t                 pv[AI_HEURISTIC_MAX_PLY][AI_HEURISTIC_MAX_PLY];
+    int                   pv_len[AI_HEURISTIC_MAX_PLY];
+    mvt_t                 prev_pv[AI_HEURISTIC_MAX_PLY];
+    int                   prev_pv_len;
+    bool                  follow_pv;
+    bool                  cancelled;
+};
+
 // ai_heuristic_alphabeta_context defines a context for a
 // `ai_heuristic_alphabeta` function call. This context is used so that we
 // can iterate over movements with the `go_through_all_mvt` function.
 struct ai_heuristic_alphabeta_context {
-    double                  value;
-    double                  alpha;
-    double                  beta;
-    int                     depth;
-    bool                    maximizing;
-    ai_heuristic_callback_t heuristic;
-    void                    *heuristic_context;
-    double                  heuristic_coeff;
-    mvt_t                   best_mvt;
-    int                     num_turns;
+    double                           value;
+    double                           alpha;
+    double                           beta;
+    int                              depth;
+    bool                             maximizing;
+    ai_heuristic_callback_t          heuristic;
+    void                             *heuristic_context;
+    double                           heuristic_coeff;
+    mvt_t                            best_mvt;
+    int                              num_turns;
+    struct ai_heuristic_search_state *search;
+    int                              num_children;
+    bool                             has_pv_mvt; // The PV movement is done.
+    mvt_t                            pv_mvt;
+
+    // Quiet movements neither eat a goat nor go to one of the `noisy_cells`
+    // (see `go_through_noisy_mvts`). They are pruned when the node is futile.
+    int                              num_eaten_goats;
+    bitboard_t                       noisy_cells;
+    bool                             futile;
 };
 
 // See below.
@@ -95,33 +215,177 @@ static double min(double x, double y) {
 }
 
 
-static bool ai_heuristic_alphabeta_maximizing(void   *c,
-                                              game_t *game,
-                                              mvt_t  mvt) {
-    struct ai_heuristic_alphabeta_context *context = c;
+static bool same_mvt(mvt_t a, mvt_t b) {
+    return a.from.c == b.from.c && a.from.r == b.from.r &&
+           a.to.c == b.to.c && a.to.r == b.to.r;
+}
+
+
+// update_pv sets the principal variation of the node at `ply` to `mvt`
+// followed by the one of its child.
+static void update_pv(struct ai_heuristic_search_state *search, int ply,
+                      mvt_t mvt) {
+    if (ply >= AI_HEURISTIC_MAX_PLY) {
+        return;
+    }
+
+    search->pv[ply][ply] = mvt;
+    search->pv_len[ply]  = ply + 1;
+
+    if (ply + 1 >= AI_HEURISTIC_MAX_PLY) {
+        return;
+    }
 
+    for (int i = ply + 1; i < search->pv_len[ply + 1]; i++) {
+        search->pv[ply][i] = search->pv[ply + 1][i];
+    }
+    search->pv_len[ply] = max(search->pv_len[ply + 1], ply + 1);
+}
+
+
+// search_child returns the value of the position reached by a movement from
+// the node of `context`, searched `reduction` movements less deep within
+// (`alpha`, `beta`).
+static double search_child(struct ai_heuristic_alphabeta_context *context,
+                           game_t *game, int reduction, double alpha,
+                           double beta) {
     struct ai_heuristic_alphabeta_context call_context = {
-        .value             = context->value,
-        .depth             = context->depth - 1,
-        .alpha             = context->alpha,
-        .beta              = context->beta,
-        .maximizing        = false,
+        .depth             = context->depth - 1 - reduction,
+        .alpha             = alpha,
+        .beta              = beta,
+        .maximizing        = !context->maximizing,
         .heuristic         = context->heuristic,
         .heuristic_context = context->heuristic_context,
         .heuristic_coeff   = context->heuristic_coeff,
         .num_turns         = context->num_turns + 1,
+        .search            = context->search,
     };
 
-    double child_value = ai_heuristic_alphabeta(&call_context, game);
+    return ai_heuristic_alphabeta(&call_context, game);
+}
+
+
+// search_pvs returns the value of a child with a principal variation search:
+// the first child is expected to be the best one, so the others are only
+// searched with a null window to prove they are not better. The ones that
+// are get searched again with the full window. A late quiet child is first
+// searched `reduction` movements less deep, then at full depth if it may be
+// better.
+// See: https://en.wikipedia.org/wiki/Principal_variation_search
+static double search_pvs(struct ai_heuristic_alphabeta_context *context,
+                         game_t *game, int reduction) {
+    ai_heuristic_stats_t *stats = &context->search->stats;
+    double               alpha  = context->alpha;
+    double               beta   = context->beta;
+    double               null_alpha, null_beta, value;
+
+    if (context->num_children++ == 0) {
+        return search_child(context, game, 0, alpha, beta);
+    }
+
+    if (context->maximizing && isfinite(alpha)) {
+        null_alpha = alpha;
+        null_beta  = nextafter(alpha, beta);
+    } else if (!context->maximizing && isfinite(beta)) {
+        null_alpha = nextafter(beta, alpha);
+        null_beta  = beta;
+    } else {
+        return search_child(context, game, 0, alpha, beta);
+    }
+
+    if (reduction > 0) {
+        stats->num_reductions++;
+        value = search_child(context, game, reduction, null_alpha, null_beta);
+        if (context->maximizing ? value <= alpha : value >= beta) {
+            return value;
+        }
+        stats->num_lmr_researches++;
+    }
+
+    value = search_child(context, game, 0, null_alpha, null_beta);
+    if ((value <= alpha) || (value >= beta)) {
+        return value;
+    }
+
+    stats->num_pvs_researches++;
+    return search_child(context, game, 0, alpha, beta);
+}
+
+
+// is_quiet returns true if `mvt`, which has just been done from the node of
+// `context`, is quiet.
+static bool is_quiet(struct ai_heuristic_alphabeta_context *context,
+                     game_t *game, mvt_t mvt) {
+    // A goat put on the board has no `to` position.
+    position_t to = position_is_set(mvt.to) ? mvt.to : mvt.from;
+
+    return game->num_eaten_goats == context->num_eaten_goats &&
+           !bitboard_has(context->noisy_cells, to.r * 5 + to.c);
+}
+
+
+// selective_search returns the number of movements the search of a child is
+// reduced by, or -1 if it is pruned.
+static int selective_search(struct ai_heuristic_alphabeta_context *context,
+                            game_t *game, mvt_t mvt) {
+    ai_heuristic_params_t *params = &context->search->params;
+    bool                  reduce  = params->lmr &&
+                                    context->depth >= params->lmr_min_depth &&
+                                    context->num_children >= params->lmr_min_mvts;
+
+    // The first movement is always searched: the node gets a value.
+    if ((context->num_children == 0) || (!context->futile && !reduce) ||
+        !is_quiet(context, game, mvt)) {
+        return 0;
+    }
+
+    if (context->futile) {
+        context->search->stats.num_futility_prunes++;
+        return -1;
+    }
+
+    return params->lmr_reduction;
+}
+
+
+// count_cutoff counts the node of `context`, refuted by its last child.
+static void count_cutoff(struct ai_heuristic_alphabeta_context *context) {
+    context->search->stats.num_cutoffs++;
+    if (context->num_children == 1) {
+        context->search->stats.num_first_cutoffs++;
+    }
+}
+
+
+static bool ai_heuristic_alphabeta_maximizing(void   *c,
+                                              game_t *game,
+                                              mvt_t  mvt) {
+    struct ai_heuristic_alphabeta_context *context = c;
+
+    if (context->has_pv_mvt && same_mvt(mvt, context->pv_mvt)) {
+        return false; // Already searched first.
+    }
+
+    int reduction = selective_search(context, game, mvt);
+    if (reduction < 0) {
+        return false;
+    }
+
+    double child_value = search_pvs(context, game, reduction);
+    if (context->search->cancelled) {
+        return true;
+    }
 
     if (context->value < child_value) {
         context->best_mvt = mvt;
         context->value    = child_value;
+        update_pv(context->search, context->num_turns, mvt);
     }
 
     context->alpha = max(context->alpha, context->value);
 
     if (context->beta <= context->alpha) {
+        count_cutoff(context);
         return true; // Stops going througth the other movements.
     }
 
@@ -134,23 +398,29 @@ static bool ai_heuristic_alphabeta_minimizing(void   *c,
                                               mvt_t  mvt) {
     struct ai_heuristic_alphabeta_context *context = c;
 
-    struct ai_heuristic_alphabeta_context call_context = {
-        .value             = context->value,
-        .depth             = context->depth - 1,
-        .alpha             = context->alpha,
-        .beta              = context->beta,
-        .maximizing        = true,
-        .heuristic         = context->heuristic,
-        .heuristic_context = context->heuristic_context,
-        .heuristic_coeff   = context->heuristic_coeff,
-        .num_turns         = context->num_turns + 1,
-    };
+    if (context->has_pv_mvt && same_mvt(mvt, context->pv_mvt)) {
+        return false; // Already searched first.
+    }
+
+    int reduction = selective_search(context, game, mvt);
+    if (reduction < 0) {
+        return false;
+    }
+
+    double child_value = search_pvs(context, game, reduction);
+    if (context->search->cancelled) {
+        return true;
+    }
+
+    if (context->value > child_value) {
+        context->value = child_value;
+        update_pv(context->search, context->num_turns, mvt);
+    }
 
-    context->value = min(context->value,
-                         ai_heuristic_alphabeta(&call_context, game));
     context->beta = min(context->beta, context->value);
 
     if (context->beta <= context->alpha) {
+        count_cutoff(context);
         return true; // Stops going througth the other movements.
     }
 
@@ -158,43 +428,475 @@ static bool ai_heuristic_alphabeta_minimizing(void   *c,
 }
 
 
+// exact_tiger_winning sets `score` to the exact value of the game for tigers
+// if the default tablebase or the default proof-number solver knows it.
+// `num_turns` makes the fastest wins and slowest losses the best.
+static bool exact_tiger_winning(game_t *game, int num_turns, double *score) {
+    tb_value_t  value;
+    pn_result_t result;
+
+    if (!tablebase_probe(tablebase_get_default(), game, &value)) {
+        if (!pn_probe(pn_get_default(), game, &result)) {
+            return false;
+        }
+
+        // The length of a proof is unknown: it ranks after the tablebase
+        // wins.
+        double distance = num_turns + PN_MAX_LINE_LEN;
+        *score = result == PN_TIGERS_WIN ? AI_HEURISTIC_WIN_SCORE - distance :
+                 -AI_HEURISTIC_WIN_SCORE + distance;
+        return true;
+    }
+
+    if (tb_value_result(value) == TB_VALUE_DRAW) {
+        *score = 0;
+        return true;
+    }
+
+    bool tiger_wins = (tb_value_result(value) == TB_VALUE_WIN) ==
+                      (game->turn == TIGER_TURN);
+    double distance = num_turns + tb_value_dtr(value);
+
+    *score = tiger_wins ? AI_HEURISTIC_WIN_SCORE - distance :
+             -AI_HEURISTIC_WIN_SCORE + distance;
+    return true;
+}
+
+
+// probe_exact calls `exact_tiger_winning` for the node of `context` and
+// counts the lookup.
+static bool probe_exact(struct ai_heuristic_alphabeta_context *context,
+                        game_t *game, double *score) {
+    ai_heuristic_stats_t *stats = &context->search->stats;
+
+    stats->num_exact_probes++;
+    if (!exact_tiger_winning(game, context->num_turns, score)) {
+        return false;
+    }
+
+    stats->num_exact_hits++;
+    return true;
+}
+
+
+// evaluate returns the heuristic value of the game for the root player.
+// The positions are evaluated as if they were at the depth of the iteration,
+// whatever the quiescence search and the reductions: heuristics can weigh the
+// goats eaten by the number of turns, which would favor longer sequences.
+static double evaluate(struct ai_heuristic_alphabeta_context *context,
+                       game_t                                *game) {
+    context->search->stats.num_evals++;
+    return context->heuristic(context->heuristic_context, game,
+                              context->search->horizon) *
+           context->heuristic_coeff;
+}
+
+
+// ai_heuristic_quiescence continues the search once the depth is reached,
+// only through the noisy movements, until the position is quiet: the
+// heuristic is not trusted in the middle of a capture. The player to move
+// can also stop there (stand pat), so the heuristic value bounds the value.
+// See: https://en.wikipedia.org/wiki/Quiescence_search
+static void ai_heuristic_quiescence(struct ai_heuristic_alphabeta_context
+                                           *context,
+                                    game_t *game) {
+    double stand_pat = evaluate(context, game);
+
+    context->value = stand_pat;
+    if (game_is_done(game)) {
+        return;
+    }
+
+    if (context->maximizing) {
+        context->alpha = max(context->alpha, stand_pat);
+        if (context->beta > context->alpha) {
+            go_through_noisy_mvts(game, context,
+                                  ai_heuristic_alphabeta_maximizing);
+        }
+    } else {
+        context->beta = min(context->beta, stand_pat);
+        if (context->beta > context->alpha) {
+            go_through_noisy_mvts(game, context,
+                                  ai_heuristic_alphabeta_minimizing);
+        }
+    }
+}
+
+
+// prepare_selective_search sets what the node of `context` needs to reduce
+// and prune its quiet movements.
+static void prepare_selective_search(struct ai_heuristic_alphabeta_context
+                                            *context,
+                                     game_t *game) {
+    ai_heuristic_params_t *params = &context->search->params;
+    bool                  lmr     = params->lmr &&
+                                    context->depth >= params->lmr_min_depth;
+
+    // Futility pruning: near the leaves, when the heuristic value is too far
+    // from the window, quiet movements are not expected to bring it back.
+    // The root is always searched.
+    context->futile = false;
+    if (params->futility && (context->num_turns > 0) &&
+        (context->depth <= params->futility_depth)) {
+        double margin = params->futility_margin * context->depth;
+        double value  = evaluate(context, game);
+
+        context->futile = context->maximizing ?
+                          value + margin <= context->alpha :
+                          value - margin >= context->beta;
+    }
+
+    if (!context->futile && !lmr) {
+        return;
+    }
+
+    context->num_eaten_goats = game->num_eaten_goats;
+    context->noisy_cells     = 0;
+    if (game->turn == GOAT_TURN) {
+        game_threats_t threats;
+        game_get_threats(game, &threats);
+        context->noisy_cells = threats.landing_cells;
+    }
+}
+
+
+// go_through_mvts calls `action` with the movement of the previous principal
+// variation first while the search follows it, then with the other ones.
+static void go_through_mvts(struct ai_heuristic_alphabeta_context *context,
+                            game_t *game,
+                            bool (*action)(void *context,
+                                           game_t *game,
+                                           mvt_t mvt)) {
+    struct ai_heuristic_search_state *search = context->search;
+    int                              ply     = context->num_turns;
+
+    prepare_selective_search(context, game);
+
+    if (search->follow_pv && (ply < search->prev_pv_len)) {
+        // The position is the one of the previous iteration: its movement is
+        // legal.
+        bool done = try_mvt(game, context, action, search->prev_pv[ply]);
+
+        context->pv_mvt     = search->prev_pv[ply];
+        context->has_pv_mvt = true;
+        search->follow_pv   = false;
+        if (done) {
+            return;
+        }
+    }
+    search->follow_pv = false;
+
+    go_through_all_mvt(game, context, action);
+}
+
+
 // ai_heuristic_alphabeta implements a Alpa-Beta Pruning algorithm.
 // See: https://en.wikipedia.org/wiki/Alpha%E2%80%93beta_pruning
 static double ai_heuristic_alphabeta(struct ai_heuristic_alphabeta_context
                                             *context,
                                      game_t *game) {
-    if (context->depth == 0) {
-        context->value = context->heuristic(context->heuristic_context,
-                                            game,
-                                            context->num_turns) *
-                         context->heuristic_coeff;
+    double score;
+
+    struct ai_heuristic_search_state *search = context->search;
+
+    // The first depth is always completed: the movement returned must have
+    // been searched.
+    if ((search->horizon > 1) &&
+        (((search->params.cancel != NULL) &&
+          ai_cancel_is_set(search->params.cancel)) ||
+         ((search->params.max_nodes > 0) &&
+          (search->stats.num_nodes >= search->params.max_nodes)))) {
+        search->cancelled = true;
+    }
+    if (search->cancelled) {
+        // The value is not used: the iteration is dropped.
+        context->value = 0;
+        return context->value;
+    }
+
+    context->search->stats.num_nodes++;
+    if (context->num_turns < AI_HEURISTIC_MAX_PLY) {
+        context->search->pv_len[context->num_turns] = context->num_turns;
+    }
+
+    if ((context->num_turns > 0) &&
+        probe_exact(context, game, &score)) {
+        // The root is always searched to find the movement.
+        context->value = score * context->heuristic_coeff;
+    } else if (context->depth <= 0) {
+        ai_heuristic_quiescence(context, game);
     } else if (context->maximizing) {
         context->value = -INFINITY;
-        go_through_all_mvt(game, context, ai_heuristic_alphabeta_maximizing);
+        go_through_mvts(context, game, ai_heuristic_alphabeta_maximizing);
     } else {
         context->value = +INFINITY;
-        go_through_all_mvt(game, context, ai_heuristic_alphabeta_minimizing);
+        go_through_mvts(context, game, ai_heuristic_alphabeta_minimizing);
     }
 
     return context->value;
 }
 
 
-mvt_t ai_heuristic_get_mvt(game_t                  *game,
-                           ai_heuristic_callback_t tiger_winning,
-                           void                    *heuristic_context,
-                           int                     depth) {
+// See header.
+mvt_t ai_heuristic_get_mvt(game_t                      *game,
+                           ai_heuristic_callback_t     tiger_winning,
+                           void                        *heuristic_context,
+                           int                         depth,
+                           const ai_heuristic_params_t *params,
+                           ai_heuristic_stats_t        *stats) {
+    TRACE_FUNCTION();
+
+    mvt_t                mvt;
+    ai_heuristic_stats_t skipped = { 0 };
+
+    if (stats == NULL) {
+        stats = &skipped;
+    }
+    *stats = (ai_heuristic_stats_t){ 0 };
+
+    if (opening_book_probe(opening_book_get_default(), game, &mvt, NULL)) {
+        stats->source = AI_HEURISTIC_OPENING_BOOK;
+        return mvt;
+    }
+
+    if (tablebase_best_mvt(tablebase_get_default(), game, &mvt)) {
+        stats->source = AI_HEURISTIC_TABLEBASE;
+        return mvt;
+    }
+
+    // The solver nodes count against the nodes of the search, and the
+    // solver stops with it when it is cancelled.
+    ai_heuristic_params_t search_params = params != NULL ? *params :
+                                          ai_heuristic_default_params();
+    pn_solver_t           *solver       = pn_get_default();
+    pn_stats_t            pn_stats      = { 0 };
+    uint64_t              max_nodes     = PN_AI_MAX_NODES;
+
+    if ((search_params.max_nodes > 0) &&
+        (search_params.max_nodes < max_nodes)) {
+        max_nodes = search_params.max_nodes;
+    }
+    if ((solver != NULL) &&
+        pn_solve_player(solver, game, game->turn, max_nodes,
+                        search_params.cancel, &pn_stats) &&
+        (pn_solution_line(solver, game, &mvt, 1) == 1)) {
+        stats->source = AI_HEURISTIC_SOLVER;
+        return mvt;
+    }
+
+    if (search_params.max_nodes > 0) {
+        // A search without nodes left still returns a legal movement.
+        search_params.max_nodes = search_params.max_nodes > pn_stats.num_nodes ?
+                                  search_params.max_nodes - pn_stats.num_nodes :
+                                  1;
+    }
+
+    return ai_heuristic_search(game, tiger_winning, heuristic_context, depth,
+                               &search_params, NULL, stats);
+}
+
+
+static double elapsed(struct timespec *begin) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
+
+// search_root searches the game `depth` movements ahead within the window
+// (`alpha`, `beta`) and sets `best_mvt` to the best movement found.
+// Returns the value of the game for the current player.
+static double search_root(struct ai_heuristic_search_state *search,
+                          game_t *game, ai_heuristic_callback_t tiger_winning,
+                          void *heuristic_context, int depth, double alpha,
+                          double beta, mvt_t *best_mvt) {
     struct ai_heuristic_alphabeta_context context = {
         .depth             = depth,
-        .alpha             =                         -INFINITY,
-        .beta              =                         +INFINITY,
+        .alpha             = alpha,
+        .beta              = beta,
         .maximizing        = true,
         .heuristic         = tiger_winning,
         .heuristic_context = heuristic_context,
         .heuristic_coeff   = game->turn == TIGER_TURN ? 1 : -1,
-        .num_turns         =                                 0,
+        .num_turns         = 0,
+        .search            = search,
     };
 
+    search->follow_pv = true;
+    search->horizon   = depth;
     ai_heuristic_alphabeta(&context, game);
-    return context.best_mvt;
+
+    *best_mvt = context.best_mvt;
+    return context.value;
+}
+
+
+// See header.
+mvt_t ai_heuristic_search(game_t                      *game,
+                          ai_heuristic_callback_t     tiger_winning,
+                          void                        *heuristic_context,
+                          int                         depth,
+                          const ai_heuristic_params_t *params,
+                          double                      *value,
+                          ai_heuristic_stats_t        *stats) {
+    struct ai_heuristic_search_state state  = { 0 };
+    struct ai_heuristic_search_state *search = &state;
+    mvt_t                            mvts[GAME_MAX_NUM_MVTS];
+    mvt_t                            best_mvt   = {
+        { POSITION_NOT_SET, POSITION_NOT_SET },
+        { POSITION_NOT_SET, POSITION_NOT_SET }
+    };
+    double                           best_score = 0;
+    struct timespec                  begin;
+
+    search->params = params != NULL ? *params : ai_heuristic_default_params();
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    // A legal movement is returned if no depth is searched. A player who
+    // cannot move has lost: there is nothing to search.
+    int num_mvts = game_get_mvts(game, mvts);
+    if (num_mvts > 0) {
+        best_mvt = mvts[0];
+    } else {
+        best_score = -AI_HEURISTIC_WIN_SCORE;
+    }
+
+    // Iterative deepening: each iteration orders the movements of the
+    // principal variation of the previous one first and expects a value
+    // close to its one.
+    for (int d = 1; (d <= depth) && (num_mvts > 0); d++) {
+        double alpha = -INFINITY;
+        double beta  = +INFINITY;
+        double score;
+        mvt_t  mvt;
+        double iteration_begin = search->stats.time;
+
+        if ((d > 1) && (fabs(best_score) < AI_HEURISTIC_WIN_SCORE / 2)) {
+            alpha = best_score - AI_HEURISTIC_ASPIRATION_WINDOW;
+            beta  = best_score + AI_HEURISTIC_ASPIRATION_WINDOW;
+        }
+
+        for (;;) {
+            score = search_root(search, game, tiger_winning, heuristic_context,
+                                d, alpha, beta, &mvt);
+            if (search->cancelled) {
+                break;
+            }
+
+            // Outside of the window, the value is only a bound: the search
+            // is done again with the window open on that side.
+            if ((score <= alpha) && isfinite(alpha)) {
+                alpha = -INFINITY;
+            } else if ((score >= beta) && isfinite(beta)) {
+                beta = +INFINITY;
+            } else {
+                break;
+            }
+            search->stats.num_aspiration_researches++;
+        }
+
+        search->stats.time = elapsed(&begin);
+        if (search->cancelled) {
+            break;
+        }
+
+        best_mvt   = mvt;
+        best_score = score;
+        search->prev_pv_len = search->pv_len[0];
+        for (int i = 0; i < search->prev_pv_len; i++) {
+            search->prev_pv[i] = search->pv[0][i];
+            search->stats.pv[i] = search->pv[0][i];
+        }
+        search->stats.pv_len = search->prev_pv_len;
+        search->stats.depth  = d;
+        search->stats.value  = score;
+        if (d <= AI_HEURISTIC_MAX_PLY) {
+            search->stats.iteration_times[d - 1] = search->stats.time -
+                                                   iteration_begin;
+        }
+
+        if (search->params.info != NULL) {
+            search->params.info(search->params.info_context, &search->stats);
+        }
+    }
+
+    if (value != NULL) {
+        *value = best_score;
+    }
+    if (stats != NULL) {
+        *stats = search->stats;
+    }
+
+    return best_mvt;
+}
+
+
+// See header.
+ai_heuristic_params_t ai_heuristic_default_params() {
+    return (ai_heuristic_params_t){
+               .lmr             = true,
+               .lmr_min_depth   = 3,
+               .lmr_min_mvts    = 3,
+               .lmr_reduction   = 1,
+               // With the simple heuristic, margins small enough to prune
+               // lose games for few nodes (see `build/arena`).
+               .futility        = false,
+               .futility_depth  = 1,
+               .futility_margin = 10
+    };
+}
+
+
+// See header.
+double ai_heuristic_stats_nps(const ai_heuristic_stats_t *stats) {
+    return stats->time > 0 ? stats->num_nodes / stats->time : 0;
+}
+
+
+// format_count writes `n` to `str` with a k or M suffix past a thousand.
+static void format_count(double n, char *str, size_t size) {
+    if (n >= 1e6) {
+        snprintf(str, size, "%.1fM", n / 1e6);
+    } else if (n >= 1e3) {
+        snprintf(str, size, "%.1fk", n / 1e3);
+    } else {
+        snprintf(str, size, "%.0f", n);
+    }
+}
+
+
+// See header.
+int ai_heuristic_stats_format(const ai_heuristic_stats_t *stats, char *str,
+                              size_t size) {
+    static const char *sources[] = {
+        [AI_HEURISTIC_OPENING_BOOK] = "opening book",
+        [AI_HEURISTIC_TABLEBASE]    = "tablebase",
+        [AI_HEURISTIC_SOLVER]       = "solver"
+    };
+    char nodes[16];
+    char nps[16];
+
+    if (stats->source != AI_HEURISTIC_SEARCH) {
+        return snprintf(str, size, "%s", sources[stats->source]);
+    }
+
+    format_count(stats->num_nodes, nodes, sizeof(nodes));
+    format_count(ai_heuristic_stats_nps(stats), nps, sizeof(nps));
+
+    // The first movement of the nodes which are cut is the ordering quality.
+    int first_cutoffs = stats->num_cutoffs > 0 ?
+                        100 * stats->num_first_cutoffs / stats->num_cutoffs : 0;
+    int len = snprintf(str, size, "d%d %+.1f %s nodes %s/s 1st cut %d%% pv",
+                       stats->depth, stats->value, nodes, nps, first_cutoffs);
+
+    for (int i = 0; (i < stats->pv_len) && (len >= 0); i++) {
+        char   mvt[NOTATION_MVT_LEN];
+        size_t used = (size_t)len < size ? (size_t)len : size;
+
+        notation_format_mvt(stats->pv[i], mvt);
+        len += snprintf(str + used, size - used, " %s", mvt);
+    }
+
+    return len;
 }
@@ -1,6 +1,11 @@
 #ifndef __AI_HEURISTIC_H__
 #define __AI_HEURISTIC_H__
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ai.h"
 #include "game.h"
 
 // ai_heuristic_callback_t is a callback to a function that returns double.
@@ -8,13 +13,125 @@
 typedef double (*ai_heuristic_callback_t)(void *context, game_t *game,
                                           int num_turns);
 
+// AI_HEURISTIC_WIN_SCORE is the value of a position proven to be won by
+// tigers, minus the number of movements to win. Heuristics must stay far below.
+#define AI_HEURISTIC_WIN_SCORE    1000.0
+
+// AI_HEURISTIC_MAX_PLY is the number of movements from the root a principal
+// variation is kept for.
+#define AI_HEURISTIC_MAX_PLY      32
+
+// ai_heuristic_source_t tells where a movement comes from.
+typedef enum {
+    AI_HEURISTIC_SEARCH,
+    AI_HEURISTIC_OPENING_BOOK,
+    AI_HEURISTIC_TABLEBASE,
+    AI_HEURISTIC_SOLVER
+} ai_heuristic_source_t;
+
+// ai_heuristic_stats_t sums up a search.
+typedef struct {
+    int      source;                    // ai_heuristic_source_t.
+    uint64_t num_nodes;                 // Positions searched.
+    uint64_t num_evals;                 // Heuristic evaluations.
+    uint64_t num_cutoffs;               // Nodes a movement refuted.
+    uint64_t num_first_cutoffs;         // Refuted by their first movement.
+    uint64_t num_exact_probes;          // Tablebase and solver lookups.
+    uint64_t num_exact_hits;            // Lookups which knew the position.
+    uint64_t num_pvs_researches;        // Null window searches done again.
+    uint64_t num_aspiration_researches; // Iterations done again.
+    uint64_t num_reductions;            // Movements searched less deep.
+    uint64_t num_lmr_researches;        // Reduced ones searched again.
+    uint64_t num_futility_prunes;       // Movements not searched.
+    int      depth;                     // Depth of the last iteration.
+    double   value;                     // Its value for the player.
+    mvt_t    pv[AI_HEURISTIC_MAX_PLY];  // Its principal variation.
+    int      pv_len;
+    double   time;                      // Seconds.
+
+    // Seconds spent on the iteration of each depth, from depth 1.
+    double   iteration_times[AI_HEURISTIC_MAX_PLY];
+} ai_heuristic_stats_t;
+
+// ai_heuristic_info_callback_t receives the statistics of a search after each
+// iteration. It is called from the thread of the search.
+typedef void (*ai_heuristic_info_callback_t)(void                       *context,
+                                             const ai_heuristic_stats_t *stats);
+
+// ai_heuristic_params_t are the parameters of the search.
+// With a `cancel` token, the search stops as soon as it is set and returns
+// the movement of the last completed depth. It stops the same way once it
+// searched `max_nodes` positions, which bounds it whatever the machine. Both
+// are only checked from depth 2: the first depth is always completed.
+// The selective search can be tuned: quiet
+// movements (which neither eat a goat nor block a capture) ordered late are
+// searched less deep (late movement reductions), and the ones of positions
+// whose heuristic value is far below what the player already has are not
+// searched near the leaves (futility pruning).
+typedef struct {
+    bool        lmr;             // Enables the late movement reductions.
+    int         lmr_min_depth;   // Depth from which movements are reduced.
+    int         lmr_min_mvts;    // Movements of a position searched at full depth.
+    int         lmr_reduction;   // Movements the depth is reduced by.
+    bool        futility;        // Enables the futility pruning.
+    int         futility_depth;  // Depth up to which movements are pruned.
+    double      futility_margin; // Heuristic margin per movement of depth.
+    ai_cancel_t *cancel;         // Can be NULL.
+    uint64_t    max_nodes;       // 0 for no limit.
+
+    // `info` is called with `info_context` after each iteration. Can be NULL.
+    ai_heuristic_info_callback_t info;
+    void                         *info_context;
+} ai_heuristic_params_t;
+
+// ai_heuristic_default_params returns the parameters used when none are given.
+ai_heuristic_params_t ai_heuristic_default_params();
+
+// ai_heuristic_stats_nps returns the nodes searched per second.
+double ai_heuristic_stats_nps(const ai_heuristic_stats_t *stats);
+
+// ai_heuristic_stats_format writes a one line summary of the statistics to
+// `str`, which holds `size` characters, like `snprintf`.
+int ai_heuristic_stats_format(const ai_heuristic_stats_t *stats, char *str,
+                              size_t size);
+
 // ai_heuristic_get_mvt returns the best movement possible looking `depth`
-// movements ahead with the given `tiger_winning` heuristic.
+// movements ahead with the given `tiger_winning` heuristic. Past `depth`, the
+// search goes on through the captures until the position is quiet.
 // `heuristic_context` is passed to `tiger_winning` when called.
-mvt_t ai_heuristic_get_mvt(game_t                  *game,
-                           ai_heuristic_callback_t tiger_winning,
-                           void                    *heuristic_context,
-                           int                     depth);
+// The default opening book and tablebase are probed first, then the default
+// proof-number solver tries to prove a win of the current player within
+// PN_AI_MAX_NODES positions: the search is skipped when one of them knows the
+// position. The solver stops when `params->cancel` is set, and its positions
+// count against `params->max_nodes`.
+// `params` can be NULL for the default parameters. If `stats` is not NULL, it
+// is set to the statistics of the search (only its `source` when skipped).
+mvt_t ai_heuristic_get_mvt(game_t                      *game,
+                           ai_heuristic_callback_t     tiger_winning,
+                           void                        *heuristic_context,
+                           int                         depth,
+                           const ai_heuristic_params_t *params,
+                           ai_heuristic_stats_t        *stats);
+
+// ai_heuristic_search does the same search as `ai_heuristic_get_mvt` without
+// looking in the opening book or running the solver. Positions found in the
+// default tablebase, or proven in the table of the default proof-number
+// solver, get their exact score instead of being searched: solver wins rank
+// after the tablebase ones, their length being unknown. If `value` is not
+// NULL, it is set to the value of the returned movement for the current
+// player. Below depth 1, the first legal movement is returned unsearched,
+// valued 0. A player who cannot move has lost: its movement has positions at
+// POSITION_NOT_SET and is valued -AI_HEURISTIC_WIN_SCORE.
+// The search deepens one movement at a time, with a principal variation
+// search whose window is centered on the value of the previous depth.
+// `params` and `stats` can be NULL.
+mvt_t ai_heuristic_search(game_t                      *game,
+                          ai_heuristic_callback_t     tiger_winning,
+                          void                        *heuristic_context,
+                          int                         depth,
+                          const ai_heuristic_params_t *params,
+                          double                      *value,
+                          ai_heuristic_stats_t        *stats);
 
 
 #endif
@@ -3,38 +3,33 @@
 #include "models.h"
 #include "game.h"
 
-// DEPTH defines the number of movements to look ahead.
-#define DEPTH    8
-
 void *ai_simple_heuristic_new() {
-    return malloc(sizeof(ai_simple_heuristic_t));
-}
+    ai_simple_heuristic_t *ai = malloc(sizeof(ai_simple_heuristic_t));
 
+    if (ai != NULL) {
+        ai->depth  = AI_SIMPLE_HEURISTIC_DEPTH;
+        ai->params = ai_heuristic_default_params();
+        ai->stats  = (ai_heuristic_stats_t){ 0 };
+    }
 
-void ai_simple_heuristic_free(void *context) {
-    free(context);
+    return ai;
 }
 
 
-static int get_num_tiger_on_diag(game_t *game) {
-    int num = 0;
-
-    for (int i = 0; i < 5 * 5; i += 2) {
-        if (game->board.tab[i] == TIGER_CELL) {
-            num += 1;
-        }
-    }
-
-    return num;
+void ai_simple_heuristic_free(void *context) {
+    free(context);
 }
 
 
+// tiger_winning reads the features the game updates along the movements:
+// evaluating a leaf doesn't scan the board.
 static double tiger_winning(void *context, game_t *game, int num_turns) {
-    double score = 0;
+    game_features_t features = game_get_features(game);
+    double          score    = 0;
 
-    score += game->num_eaten_goats * 20 / num_turns;
-    score += get_num_tiger_on_diag(game) * 3;
-    score += game_count_num_movable_tigers(game) * 3;
+    score += features.num_eaten_goats * 20 / num_turns;
+    score += features.num_tigers_on_diagonals * 3;
+    score += features.num_movable_tigers * 3;
 
     if (game_is_done(game)) {
         score -= 50;
@@ -44,9 +39,37 @@ static double tiger_winning(void *context, game_t *game, int num_turns) {
 }
 
 
+// See header.
+double ai_simple_heuristic_evaluate(game_t *game, int num_turns) {
+    return tiger_winning(NULL, game, num_turns);
+}
+
+
 mvt_t ai_simple_heuristic_get_mvt(void *context, game_t *game) {
+    ai_simple_heuristic_t *ai = context;
+
     return ai_heuristic_get_mvt(game, tiger_winning,
-                                context, DEPTH);
+                                context, ai->depth, &ai->params, &ai->stats);
+}
+
+
+void ai_simple_heuristic_set_cancel(void *context, ai_cancel_t *cancel) {
+    ai_simple_heuristic_t *ai = context;
+
+    ai->params.cancel = cancel;
+}
+
+
+void ai_simple_heuristic_get_info(void *context, char *info) {
+    ai_simple_heuristic_t *ai = context;
+
+    ai_heuristic_stats_format(&ai->stats, info, AI_INFO_LEN);
+}
+
+
+mvt_t ai_simple_heuristic_search(game_t *game, int depth, double *value) {
+    return ai_heuristic_search(game, tiger_winning, NULL, depth, NULL, value,
+                               NULL);
 }
 
 
@@ -54,5 +77,7 @@ ai_callbacks_t ai_simple_heuristic_callbacks = {
     .new           = ai_simple_heuristic_new,
     .free          = ai_simple_heuristic_free,
     .get_goat_mvt  = ai_simple_heuristic_get_mvt,
-    .get_tiger_mvt = ai_simple_heuristic_get_mvt
+    .get_tiger_mvt = ai_simple_heuristic_get_mvt,
+    .set_cancel    = ai_simple_heuristic_set_cancel,
+    .get_info      = ai_simple_heuristic_get_info
 };
@@ -2,12 +2,34 @@
 #define __AI_SIMPLE_HEURISTIC_AI_H__
 
 #include "ai.h"
+#include "ai_heuristic.h"
 
-typedef struct {} ai_simple_heuristic_t;
+// AI_SIMPLE_HEURISTIC_DEPTH defines the default number of movements to look
+// ahead. The captures are searched further by the quiescence search.
+#define AI_SIMPLE_HEURISTIC_DEPTH    6
+
+// ai_simple_heuristic_t is the context of the AI. The parameters of its
+// search can be changed between two movements.
+typedef struct {
+    int                   depth;
+    ai_heuristic_params_t params;
+    ai_heuristic_stats_t  stats; // Statistics of the last search.
+} ai_simple_heuristic_t;
 
 void *ai_simple_heuristic_new();
 void ai_simple_heuristic_free(void *context);
 mvt_t ai_simple_heuristic_get_mvt(void *context, game_t *game);
+void ai_simple_heuristic_set_cancel(void *context, ai_cancel_t *cancel);
+void ai_simple_heuristic_get_info(void *context, char *info);
+
+// ai_simple_heuristic_search searches the best movement `depth` movements
+// ahead, without the opening book. It is used to build the book.
+// If `value` is not NULL, it is set to the value of the movement.
+mvt_t ai_simple_heuristic_search(game_t *game, int depth, double *value);
+
+// ai_simple_heuristic_evaluate returns the heuristic value of the game for
+// tigers, `num_turns` movements after the beginning of the search.
+double ai_simple_heuristic_evaluate(game_t *game, int num_turns);
 
 extern ai_callbacks_t ai_simple_heuristic_callbacks;
 
@@ -0,0 +1,356 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ai_worker.h"
+#include "game_state.h"
+
+// ai_worker_state_t tells what the thread of a worker does.
+typedef enum {
+    AI_WORKER_IDLE,
+    AI_WORKER_SEARCHING,
+    AI_WORKER_PONDERING
+} ai_worker_state_t;
+
+// ai_worker_reply_t is the movement the AI found after a movement of its
+// opponent, which led to the position of hash `hash`.
+typedef struct {
+    uint64_t hash;
+    mvt_t    mvt;
+    char     info[AI_INFO_LEN];
+} ai_worker_reply_t;
+
+struct ai_worker {
+    pthread_t             thread;
+    bool                  has_thread; // The thread must be joined.
+    pthread_mutex_t       mutex;
+    ai_worker_state_t     state;
+    int                   done; // Set by the thread once `mvt` is set.
+    ai_cancel_t           cancel;
+    game_t                *game; // Copy of the game the AI searches.
+    ai_callbacks_t        *ai;
+    ai_get_mvt_callback_t get_mvt;
+    void                  *ai_context;
+    mvt_t                 mvt;
+    char                  info[AI_INFO_LEN]; // See `ai_get_info_callback_t`.
+
+    // Pondering. The fields below are shared with the thread through
+    // `mutex`.
+    uint64_t              ponder_root; // Hash of the game pondered on.
+    ai_worker_reply_t     replies[GAME_MAX_NUM_MVTS];
+    int                   num_replies;
+    uint64_t              ponder_hash; // Position being searched, 0 if none.
+    bool                  ponder_hit;  // The game reached `ponder_hash`.
+};
+
+
+// hash returns the hash of the game.
+static uint64_t hash(game_t *game) {
+    game_state_t state;
+
+    game_state_from_game(game, &state);
+    return state.hash;
+}
+
+
+// See header.
+ai_worker_t *ai_worker_new() {
+    ai_worker_t *worker = calloc(1, sizeof(ai_worker_t));
+
+    if (worker == NULL) {
+        return NULL;
+    }
+
+    worker->game = game_new();
+    if (worker->game == NULL) {
+        free(worker);
+        return NULL;
+    }
+
+    pthread_mutex_init(&worker->mutex, NULL);
+    return worker;
+}
+
+
+// See header.
+void ai_worker_free(ai_worker_t *worker) {
+    if (worker == NULL) {
+        return;
+    }
+
+    ai_worker_cancel(worker);
+    pthread_mutex_destroy(&worker->mutex);
+    game_free(worker->game);
+    free(worker);
+}
+
+
+// get_info sets `info` to the description of the last search of the AI.
+static void get_info(ai_worker_t *worker, char *info) {
+    info[0] = '\0';
+    if (worker->ai->get_info != NULL) {
+        worker->ai->get_info(worker->ai_context, info);
+    }
+}
+
+
+static void *search(void *w) {
+    ai_worker_t *worker = w;
+
+    worker->mvt = worker->get_mvt(worker->ai_context, worker->game);
+    get_info(worker, worker->info);
+    __atomic_store_n(&worker->done, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+
+// prepare copies the game for the thread and gives the cancellation token to
+// the AI.
+static void prepare(ai_worker_t *worker, ai_callbacks_t *ai, void *ai_context,
+                    game_t *game) {
+    game_state_t state;
+
+    game_state_from_game(game, &state);
+    game_state_to_game(&state, worker->game);
+
+    worker->ai         = ai;
+    worker->ai_context = ai_context;
+    worker->done       = 0;
+    ai_cancel_reset(&worker->cancel);
+    if (ai->set_cancel != NULL) {
+        ai->set_cancel(ai_context, &worker->cancel);
+    }
+}
+
+
+// find_reply returns the reply the AI found for the position of hash `h`
+// while pondering, or NULL. The mutex must be held.
+static ai_worker_reply_t *find_reply(ai_worker_t *worker, uint64_t h) {
+    for (int i = 0; i < worker->num_replies; i++) {
+        if (worker->replies[i].hash == h) {
+            return &worker->replies[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+// See header.
+int ai_worker_start(ai_worker_t *worker, ai_callbacks_t *ai, void *ai_context,
+                    game_t *game) {
+    if (worker->state == AI_WORKER_SEARCHING) {
+        return 1;
+    }
+
+    if (worker->state == AI_WORKER_PONDERING) {
+        uint64_t h     = hash(game);
+        bool     found = false;
+
+        pthread_mutex_lock(&worker->mutex);
+        bool same_ai = (worker->ai == ai) && (worker->ai_context == ai_context);
+        ai_worker_reply_t *reply = same_ai ? find_reply(worker, h) : NULL;
+        if (reply != NULL) {
+            worker->mvt = reply->mvt;
+            strcpy(worker->info, reply->info);
+            found = true;
+        } else if (same_ai && (worker->ponder_hash == h)) {
+            // The thread is searching this very position: its movement is
+            // the one of the search.
+            worker->ponder_hit = true;
+            worker->state      = AI_WORKER_SEARCHING;
+            pthread_mutex_unlock(&worker->mutex);
+            return 0;
+        }
+        pthread_mutex_unlock(&worker->mutex);
+
+        ai_worker_cancel(worker);
+        if (found) {
+            worker->state = AI_WORKER_SEARCHING;
+            worker->done  = 1; // No thread to join.
+            return 0;
+        }
+    }
+
+    prepare(worker, ai, ai_context, game);
+    worker->get_mvt = game->turn == TIGER_TURN ? ai->get_tiger_mvt :
+                      ai->get_goat_mvt;
+
+    if (pthread_create(&worker->thread, NULL, search, worker) != 0) {
+        return 2;
+    }
+
+    worker->has_thread = true;
+    worker->state      = AI_WORKER_SEARCHING;
+    return 0;
+}
+
+
+// ponder_reply searches the movement of the AI after the movement `mvt` of
+// its opponent, unless it is already known.
+// Returns true if the thread must stop.
+static bool ponder_reply(ai_worker_t *worker, mvt_t mvt) {
+    game_t                *game       = worker->game;
+    int                   eaten_goat  = game_apply_legal_mvt(game, mvt);
+    uint64_t              h           = hash(game);
+    ai_get_mvt_callback_t get_mvt     = game->turn == TIGER_TURN ?
+                                        worker->ai->get_tiger_mvt :
+                                        worker->ai->get_goat_mvt;
+    bool                  stop        = false;
+
+    pthread_mutex_lock(&worker->mutex);
+    bool skip = game_is_done(game) || (find_reply(worker, h) != NULL);
+    if (!skip) {
+        worker->ponder_hash = h;
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    if (!skip) {
+        ai_worker_reply_t reply = {
+            .hash = h,
+            .mvt  = get_mvt(worker->ai_context, game)
+        };
+        get_info(worker, reply.info);
+
+        pthread_mutex_lock(&worker->mutex);
+        worker->ponder_hash = 0;
+        if (worker->ponder_hit) {
+            worker->mvt = reply.mvt;
+            strcpy(worker->info, reply.info);
+            __atomic_store_n(&worker->done, 1, __ATOMIC_RELEASE);
+            stop = true;
+        } else if (ai_cancel_is_set(&worker->cancel)) {
+            stop = true;
+        } else {
+            worker->replies[worker->num_replies++] = reply;
+        }
+        pthread_mutex_unlock(&worker->mutex);
+    }
+
+    game_unapply_legal_mvt(game, mvt, eaten_goat);
+    return stop;
+}
+
+
+static bool same_mvt(mvt_t a, mvt_t b) {
+    return a.from.c == b.from.c && a.from.r == b.from.r &&
+           a.to.c == b.to.c && a.to.r == b.to.r;
+}
+
+
+static void *ponder(void *w) {
+    ai_worker_t *worker = w;
+    game_t      *game   = worker->game;
+    mvt_t       mvts[GAME_MAX_NUM_MVTS];
+    int         num_mvts = game_get_mvts(game, mvts);
+
+    // The AI is asked what it would play in place of its opponent: that
+    // movement is pondered on first.
+    mvt_t expected = game->turn == TIGER_TURN ?
+                     worker->ai->get_tiger_mvt(worker->ai_context, game) :
+                     worker->ai->get_goat_mvt(worker->ai_context, game);
+
+    for (int i = 1; i < num_mvts; i++) {
+        if (same_mvt(mvts[i], expected)) {
+            mvts[i] = mvts[0];
+            mvts[0] = expected;
+        }
+    }
+
+    for (int i = 0; i < num_mvts; i++) {
+        if (ai_cancel_is_set(&worker->cancel) || ponder_reply(worker, mvts[i])) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+
+// See header.
+int ai_worker_ponder(ai_worker_t *worker, ai_callbacks_t *ai, void *ai_context,
+                     game_t *game) {
+    uint64_t root = hash(game);
+
+    if (worker->state != AI_WORKER_IDLE) {
+        return 1;
+    }
+
+    // The replies found by an interrupted pondering on the same game are kept.
+    if ((root != worker->ponder_root) || (worker->ai != ai) ||
+        (worker->ai_context != ai_context)) {
+        worker->num_replies = 0;
+    }
+    worker->ponder_root = root;
+    worker->ponder_hash = 0;
+    worker->ponder_hit  = false;
+
+    prepare(worker, ai, ai_context, game);
+
+    if (pthread_create(&worker->thread, NULL, ponder, worker) != 0) {
+        return 2;
+    }
+
+    worker->has_thread = true;
+    worker->state      = AI_WORKER_PONDERING;
+    return 0;
+}
+
+
+// See header.
+bool ai_worker_is_running(ai_worker_t *worker) {
+    return worker->state == AI_WORKER_SEARCHING;
+}
+
+
+// See header.
+bool ai_worker_is_pondering(ai_worker_t *worker) {
+    return worker->state == AI_WORKER_PONDERING;
+}
+
+
+// See header.
+bool ai_worker_poll(ai_worker_t *worker, mvt_t *mvt) {
+    if ((worker->state != AI_WORKER_SEARCHING) ||
+        !__atomic_load_n(&worker->done, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    if (worker->has_thread) {
+        pthread_join(worker->thread, NULL);
+        worker->has_thread = false;
+    }
+    worker->state = AI_WORKER_IDLE;
+    *mvt          = worker->mvt;
+    return true;
+}
+
+
+// See header.
+void ai_worker_stop(ai_worker_t *worker) {
+    if (worker->state == AI_WORKER_SEARCHING) {
+        ai_cancel_set(&worker->cancel);
+    }
+}
+
+
+// See header.
+void ai_worker_cancel(ai_worker_t *worker) {
+    if ((worker == NULL) || (worker->state == AI_WORKER_IDLE)) {
+        return;
+    }
+
+    ai_cancel_set(&worker->cancel);
+    if (worker->has_thread) {
+        pthread_join(worker->thread, NULL);
+        worker->has_thread = false;
+    }
+    worker->state = AI_WORKER_IDLE;
+}
+
+
+// See header.
+const char *ai_worker_info(ai_worker_t *worker) {
+    return worker->info;
+}
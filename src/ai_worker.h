@@ -0,0 +1,70 @@
+#ifndef __AI_WORKER_H__
+#define __AI_WORKER_H__
+
+#include <stdbool.h>
+
+#include "ai.h"
+#include "game.h"
+
+// The AI worker searches the movement of an AI on its own thread, so that the
+// user interface keeps processing events meanwhile. The AI searches a copy of
+// the game: the game can be drawn, but its AI context must not be used until
+// the search is done or cancelled.
+
+typedef struct ai_worker ai_worker_t;
+
+// ai_worker_new creates a worker.
+// Returns NULL on allocation failure.
+ai_worker_t *ai_worker_new();
+
+// ai_worker_free cancels the running search, if any, and frees the worker.
+// `worker` can be NULL.
+void ai_worker_free(ai_worker_t *worker);
+
+// ai_worker_start starts searching the movement of `ai` for the current
+// player of `game`. The worker must not be running. If it is pondering for the
+// same AI, the movement it already found for the game is used, or the search
+// of the game it is doing goes on; otherwise the pondering is cancelled.
+// Returns 0 on success.
+int ai_worker_start(ai_worker_t *worker, ai_callbacks_t *ai, void *ai_context,
+                    game_t *game);
+
+// ai_worker_ponder starts searching, while the opponent of `ai` is thinking,
+// the movement of `ai` after each movement the current player of `game` can
+// do, from the one `ai` would play in its place. The worker must be idle. The
+// movements found are kept until the worker ponders on another game, so that
+// `ai_worker_start` answers at once when the movement was searched.
+// Returns 0 on success.
+int ai_worker_ponder(ai_worker_t *worker, ai_callbacks_t *ai, void *ai_context,
+                     game_t *game);
+
+// ai_worker_is_pondering returns true from `ai_worker_ponder` until the
+// pondering is cancelled or turned into a search by `ai_worker_start`.
+bool ai_worker_is_pondering(ai_worker_t *worker);
+
+// ai_worker_is_running returns true from `ai_worker_start` until the movement
+// is read or the search is cancelled.
+bool ai_worker_is_running(ai_worker_t *worker);
+
+// ai_worker_poll sets `mvt` to the movement found once the search is done.
+// The worker can then start another search.
+// Returns false while the AI is searching, or if the worker is not running.
+bool ai_worker_poll(ai_worker_t *worker, mvt_t *mvt);
+
+// ai_worker_info returns the description the AI gave of the search of the
+// last movement `ai_worker_poll` returned (see `ai_get_info_callback_t`).
+// Empty if the AI gives none.
+const char *ai_worker_info(ai_worker_t *worker);
+
+// ai_worker_stop asks the running search to return the best movement found
+// so far, without waiting for the thread: `ai_worker_poll` gives it once the
+// AI returned. AIs which don't check the token (see `ai_callbacks_t`) finish
+// their search.
+void ai_worker_stop(ai_worker_t *worker);
+
+// ai_worker_cancel stops the running search or pondering, if any, and waits for the
+// thread. AIs which check the token (see `ai_callbacks_t`) return within
+// milliseconds; the others finish their search.
+void ai_worker_cancel(ai_worker_t *worker);
+
+#endif
@@ -0,0 +1,153 @@
+#include <string.h>
+
+#include "alloc_stats.h"
+
+static const char *tag_names[ALLOC_NUM_TAGS] = {
+    [ALLOC_STACK]     = "stack",
+    [ALLOC_MATRIX]    = "matrix",
+    [ALLOC_NEURALNET] = "neuralnet",
+    [ALLOC_GAME]      = "game"
+};
+
+// counts are updated atomically: the AI workers allocate from their thread.
+static alloc_stats_t counts[ALLOC_NUM_TAGS];
+
+#ifdef ALLOC_STATS
+
+// header_t is written before each block to know its size when it is freed.
+// Its size keeps the alignment of malloc.
+typedef union {
+    size_t      size;
+    long double align;
+    void        *ptr;
+} header_t;
+
+
+static void count_alloc(alloc_tag_t tag, size_t size) {
+    alloc_stats_t *c     = &counts[tag];
+    uint64_t      in_use = __atomic_add_fetch(&c->in_use, size,
+                                              __ATOMIC_RELAXED);
+    uint64_t      peak   = __atomic_load_n(&c->peak, __ATOMIC_RELAXED);
+
+    __atomic_add_fetch(&c->num_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&c->bytes, size, __ATOMIC_RELAXED);
+    while ((in_use > peak) &&
+           !__atomic_compare_exchange_n(&c->peak, &peak, in_use, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+
+// See header.
+void *alloc_stats_malloc(alloc_tag_t tag, size_t size) {
+    header_t *header = malloc(sizeof(header_t) + size);
+
+    if (header == NULL) {
+        return NULL;
+    }
+
+    header->size = size;
+    count_alloc(tag, size);
+    return header + 1;
+}
+
+
+// See header.
+void *alloc_stats_calloc(alloc_tag_t tag, size_t num, size_t size) {
+    if ((size != 0) && (num > SIZE_MAX / size)) {
+        return NULL;
+    }
+
+    void *ptr = alloc_stats_malloc(tag, num * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, num * size);
+    }
+
+    return ptr;
+}
+
+
+// See header.
+void alloc_stats_free(alloc_tag_t tag, void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    header_t *header = (header_t *)ptr - 1;
+    __atomic_add_fetch(&counts[tag].num_frees, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&counts[tag].in_use, header->size, __ATOMIC_RELAXED);
+    free(header);
+}
+
+
+// See header.
+bool alloc_stats_enabled() {
+    return true;
+}
+
+#else
+
+// See header.
+bool alloc_stats_enabled() {
+    return false;
+}
+
+#endif
+
+
+// See header.
+void alloc_stats_get(alloc_stats_t *stats) {
+    for (int tag = 0; tag < ALLOC_NUM_TAGS; tag++) {
+        stats[tag] = (alloc_stats_t){
+            __atomic_load_n(&counts[tag].num_allocs, __ATOMIC_RELAXED),
+            __atomic_load_n(&counts[tag].num_frees, __ATOMIC_RELAXED),
+            __atomic_load_n(&counts[tag].bytes, __ATOMIC_RELAXED),
+            __atomic_load_n(&counts[tag].in_use, __ATOMIC_RELAXED),
+            __atomic_load_n(&counts[tag].peak, __ATOMIC_RELAXED)
+        };
+    }
+}
+
+
+// See header.
+uint64_t alloc_stats_num_allocs() {
+    uint64_t num_allocs = 0;
+
+    for (int tag = 0; tag < ALLOC_NUM_TAGS; tag++) {
+        num_allocs += __atomic_load_n(&counts[tag].num_allocs, __ATOMIC_RELAXED);
+    }
+
+    return num_allocs;
+}
+
+
+// See header.
+void alloc_stats_print(FILE *f, int num_mvts) {
+    alloc_stats_t stats[ALLOC_NUM_TAGS];
+
+    if (!alloc_stats_enabled()) {
+        fprintf(f, "Allocations are not counted: build with make alloc_stats.\n");
+        return;
+    }
+
+    alloc_stats_get(stats);
+    fprintf(f, "%-10s %10s %10s %12s %10s %10s", "subsystem", "allocs",
+            "frees", "bytes", "in use", "peak");
+    if (num_mvts > 0) {
+        fprintf(f, " %10s", "allocs/mvt");
+    }
+    fprintf(f, "\n");
+
+    for (int tag = 0; tag < ALLOC_NUM_TAGS; tag++) {
+        fprintf(f, "%-10s %10llu %10llu %12llu %10llu %10llu", tag_names[tag],
+                (unsigned long long)stats[tag].num_allocs,
+                (unsigned long long)stats[tag].num_frees,
+                (unsigned long long)stats[tag].bytes,
+                (unsigned long long)stats[tag].in_use,
+                (unsigned long long)stats[tag].peak);
+        if (num_mvts > 0) {
+            fprintf(f, " %10.2f", (double)stats[tag].num_allocs / num_mvts);
+        }
+        fprintf(f, "\n");
+    }
+}
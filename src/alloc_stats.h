@@ -0,0 +1,65 @@
+// alloc_stats counts the allocations of the stacks, matrices, neural networks
+// and games, by subsystem, in builds made with `make alloc_stats`
+// (-DALLOC_STATS). These modules allocate through the ALLOC_* macros, which
+// are the functions of the C library in other builds.
+
+#ifndef __ALLOC_STATS_H__
+#define __ALLOC_STATS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// alloc_tag_t is the subsystem an allocation is counted in.
+typedef enum {
+    ALLOC_STACK,
+    ALLOC_MATRIX,
+    ALLOC_NEURALNET,
+    ALLOC_GAME,
+    ALLOC_NUM_TAGS
+} alloc_tag_t;
+
+// alloc_stats_t are the counts of a subsystem since the start.
+typedef struct {
+    uint64_t num_allocs;
+    uint64_t num_frees;
+    uint64_t bytes;  // Allocated in total.
+    uint64_t in_use; // Bytes allocated and not freed yet.
+    uint64_t peak;   // Maximum of `in_use`.
+} alloc_stats_t;
+
+#ifdef ALLOC_STATS
+
+void *alloc_stats_malloc(alloc_tag_t tag, size_t size);
+void *alloc_stats_calloc(alloc_tag_t tag, size_t num, size_t size);
+void alloc_stats_free(alloc_tag_t tag, void *ptr);
+
+#define ALLOC_MALLOC(tag, size)         alloc_stats_malloc(tag, size)
+#define ALLOC_CALLOC(tag, num, size)    alloc_stats_calloc(tag, num, size)
+#define ALLOC_FREE(tag, ptr)            alloc_stats_free(tag, ptr)
+
+#else
+
+#define ALLOC_MALLOC(tag, size)         malloc(size)
+#define ALLOC_CALLOC(tag, num, size)    calloc(num, size)
+#define ALLOC_FREE(tag, ptr)            free(ptr)
+
+#endif
+
+// alloc_stats_enabled returns true if allocations are counted.
+bool alloc_stats_enabled();
+
+// alloc_stats_get sets `stats` to the counts of every subsystem, which must
+// hold ALLOC_NUM_TAGS elements. They are 0 if allocations are not counted.
+void alloc_stats_get(alloc_stats_t *stats);
+
+// alloc_stats_num_allocs returns the number of allocations of every subsystem
+// since the start.
+uint64_t alloc_stats_num_allocs();
+
+// alloc_stats_print prints the counts of every subsystem to `f`, with the
+// allocations per movement if `num_mvts` is positive.
+void alloc_stats_print(FILE *f, int num_mvts);
+
+#endif
@@ -0,0 +1,179 @@
+#include "bitboard.h"
+
+// BITBOARD_COLUMN_A and BITBOARD_COLUMN_E are the cells of the first and
+// last columns: shifted cells must not wrap around the board.
+#define BITBOARD_COLUMN_A    ((bitboard_t)0x0108421)
+#define BITBOARD_COLUMN_E    ((bitboard_t)0x1084210)
+
+static bitboard_neighbours_t neighbours[5 * 5];
+static bool                  initialized = false;
+
+
+// bitboard_init computes the neighbours tables. Cells next to each other are
+// linked horizontally and vertically. Diagonal points (see
+// `position_has_diagonal`) are also linked along the diagonals.
+static void bitboard_init() {
+    static const int directions[8][2] = {
+        { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+        { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 }
+    };
+
+    position_t pos;
+
+    for (pos.r = 0; pos.r < 5; pos.r++) {
+        for (pos.c = 0; pos.c < 5; pos.c++) {
+            bitboard_neighbours_t *n = &neighbours[pos.r * 5 + pos.c];
+            int                   num_directions = position_has_diagonal(pos) ? 8 : 4;
+
+            n->mask           = 0;
+            n->num_neighbours = 0;
+            n->num_jumps      = 0;
+
+            for (int d = 0; d < num_directions; d++) {
+                position_t next = { pos.c + directions[d][0], pos.r + directions[d][1] };
+                position_t jump = { pos.c + 2 * directions[d][0], pos.r + 2 * directions[d][1] };
+
+                if (!position_is_valid(next)) {
+                    continue;
+                }
+
+                n->mask |= bitboard_cell(next.r * 5 + next.c);
+                n->neighbours[n->num_neighbours++] = next.r * 5 + next.c;
+
+                if (position_is_valid(jump)) {
+                    n->jumps[n->num_jumps].over = next.r * 5 + next.c;
+                    n->jumps[n->num_jumps].to   = jump.r * 5 + jump.c;
+                    n->num_jumps++;
+                }
+            }
+        }
+    }
+
+    initialized = true;
+}
+
+
+// See header.
+const bitboard_neighbours_t *bitboard_neighbours(int cell) {
+    if (!initialized) {
+        bitboard_init();
+    }
+
+    return &neighbours[cell];
+}
+
+
+// See header.
+bitboard_t bitboard_from_board(board_t *board, cell_state_t state) {
+    bitboard_t bb = 0;
+
+    for (int i = 0; i < 5 * 5; i++) {
+        if (board->tab[i] == state) {
+            bb |= bitboard_cell(i);
+        }
+    }
+
+    return bb;
+}
+
+
+// See header.
+void bitboard_to_board(bitboard_t tigers, bitboard_t goats, board_t *board) {
+    for (int i = 0; i < 5 * 5; i++) {
+        if (bitboard_has(tigers, i)) {
+            board->tab[i] = TIGER_CELL;
+        } else if (bitboard_has(goats, i)) {
+            board->tab[i] = GOAT_CELL;
+        } else {
+            board->tab[i] = EMPTY_CELL;
+        }
+    }
+}
+
+
+// See header.
+bool bitboard_tiger_can_move(int cell, bitboard_t tigers, bitboard_t goats) {
+    const bitboard_neighbours_t *n     = bitboard_neighbours(cell);
+    bitboard_t                  empty = ~(tigers | goats) & BITBOARD_ALL;
+
+    if (n->mask & empty) {
+        return true;
+    }
+
+    for (int i = 0; i < n->num_jumps; i++) {
+        if (bitboard_has(goats, n->jumps[i].over) &&
+            bitboard_has(empty, n->jumps[i].to)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+// See header.
+bool bitboard_tigers_blocked(bitboard_t tigers, bitboard_t goats) {
+    for (bitboard_t t = tigers; t; t &= t - 1) {
+        if (bitboard_tiger_can_move(bitboard_first(t), tigers, goats)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// See header.
+bitboard_t bitboard_dilate(bitboard_t cells) {
+    bitboard_t diagonals = cells & BITBOARD_DIAGONALS;
+    bitboard_t next_c    = ~BITBOARD_COLUMN_A; // Cells reached going right.
+    bitboard_t prev_c    = ~BITBOARD_COLUMN_E; // Cells reached going left.
+
+    bitboard_t dilated = ((cells << 1) & next_c) | ((cells >> 1) & prev_c) |
+                         (cells << 5) | (cells >> 5) |
+                         ((diagonals << 6) & next_c) |
+                         ((diagonals >> 6) & prev_c) |
+                         ((diagonals << 4) & prev_c) |
+                         ((diagonals >> 4) & next_c);
+
+    return dilated & BITBOARD_ALL;
+}
+
+
+// See header.
+bitboard_t bitboard_flood_fill(bitboard_t seeds, bitboard_t open) {
+    bitboard_t region = seeds & open;
+    bitboard_t next;
+
+    while ((next = (region | bitboard_dilate(region)) & open) != region) {
+        region = next;
+    }
+
+    return region;
+}
+
+
+// See header.
+bitboard_t bitboard_tiger_regions(bitboard_t tigers, bitboard_t goats,
+                                  bitboard_t regions[5 * 5]) {
+    bitboard_t empty = ~(tigers | goats) & BITBOARD_ALL;
+    bitboard_t area  = 0;
+
+    for (bitboard_t t = tigers; t; t &= t - 1) {
+        int                         cell   = bitboard_first(t);
+        const bitboard_neighbours_t *n     = bitboard_neighbours(cell);
+        bitboard_t                  seeds  = n->mask & empty;
+
+        for (int i = 0; i < n->num_jumps; i++) {
+            if (bitboard_has(goats, n->jumps[i].over) &&
+                bitboard_has(empty, n->jumps[i].to)) {
+                seeds |= bitboard_cell(n->jumps[i].to);
+            }
+        }
+
+        regions[cell] = bitboard_flood_fill(seeds, empty);
+        area         |= regions[cell];
+    }
+
+    return area;
+}
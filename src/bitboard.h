@@ -0,0 +1,72 @@
+#ifndef __BITBOARD_H__
+#define __BITBOARD_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "models.h"
+
+// bitboard_t represents a set of cells of the board. Cell r, c is the bit
+// r * 5 + c.
+typedef uint32_t bitboard_t;
+
+#define BITBOARD_ALL          ((bitboard_t)0x1ffffff)
+
+// BITBOARD_DIAGONALS are the points from which diagonal movements are possible.
+#define BITBOARD_DIAGONALS    ((bitboard_t)0x1555555)
+
+// bitboard_jump_t is a tiger jump from a cell over `over` to `to`.
+typedef struct {
+    int8_t over;
+    int8_t to;
+} bitboard_jump_t;
+
+// bitboard_neighbours_t lists the cells next to a cell (a goat or a tiger can
+// move there in one step) and the jumps a tiger can do from it.
+typedef struct {
+    bitboard_t      mask;
+    int             num_neighbours;
+    int8_t          neighbours[8];
+    int             num_jumps;
+    bitboard_jump_t jumps[8];
+} bitboard_neighbours_t;
+
+// bitboard_neighbours returns the neighbours of the cell index `cell`.
+// The tables follow the same rules as `game_do_mvt`.
+const bitboard_neighbours_t *bitboard_neighbours(int cell);
+
+// bitboard_from_board returns the cells of the board holding `state`.
+bitboard_t bitboard_from_board(board_t *board, cell_state_t state);
+
+// bitboard_to_board fills the board with the given tigers and goats.
+void bitboard_to_board(bitboard_t tigers, bitboard_t goats, board_t *board);
+
+// bitboard_tiger_can_move returns true if the tiger on `cell` can step to an
+// empty cell or jump over a goat.
+bool bitboard_tiger_can_move(int cell, bitboard_t tigers, bitboard_t goats);
+
+// bitboard_tigers_blocked returns true if no tiger can move.
+bool bitboard_tigers_blocked(bitboard_t tigers, bitboard_t goats);
+
+// bitboard_dilate returns the cells next to `cells`: a step from one of them
+// reaches them. It is computed with shifts, without the neighbours tables.
+bitboard_t bitboard_dilate(bitboard_t cells);
+
+// bitboard_flood_fill returns the cells of `open` which can be reached from
+// `seeds` step by step through cells of `open`.
+bitboard_t bitboard_flood_fill(bitboard_t seeds, bitboard_t open);
+
+// bitboard_tiger_regions sets `regions[cell]` to the empty cells the tiger on
+// `cell` can reach step by step, after eating the goats it can eat now.
+// Tokens are otherwise considered fixed: a tiger whose region is small is
+// enclosed by the goats, the way goats win.
+// Returns the union of the regions: the free area of the tigers.
+bitboard_t bitboard_tiger_regions(bitboard_t tigers, bitboard_t goats,
+                                  bitboard_t regions[5 * 5]);
+
+#define bitboard_has(bb, cell)    (((bb) >> (cell)) & 1)
+#define bitboard_cell(cell)       ((bitboard_t)1 << (cell))
+#define bitboard_count(bb)        __builtin_popcount(bb)
+#define bitboard_first(bb)        __builtin_ctz(bb)
+
+#endif
@@ -1,13 +1,112 @@
+#include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "alloc_stats.h"
+#include "bitboard.h"
 #include "game.h"
 #include "tools.h"
 
 #define DEFAULT_HISTORY_STACK_SIZE    64
 
+// influence[cell] are the cells whose tiger movements depend on `cell`: the
+// tigers next to it and the ones which can jump over it or to it.
+static bitboard_t influence[5 * 5];
+static bool       influence_initialized = false;
+
+
+static void influence_init() {
+    for (int cell = 0; cell < 5 * 5; cell++) {
+        const bitboard_neighbours_t *n = bitboard_neighbours(cell);
+
+        for (int i = 0; i < n->num_neighbours; i++) {
+            influence[n->neighbours[i]] |= bitboard_cell(cell);
+        }
+        for (int i = 0; i < n->num_jumps; i++) {
+            influence[n->jumps[i].over] |= bitboard_cell(cell);
+            influence[n->jumps[i].to]   |= bitboard_cell(cell);
+        }
+    }
+
+    influence_initialized = true;
+}
+
+
+// count_tiger_mvts returns the number of movements of the tiger on `cell`
+// and sets `captures` to the goats it can eat.
+static int count_tiger_mvts(board_t *board, int cell, bitboard_t *captures) {
+    const bitboard_neighbours_t *n     = bitboard_neighbours(cell);
+    int                         count = 0;
+
+    *captures = 0;
+
+    for (int i = 0; i < n->num_neighbours; i++) {
+        count += board->tab[n->neighbours[i]] == EMPTY_CELL;
+    }
+
+    for (int i = 0; i < n->num_jumps; i++) {
+        if ((board->tab[n->jumps[i].over] == GOAT_CELL) &&
+            (board->tab[n->jumps[i].to] == EMPTY_CELL)) {
+            *captures |= bitboard_cell(n->jumps[i].over);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+// update_tigers updates the mobility of the tigers once the cells `changed`
+// were modified: only the tigers around them are recounted.
+static void update_tigers(game_t *game, bitboard_t changed) {
+    bitboard_t cells = changed;
+
+    if (!influence_initialized) {
+        influence_init();
+    }
+
+    for (bitboard_t c = changed; c; c &= c - 1) {
+        int cell = bitboard_first(c);
+
+        cells |= influence[cell];
+        if (game->board.tab[cell] == TIGER_CELL) {
+            game->tigers |= bitboard_cell(cell);
+        } else if (bitboard_has(game->tigers, cell)) {
+            // The tiger left: it is not movable anymore.
+            game->tigers              &= ~bitboard_cell(cell);
+            game->num_movable_tigers  -= game->tiger_num_mvts[cell] > 0;
+            game->tiger_mobility      -= game->tiger_num_mvts[cell];
+            game->tiger_num_mvts[cell] = 0;
+            game->tiger_captures[cell] = 0;
+        }
+    }
+
+    for (cells &= game->tigers; cells; cells &= cells - 1) {
+        int cell     = bitboard_first(cells);
+        int num_mvts = count_tiger_mvts(&game->board, cell,
+                                        &game->tiger_captures[cell]);
+
+        game->num_movable_tigers += (num_mvts > 0) -
+                                    (game->tiger_num_mvts[cell] > 0);
+        game->tiger_mobility      += num_mvts - game->tiger_num_mvts[cell];
+        game->tiger_num_mvts[cell] = num_mvts;
+    }
+
+    game->threatened_goats = 0;
+    for (bitboard_t t = game->tigers; t; t &= t - 1) {
+        game->threatened_goats |= game->tiger_captures[bitboard_first(t)];
+    }
+}
+
+
+// position_cell returns the bitboard of the position.
+static bitboard_t position_cell(position_t pos) {
+    return bitboard_cell(pos.r * 5 + pos.c);
+}
+
 // See header.
 game_t *game_new() {
-    game_t *new_game = malloc(sizeof(game_t));
+    game_t *new_game = ALLOC_MALLOC(ALLOC_GAME, sizeof(game_t));
 
     if (new_game == NULL) {
         return NULL;
@@ -15,7 +114,7 @@ game_t *game_new() {
 
     new_game->history = new_stack(sizeof(mvt_t), DEFAULT_HISTORY_STACK_SIZE);
     if (new_game->history == NULL) {
-        free(new_game);
+        ALLOC_FREE(ALLOC_GAME, new_game);
         return NULL;
     }
 
@@ -27,7 +126,7 @@ game_t *game_new() {
 // See header.
 void game_free(game_t *g) {
     free_stack(g->history);
-    free(g);
+    ALLOC_FREE(ALLOC_GAME, g);
 }
 
 
@@ -54,6 +153,18 @@ void game_reset(game_t *g) {
     board_set_cell(&g->board, (position_t){4, 4 }, TIGER_CELL);
 
     stack_reset(g->history);
+    game_update_status(g);
+}
+
+
+// See header.
+void game_update_status(game_t *g) {
+    memset(g->tiger_num_mvts, 0, sizeof(g->tiger_num_mvts));
+    memset(g->tiger_captures, 0, sizeof(g->tiger_captures));
+    g->tigers             = 0;
+    g->num_movable_tigers = 0;
+    g->tiger_mobility     = 0;
+    update_tigers(g, BITBOARD_ALL);
 }
 
 
@@ -223,6 +334,71 @@ void game_get_possible_to_positions(game_t *game, position_t from_pos,
 }
 
 
+// See header.
+int game_get_mvts(game_t *game, mvt_t *mvts) {
+    possible_positions_t possible_from;
+    possible_positions_t possible_to;
+    mvt_t                mvt;
+    int                  num_mvts = 0;
+
+    game_get_possible_from_positions(game, &possible_from);
+
+    for (mvt.from.r = 0; mvt.from.r < 5; mvt.from.r++) {
+        for (mvt.from.c = 0; mvt.from.c < 5; mvt.from.c++) {
+            if (!is_position_possible(&possible_from, mvt.from)) {
+                continue;
+            }
+
+            if ((game->turn == GOAT_TURN) && (game->num_goats_to_put > 0)) {
+                mvt.to = (position_t){
+                    POSITION_NOT_SET, POSITION_NOT_SET
+                };
+                mvts[num_mvts++] = mvt;
+                continue;
+            }
+
+            game_get_possible_to_positions(game, mvt.from, &possible_to);
+            for (mvt.to.r = 0; mvt.to.r < 5; mvt.to.r++) {
+                for (mvt.to.c = 0; mvt.to.c < 5; mvt.to.c++) {
+                    if (is_position_possible(&possible_to, mvt.to)) {
+                        mvts[num_mvts++] = mvt;
+                    }
+                }
+            }
+        }
+    }
+
+    return num_mvts;
+}
+
+
+// See header.
+uint64_t game_perft(game_t *game, int depth) {
+    mvt_t    mvts[GAME_MAX_NUM_MVTS];
+    uint64_t num_games = 0;
+
+    if (depth <= 0) {
+        return 1;
+    }
+    if (game_is_done(game)) {
+        return 0;
+    }
+
+    int num_mvts = game_get_mvts(game, mvts);
+    if (depth == 1) {
+        return num_mvts;
+    }
+
+    for (int i = 0; i < num_mvts; i++) {
+        int eaten_goat = game_apply_legal_mvt(game, mvts[i]);
+        num_games += game_perft(game, depth - 1);
+        game_unapply_legal_mvt(game, mvts[i], eaten_goat);
+    }
+
+    return num_games;
+}
+
+
 #define MAX(x, y)    x > y ? x : y
 
 // See header.
@@ -241,6 +417,7 @@ bool game_do_mvt(game_t *game, mvt_t mvt) {
         board_set_cell(&game->board, mvt.from, GOAT_CELL);
         game->num_goats_to_put--;
         game->turn = TIGER_TURN;
+        update_tigers(game, position_cell(mvt.from));
 
         mvt.to.c = POSITION_NOT_SET;
         mvt.to.r = POSITION_NOT_SET;
@@ -278,6 +455,7 @@ bool game_do_mvt(game_t *game, mvt_t mvt) {
         board_set_cell(&game->board, mvt.from, EMPTY_CELL);
         board_set_cell(&game->board, mvt.to, cell_state_to_move);
         game->turn = game->turn == GOAT_TURN ? TIGER_TURN : GOAT_TURN;
+        update_tigers(game, position_cell(mvt.from) | position_cell(mvt.to));
 
         stack_push(game->history, &mvt);
         return true;
@@ -288,6 +466,12 @@ bool game_do_mvt(game_t *game, mvt_t mvt) {
             return false;
         }
 
+        // Jumps go straight over a goat: a1-c2 is not one.
+        if ((abs(mvt.to.c - mvt.from.c) == 1) ||
+            (abs(mvt.to.r - mvt.from.r) == 1)) {
+            return false;
+        }
+
         position_t eaten_goat_pos = {
             (mvt.to.c + mvt.from.c) / 2,
             (mvt.to.r + mvt.from.r) / 2
@@ -302,6 +486,8 @@ bool game_do_mvt(game_t *game, mvt_t mvt) {
         board_set_cell(&game->board, mvt.to, TIGER_CELL);
         game->num_eaten_goats++;
         game->turn = GOAT_TURN;
+        update_tigers(game, position_cell(mvt.from) | position_cell(mvt.to) |
+                      position_cell(eaten_goat_pos));
 
         stack_push(game->history, &mvt);
         return true;
@@ -311,7 +497,127 @@ bool game_do_mvt(game_t *game, mvt_t mvt) {
 }
 
 
-// is_blocked returns true if no move can be done.
+#ifdef DEBUG
+// same_state returns true if both games have the same board, turn, goat
+// counters and tiger mobility.
+static bool same_state(game_t *g1, game_t *g2) {
+    return !memcmp(&g1->board, &g2->board, sizeof(board_t)) &&
+           g1->turn == g2->turn &&
+           g1->num_goats_to_put == g2->num_goats_to_put &&
+           g1->num_eaten_goats == g2->num_eaten_goats &&
+           !memcmp(g1->tiger_num_mvts, g2->tiger_num_mvts,
+                   sizeof(g1->tiger_num_mvts)) &&
+           g1->tigers == g2->tigers &&
+           !memcmp(g1->tiger_captures, g2->tiger_captures,
+                   sizeof(g1->tiger_captures)) &&
+           g1->num_movable_tigers == g2->num_movable_tigers &&
+           g1->tiger_mobility == g2->tiger_mobility &&
+           g1->threatened_goats == g2->threatened_goats;
+}
+
+
+// check_legal_mvt asserts that `game_do_mvt` accepts the movement from the
+// state of `before` and leads to the state of `after`. `game` is left in the
+// state of `before`.
+static void check_legal_mvt(game_t *game, game_t *before, game_t *after,
+                            mvt_t mvt) {
+    *game = *before;
+
+    bool ok = game_do_mvt(game, mvt);
+    assert(ok);
+    assert(same_state(game, after));
+    game_undo(game);
+    assert(same_state(game, before));
+}
+
+
+#endif
+
+// See header.
+int game_apply_legal_mvt(game_t *game, mvt_t mvt) {
+    int eaten_goat = -1;
+
+#ifdef DEBUG
+    game_t before = *game;
+#endif
+
+    bitboard_t changed = position_cell(mvt.from);
+
+    if (!position_is_set(mvt.to)) {
+        board_set_cell(&game->board, mvt.from, GOAT_CELL);
+        game->num_goats_to_put--;
+    } else {
+        cell_state_t moved = board_get_cell(&game->board, mvt.from);
+
+        board_set_cell(&game->board, mvt.from, EMPTY_CELL);
+        board_set_cell(&game->board, mvt.to, moved);
+        changed |= position_cell(mvt.to);
+
+        if ((abs(mvt.to.c - mvt.from.c) == 2) ||
+            (abs(mvt.to.r - mvt.from.r) == 2)) {
+            position_t eaten_goat_pos = {
+                (mvt.to.c + mvt.from.c) / 2,
+                (mvt.to.r + mvt.from.r) / 2
+            };
+
+            board_set_cell(&game->board, eaten_goat_pos, EMPTY_CELL);
+            game->num_eaten_goats++;
+            eaten_goat = eaten_goat_pos.r * 5 + eaten_goat_pos.c;
+            changed   |= bitboard_cell(eaten_goat);
+        }
+    }
+
+    game->turn = game->turn == GOAT_TURN ? TIGER_TURN : GOAT_TURN;
+    update_tigers(game, changed);
+
+#ifdef DEBUG
+    game_t after = *game;
+    check_legal_mvt(game, &before, &after, mvt);
+    *game = after;
+#endif
+
+    return eaten_goat;
+}
+
+
+// See header.
+void game_unapply_legal_mvt(game_t *game, mvt_t mvt, int eaten_goat) {
+#ifdef DEBUG
+    game_t after = *game;
+#endif
+
+    bitboard_t changed = position_cell(mvt.from);
+
+    game->turn = game->turn == GOAT_TURN ? TIGER_TURN : GOAT_TURN;
+
+    if (!position_is_set(mvt.to)) {
+        board_set_cell(&game->board, mvt.from, EMPTY_CELL);
+        game->num_goats_to_put++;
+    } else {
+        board_set_cell(&game->board, mvt.from,
+                       board_get_cell(&game->board, mvt.to));
+        board_set_cell(&game->board, mvt.to, EMPTY_CELL);
+        changed |= position_cell(mvt.to);
+
+        if (eaten_goat >= 0) {
+            game->board.tab[eaten_goat] = GOAT_CELL;
+            game->num_eaten_goats--;
+            changed |= bitboard_cell(eaten_goat);
+        }
+    }
+
+    update_tigers(game, changed);
+
+#ifdef DEBUG
+    game_t before = *game;
+    check_legal_mvt(game, &before, &after, mvt);
+#endif
+}
+
+
+#ifdef DEBUG
+// is_blocked returns true if no move can be done. It checks the tracked
+// mobility of the tigers in debug builds.
 static bool is_blocked(board_t *board, player_turn_t turn) {
     cell_state_t movable_cell = turn == TIGER_TURN ? TIGER_CELL : GOAT_CELL;
 
@@ -336,36 +642,81 @@ static bool is_blocked(board_t *board, player_turn_t turn) {
 }
 
 
+#endif
+
 // See header.
 int game_count_num_movable_tigers(game_t *game) {
-    int        count = 0;
-    position_t pos;
+    return game->num_movable_tigers;
+}
 
-    for (pos.c = 0; pos.c < 5; pos.c++) {
-        for (pos.r = 0; pos.r < 5; pos.r++) {
-            if (board_get_cell(&game->board, pos) == TIGER_CELL) {
-                bool movable = false;
-                if (test_possible_position(&game->board, pos, false, NULL)) {
-                    movable = true;
-                }
-                if (position_has_diagonal(pos)) {
-                    if (test_possible_position(&game->board, pos, true, NULL)) {
-                        movable = true;
-                    }
-                }
 
-                if (movable) {
-                    count++;
-                }
+// See header.
+void game_get_threats(game_t *game, game_threats_t *threats) {
+    bitboard_t empty  = 0;
+    bitboard_t unsafe = 0;
+
+    threats->capturable_goats = 0;
+    threats->landing_cells    = 0;
+
+    for (int cell = 0; cell < 5 * 5; cell++) {
+        empty |= (bitboard_t)(game->board.tab[cell] == EMPTY_CELL) << cell;
+    }
+
+    for (bitboard_t t = game->tigers; t; t &= t - 1) {
+        const bitboard_neighbours_t *n = bitboard_neighbours(bitboard_first(t));
+
+        for (int i = 0; i < n->num_jumps; i++) {
+            if (!bitboard_has(empty, n->jumps[i].to)) {
+                continue;
+            }
+
+            if (bitboard_has(empty, n->jumps[i].over)) {
+                unsafe |= bitboard_cell(n->jumps[i].over);
+            } else if (game->board.tab[n->jumps[i].over] == GOAT_CELL) {
+                threats->capturable_goats |= bitboard_cell(n->jumps[i].over);
+                threats->landing_cells    |= bitboard_cell(n->jumps[i].to);
             }
         }
     }
+
+    threats->safe_cells = empty & ~unsafe;
+}
+
+
+// See header.
+bitboard_t game_get_tiger_regions(game_t *game, bitboard_t regions[5 * 5]) {
+    bitboard_t goats = 0;
+
+    for (int cell = 0; cell < 5 * 5; cell++) {
+        goats |= (bitboard_t)(game->board.tab[cell] == GOAT_CELL) << cell;
+    }
+
+    return bitboard_tiger_regions(game->tigers, goats, regions);
+}
+
+
+// See header.
+game_features_t game_get_features(game_t *game) {
+    return (game_features_t){
+               .num_eaten_goats         = game->num_eaten_goats,
+               .num_tigers_on_diagonals = bitboard_count(game->tigers &
+                                                         BITBOARD_DIAGONALS),
+               .num_movable_tigers   = game->num_movable_tigers,
+               .tiger_mobility       = game->tiger_mobility,
+               .num_threatened_goats = bitboard_count(game->threatened_goats)
+    };
 }
 
 
 // See header.
 bool game_is_done(game_t *game) {
-    return game->num_eaten_goats > 4 || is_blocked(&game->board, TIGER_TURN);
+#ifdef DEBUG
+    assert((game->num_movable_tigers == 0) ==
+           is_blocked(&game->board, TIGER_TURN));
+#endif
+
+    return game->num_eaten_goats >= GOATS_EATEN_TO_WIN ||
+           game->num_movable_tigers == 0;
 }
 
 
@@ -383,6 +734,7 @@ int game_undo(game_t *game) {
         board_set_cell(&game->board, mvt.from, EMPTY_CELL);
         game->num_goats_to_put++;
         game->turn = GOAT_TURN;
+        update_tigers(game, position_cell(mvt.from));
         return 0;
     }
 
@@ -395,6 +747,7 @@ int game_undo(game_t *game) {
         board_set_cell(&game->board, mvt.to, EMPTY_CELL);
         board_set_cell(&game->board, mvt.from, cell_state_moved);
         game->turn = game->turn == GOAT_TURN ? TIGER_TURN : GOAT_TURN;
+        update_tigers(game, position_cell(mvt.from) | position_cell(mvt.to));
         return 0;
 
     case 2:
@@ -409,6 +762,8 @@ int game_undo(game_t *game) {
         board_set_cell(&game->board, mvt.from, TIGER_CELL);
         game->num_eaten_goats--;
         game->turn = TIGER_TURN;
+        update_tigers(game, position_cell(mvt.from) | position_cell(mvt.to) |
+                      position_cell(eaten_goat_pos));
         return 0;
     }
 
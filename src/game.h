@@ -2,21 +2,48 @@
 #define __GAME_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 
+#include "bitboard.h"
 #include "models.h"
 #include "stack.h"
 
+// GOATS_EATEN_TO_WIN is the number of goats tigers have to eat to win.
+#define GOATS_EATEN_TO_WIN    5
+
 typedef struct {
     board_t       board;
     player_turn_t turn;
     int           num_goats_to_put;
     int           num_eaten_goats;
     stack_t       *history;
+
+    // The mobility of the tigers is updated along the movements, from the
+    // cells next to them only. See `game_update_status`.
+    bitboard_t    tigers;
+    uint8_t       tiger_num_mvts[5 * 5]; // Movements of the tiger of a cell.
+    bitboard_t    tiger_captures[5 * 5]; // Goats the tiger of a cell can eat.
+    int           num_movable_tigers;
+    int           tiger_mobility;   // Movements of all the tigers.
+    bitboard_t    threatened_goats; // Goats a tiger can eat.
 } game_t;
 
+// game_features_t are the features of a position evaluations are built on.
+typedef struct {
+    int num_eaten_goats;
+    int num_tigers_on_diagonals;
+    int num_movable_tigers;
+    int tiger_mobility;       // Movements of all the tigers.
+    int num_threatened_goats; // Goats a tiger can eat at its next movement.
+} game_features_t;
+
 // game_reset resets the game.
 void game_reset(game_t *g);
 
+// game_update_status recomputes the mobility of the tigers. It must be called
+// once the board is set without movements.
+void game_update_status(game_t *g);
+
 // game_new creates a new game object.
 game_t *game_new();
 
@@ -25,6 +52,14 @@ void game_free(game_t *g);
 
 
 
+// GAME_MAX_NUM_MVTS is the maximum number of movements of a player.
+#define GAME_MAX_NUM_MVTS    128
+
+// game_get_mvts writes the movements the current player can do to `mvts`,
+// which must hold GAME_MAX_NUM_MVTS movements.
+// Returns the number of movements.
+int game_get_mvts(game_t *g, mvt_t *mvts);
+
 // game_get_possible_to_positions updates the `pos` structure with the
 // valid to positions given a from position.
 void game_get_possible_to_positions(game_t *g, position_t from_pos,
@@ -39,6 +74,26 @@ void game_get_possible_from_positions(game_t *g, possible_positions_t *pos);
 // Returns 0 if the movement is not feasible. 1 otherwhise.
 bool game_do_mvt(game_t *g, mvt_t mvt);
 
+// game_apply_legal_mvt does the movement without checking it nor recording it
+// in the history: it must come from `game_get_mvts` (or the possible
+// positions) of the current game. Searches use it with
+// `game_unapply_legal_mvt` while human inputs go through `game_do_mvt`.
+// In debug builds, the result is checked against `game_do_mvt`.
+// Returns the cell index (r * 5 + c) of the eaten goat, -1 if none: it is
+// needed to undo the movement.
+int game_apply_legal_mvt(game_t *g, mvt_t mvt);
+
+// game_unapply_legal_mvt undoes the last movement done with
+// `game_apply_legal_mvt`, which returned `eaten_goat`.
+void game_unapply_legal_mvt(game_t *g, mvt_t mvt, int eaten_goat);
+
+// game_perft returns the number of games reached after `depth` movements
+// (performance test): the movements are generated by `game_get_mvts` and
+// applied with `game_apply_legal_mvt`. Done games are not played further.
+// Counts from known positions check the rules, and their speed the one of the
+// movement generation. See `build/perft`.
+uint64_t game_perft(game_t *g, int depth);
+
 // game_is_done returns 0 if the game is still on. 1 if the game is done.
 // The looser can be retrived by looking at `game.turn`.
 // If `game.turn == TIGER_TURN`, tigers have lost the game and goats won.
@@ -52,4 +107,29 @@ int game_undo(game_t *g);
 // game_count_num_movable_tigers returns the number of tigers that can be moved.
 int game_count_num_movable_tigers(game_t *game);
 
+// game_threats_t are the threats of tigers on the board.
+typedef struct {
+    bitboard_t capturable_goats; // Goats a tiger can eat at its next movement.
+    bitboard_t landing_cells;    // Cells where a tiger lands when eating.
+    bitboard_t safe_cells;       // Empty cells where a goat cannot be eaten.
+} game_threats_t;
+
+// game_get_threats sets `threats` in one pass over the jumps of the tigers.
+// A cell is safe if no tiger can jump over it to an empty cell: a goat put
+// there cannot be eaten at the next tiger movement. A goat moving there
+// leaves its cell empty, where a tiger may then land.
+void game_get_threats(game_t *game, game_threats_t *threats);
+
+// game_get_tiger_regions sets `regions[cell]` to the empty cells the tiger on
+// `cell` can reach (see `bitboard_tiger_regions`). The size of the free area
+// is an evaluation term; a tiger whose region is empty cannot move and small
+// regions tell searches the tigers are being enclosed.
+// Returns the free area of the tigers.
+bitboard_t game_get_tiger_regions(game_t *game, bitboard_t regions[5 * 5]);
+
+// game_get_features returns the evaluation features of the game. They are
+// updated along the movements with the mobility of the tigers: getting them
+// doesn't scan the board.
+game_features_t game_get_features(game_t *game);
+
 #endif
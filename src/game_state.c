@@ -0,0 +1,157 @@
+#include "game_state.h"
+#include "zobrist.h"
+
+
+// See header.
+void game_state_from_game(game_t *game, game_state_t *state) {
+    state->hash             = zobrist_hash_game(game);
+    state->tigers           = bitboard_from_board(&game->board, TIGER_CELL);
+    state->goats            = bitboard_from_board(&game->board, GOAT_CELL);
+    state->turn             = game->turn;
+    state->num_goats_to_put = game->num_goats_to_put;
+    state->num_eaten_goats  = game->num_eaten_goats;
+}
+
+
+// See header.
+void game_state_to_game(const game_state_t *state, game_t *game) {
+    bitboard_to_board(state->tigers, state->goats, &game->board);
+    game->turn             = state->turn;
+    game->num_goats_to_put = state->num_goats_to_put;
+    game->num_eaten_goats  = state->num_eaten_goats;
+    stack_reset(game->history);
+    game_update_status(game);
+}
+
+
+// See header.
+bool game_state_is_done(const game_state_t *state) {
+    return state->num_eaten_goats >= GOATS_EATEN_TO_WIN ||
+           bitboard_tigers_blocked(state->tigers, state->goats);
+}
+
+
+// See header.
+int game_state_get_mvts(const game_state_t *state, game_state_mvt_t *mvts) {
+    bitboard_t empty    = ~(state->tigers | state->goats) & BITBOARD_ALL;
+    int        num_mvts = 0;
+
+    if ((state->turn == GOAT_TURN) && (state->num_goats_to_put > 0)) {
+        for (bitboard_t to = empty; to; to &= to - 1) {
+            mvts[num_mvts++] = (game_state_mvt_t){
+                -1, bitboard_first(to), -1
+            };
+        }
+        return num_mvts;
+    }
+
+    bitboard_t tokens = state->turn == TIGER_TURN ? state->tigers : state->goats;
+    for (; tokens; tokens &= tokens - 1) {
+        int                         from  = bitboard_first(tokens);
+        const bitboard_neighbours_t *n    = bitboard_neighbours(from);
+        bitboard_t                  steps = n->mask & empty;
+        bitboard_t                  jumps = 0;
+
+        if (state->turn == TIGER_TURN) {
+            for (int i = 0; i < n->num_jumps; i++) {
+                if (bitboard_has(state->goats, n->jumps[i].over) &&
+                    bitboard_has(empty, n->jumps[i].to)) {
+                    jumps |= bitboard_cell(n->jumps[i].to);
+                }
+            }
+        }
+
+        // Steps and jumps are merged to keep the order of the destinations.
+        for (bitboard_t to = steps | jumps; to; to &= to - 1) {
+            int cell = bitboard_first(to);
+
+            mvts[num_mvts++] = (game_state_mvt_t){
+                from, cell, bitboard_has(jumps, cell) ? (from + cell) / 2 : -1
+            };
+        }
+    }
+
+    return num_mvts;
+}
+
+
+// See header.
+void game_state_play(const game_state_t *state, game_state_mvt_t mvt,
+                     game_state_t *next) {
+    uint64_t hash = state->hash ^ zobrist_turn_key() ^
+                    zobrist_goats_key(state->num_goats_to_put,
+                                      state->num_eaten_goats);
+
+    *next = *state;
+
+    if (mvt.from < 0) {
+        next->goats |= bitboard_cell(mvt.to);
+        next->num_goats_to_put--;
+        hash ^= zobrist_cell_key(mvt.to, GOAT_CELL);
+    } else if (state->turn == TIGER_TURN) {
+        next->tigers ^= bitboard_cell(mvt.from) | bitboard_cell(mvt.to);
+        hash ^= zobrist_cell_key(mvt.from, TIGER_CELL) ^
+                zobrist_cell_key(mvt.to, TIGER_CELL);
+
+        if (mvt.over >= 0) {
+            next->goats &= ~bitboard_cell(mvt.over);
+            next->num_eaten_goats++;
+            hash ^= zobrist_cell_key(mvt.over, GOAT_CELL);
+        }
+    } else {
+        next->goats ^= bitboard_cell(mvt.from) | bitboard_cell(mvt.to);
+        hash ^= zobrist_cell_key(mvt.from, GOAT_CELL) ^
+                zobrist_cell_key(mvt.to, GOAT_CELL);
+    }
+
+    next->turn = state->turn == GOAT_TURN ? TIGER_TURN : GOAT_TURN;
+    next->hash = hash ^ zobrist_goats_key(next->num_goats_to_put,
+                                          next->num_eaten_goats);
+}
+
+
+// See header.
+mvt_t game_state_to_mvt(game_state_mvt_t mvt) {
+    if (mvt.from < 0) {
+        return (mvt_t){
+                   { mvt.to % 5, mvt.to / 5 }, { POSITION_NOT_SET, POSITION_NOT_SET }
+        };
+    }
+
+    return (mvt_t){
+               { mvt.from % 5, mvt.from / 5 }, { mvt.to % 5, mvt.to / 5 }
+    };
+}
+
+
+// See header.
+bool game_state_playout(game_state_t *state, int max_plies, uint64_t *seed) {
+    for (int ply = 0; ply < max_plies; ply++) {
+        game_state_mvt_t mvts[GAME_MAX_NUM_MVTS];
+
+        if (game_state_is_done(state)) {
+            return true;
+        }
+
+        int num_mvts = game_state_get_mvts(state, mvts);
+        if (num_mvts == 0) {
+            // Goats cannot move: they lost.
+            return true;
+        }
+
+        game_state_play(state, mvts[game_state_random(seed) % num_mvts], state);
+    }
+
+    return game_state_is_done(state);
+}
+
+
+// See header.
+// See: http://xoshiro.di.unimi.it/splitmix64.c
+uint64_t game_state_random(uint64_t *seed) {
+    uint64_t z = (*seed += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,65 @@
+#ifndef __GAME_STATE_H__
+#define __GAME_STATE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "game.h"
+#include "models.h"
+
+// game_state_t is a compact copy of the state of a game, without its history.
+// It holds no pointer: searches copy it on the stack to play a movement
+// (copy-make) instead of doing and undoing movements on a `game_t`.
+typedef struct {
+    uint64_t   hash; // `zobrist_hash_game` of the state.
+    bitboard_t tigers;
+    bitboard_t goats;
+    uint8_t    turn; // player_turn_t.
+    uint8_t    num_goats_to_put;
+    uint8_t    num_eaten_goats;
+} game_state_t;
+
+// game_state_mvt_t is a movement of a `game_state_t`, with cell indexes
+// (r * 5 + c). `from` is -1 when a goat is put on `to`, `over` is the cell of
+// the eaten goat or -1.
+typedef struct {
+    int8_t from;
+    int8_t to;
+    int8_t over;
+} game_state_mvt_t;
+
+// game_state_from_game copies the state of the game.
+void game_state_from_game(game_t *game, game_state_t *state);
+
+// game_state_to_game sets the game to the state. Its history is cleared.
+void game_state_to_game(const game_state_t *state, game_t *game);
+
+// game_state_is_done is `game_is_done` for a state.
+bool game_state_is_done(const game_state_t *state);
+
+// game_state_get_mvts writes the movements the current player can do to
+// `mvts`, which must hold GAME_MAX_NUM_MVTS movements, in the order of
+// `game_get_mvts`.
+// Returns the number of movements.
+int game_state_get_mvts(const game_state_t *state, game_state_mvt_t *mvts);
+
+// game_state_play writes to `next` the state after the movement, which must
+// be one of `game_state_get_mvts`. `next` can be `state`.
+void game_state_play(const game_state_t *state, game_state_mvt_t mvt,
+                     game_state_t *next);
+
+// game_state_to_mvt returns the movement as a `mvt_t` for `game_do_mvt`.
+mvt_t game_state_to_mvt(game_state_mvt_t mvt);
+
+// game_state_playout plays random movements from the state until the game is
+// done or `max_plies` movements are played. `seed` is the state of the random
+// generator: it is updated.
+// Returns true if the game is done: the player who has to play lost.
+bool game_state_playout(game_state_t *state, int max_plies, uint64_t *seed);
+
+// game_state_random returns a random number from the generator state `seed`
+// and updates it.
+uint64_t game_state_random(uint64_t *seed);
+
+#endif
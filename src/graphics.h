@@ -1,6 +1,7 @@
 #ifndef __GRAPHICS_H__
 #define __GRAPHICS_H__
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 #include "models.h"
@@ -12,6 +13,7 @@ typedef struct {
     mvt_t                input;
     possible_positions_t possible_positions;
     char                 *msg;
+    char                 *info; // Last search of an AI, see `ai_get_info_callback_t`.
 } game_state_to_draw_t;
 
 typedef    enum {
@@ -49,6 +51,12 @@ typedef void (*graphics_draw_game_callback_t)(void *context, game_state_to_draw_
 // to wait for events.
 typedef void (*graphics_wait_event_game_callback_t)(void *context, event_t *event);
 
+// graphics_poll_event_game_callback_t defines the function to be used as a
+// callback to wait for an event at most `timeout_ms` milliseconds, so that
+// the game goes on while an AI is searching.
+// Returns false if no event happened.
+typedef bool (*graphics_poll_event_game_callback_t)(void *context, event_t *event, int timeout_ms);
+
 typedef void (*graphics_wait_event_menu_callback_t)(void *context, event_t *event, menu_t *menu);
 
 typedef void (*graphics_draw_menu_callback_t)(void *context, menu_t *menu);
@@ -56,6 +64,7 @@ typedef void (*graphics_draw_menu_callback_t)(void *context, menu_t *menu);
 typedef struct {
     graphics_draw_game_callback_t       draw_game;
     graphics_wait_event_game_callback_t wait_event_game;
+    graphics_poll_event_game_callback_t poll_event_game;
     graphics_wait_event_menu_callback_t wait_event_menu;
     graphics_draw_menu_callback_t       draw_menu;
 } graphics_callbacks_t;
@@ -6,6 +6,7 @@
 #include "graphics_minimalist_sdl.h"
 #include "tools.h"
 #include "menu.h"
+#include "trace.h"
 
 #define SCALE                      1
 
@@ -32,6 +33,8 @@
 #define NUM_EATEN_GOATS_Y          740 * SCALE
 #define MSG_X                      40 * SCALE
 #define MSG_Y                      740 * SCALE
+#define INFO_X                     40 * SCALE
+#define INFO_Y                     775 * SCALE
 #define MENU_TITLE_Y               100 * SCALE
 #define MENU_ITEM_ROW              200 * SCALE
 #define MENU_LINE_ITEMS_SPACING    50 * SCALE
@@ -66,6 +69,7 @@
 #define TXT_COLOR_B                255
 
 #define FONT_SIZE                  30 * SCALE
+#define INFO_FONT_SIZE             14 * SCALE
 
 
 static int init_tags(graphics_minimalist_sdl_t *sg) {
@@ -114,9 +118,10 @@ static void free_tags(graphics_minimalist_sdl_t *sg) {
 }
 
 
-static SDL_Texture *str_to_texture(graphics_minimalist_sdl_t *sg,
-                                   char                      *s) {
-    SDL_Surface *surface = TTF_RenderText_Blended(sg->font,
+static SDL_Texture *font_str_to_texture(graphics_minimalist_sdl_t *sg,
+                                        TTF_Font                  *font,
+                                        char                      *s) {
+    SDL_Surface *surface = TTF_RenderText_Blended(font,
                                                   s,
                                                   (SDL_Color){TXT_COLOR_R,
                                                               TXT_COLOR_G,
@@ -135,6 +140,12 @@ static SDL_Texture *str_to_texture(graphics_minimalist_sdl_t *sg,
 }
 
 
+static SDL_Texture *str_to_texture(graphics_minimalist_sdl_t *sg,
+                                   char                      *s) {
+    return font_str_to_texture(sg, sg->font, s);
+}
+
+
 // create_text_textures creates the needed textures for the prompt.
 // Returns true if an error happend.
 static bool create_text_textures(graphics_minimalist_sdl_t *sg) {
@@ -170,6 +181,7 @@ graphics_minimalist_sdl_t *graphics_minimalist_sdl_init(char *font_filename) {
     sg->renderer                = NULL;
     sg->tags_textures           = NULL;
     sg->font                    = NULL;
+    sg->info_font               = NULL;
     sg->prompt_to_texture       = NULL;
     sg->prompt_put_texture      = NULL;
     sg->prompt_move_texture     = NULL;
@@ -199,6 +211,13 @@ graphics_minimalist_sdl_t *graphics_minimalist_sdl_init(char *font_filename) {
         return NULL;
     }
 
+    sg->info_font = TTF_OpenFont(font_filename, INFO_FONT_SIZE);
+    if (sg->info_font == NULL) {
+        fprintf(stderr, "Error while loading font: %s\n", TTF_GetError());
+        graphics_minimalist_sdl_quit(sg);
+        return NULL;
+    }
+
     sg->win = SDL_CreateWindow(WIN_TITLE,
                                SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
                                WIN_WIDTH, WIN_HEIGHT,
@@ -610,6 +629,18 @@ static void draw_message(graphics_minimalist_sdl_t *sg, game_state_to_draw_t *st
 }
 
 
+// draw_info draws the description of the last search of an AI, in a smaller
+// font under the message.
+static void draw_info(graphics_minimalist_sdl_t *sg, game_state_to_draw_t *state) {
+    if (state->info[0] == '\0') {
+        return;
+    }
+    SDL_Texture *texture = font_str_to_texture(sg, sg->info_font, state->info);
+    draw_texture(sg, texture, INFO_X, INFO_Y);
+    SDL_DestroyTexture(texture);
+}
+
+
 static void draw_goat_info_icon(graphics_minimalist_sdl_t *sg) {
     SDL_SetRenderDrawColor(sg->renderer,
                            GOAT_COLOR_R,
@@ -622,6 +653,8 @@ static void draw_goat_info_icon(graphics_minimalist_sdl_t *sg) {
 
 
 void graphics_minimalist_sdl_draw_game(void *context, game_state_to_draw_t *state) {
+    TRACE_FUNCTION();
+
     graphics_minimalist_sdl_t *sg = context;
 
     SDL_SetRenderDrawColor(sg->renderer,
@@ -638,6 +671,7 @@ void graphics_minimalist_sdl_draw_game(void *context, game_state_to_draw_t *stat
     draw_num_eaten_goats(sg, state);
     draw_goat_info_icon(sg);
     draw_message(sg, state);
+    draw_info(sg, state);
     SDL_RenderPresent(sg->renderer);
 }
 
@@ -745,120 +779,145 @@ static void graphics_draw_menu(void *context, menu_t *menu) {
 
 
 void graphics_minimalist_sdl_wait_game_event(void *context, event_t *event) {
+    TRACE_FUNCTION();
+
     graphics_minimalist_sdl_wait_menu_event(context, event, NULL);
 }
 
 
-void graphics_minimalist_sdl_wait_menu_event(void *context, event_t *event, menu_t *menu) {
-    graphics_minimalist_sdl_t *sg = context;
+// convert_event sets `event` from the SDL event `sdl_event`.
+// Returns true if the event is one of the game or of the `menu`.
+static bool convert_event(graphics_minimalist_sdl_t *sg, SDL_Event *sdl_event,
+                          event_t *event, menu_t *menu) {
+    switch (sdl_event->type) {
+    case SDL_TEXTINPUT:
+        // We only want ASCII caracters.
+        if ((sdl_event->text.text[0] != '\0') &&
+            (sdl_event->text.text[1] == '\0')) {
+            event->type = EVENT_KEY;
+            event->key  = KEY_CH;
+            event->ch   = sdl_event->text.text[0];
+            return true;
+        }
 
-    while (1) {
-        SDL_Event sdl_event;
-        SDL_WaitEvent(&sdl_event);
-        switch (sdl_event.type) {
-        case SDL_TEXTINPUT:
-            // We only want ASCII caracters.
-            if ((sdl_event.text.text[0] != '\0') &&
-                (sdl_event.text.text[1] == '\0')) {
-                event->type = EVENT_KEY;
-                event->key  = KEY_CH;
-                event->ch   = sdl_event.text.text[0];
-                return;
-            }
+    case SDL_KEYDOWN:
+        event->type = EVENT_KEY;
+        switch (sdl_event->key.keysym.sym) {
+        case SDLK_ESCAPE:
+            event->type = EVENT_QUIT;
+            event->key  = KEY_ESC;
+            return true;
 
-        case SDL_KEYDOWN:
-            event->type = EVENT_KEY;
-            switch (sdl_event.key.keysym.sym) {
-            case SDLK_ESCAPE:
+        case SDLK_q:
+            if (sdl_event->key.keysym.mod & KMOD_SHIFT) {
                 event->type = EVENT_QUIT;
-                event->key  = KEY_ESC;
-                return;
+                return true;
+            }
+            break;
 
-            case SDLK_q:
-                if (sdl_event.key.keysym.mod & KMOD_SHIFT) {
-                    event->type = EVENT_QUIT;
-                    return;
-                }
-                break;
+        case SDLK_BACKSPACE:
+            event->key = KEY_BACKSPACE;
+            return true;
 
-            case SDLK_BACKSPACE:
-                event->key = KEY_BACKSPACE;
-                return;
+        case SDLK_RETURN:
+            event->key = KEY_ENTER;
+            return true;
 
-            case SDLK_RETURN:
-                event->key = KEY_ENTER;
-                return;
+        case SDLK_LEFT:
+            event->key = KEY_ARROW_LEFT;
+            return true;
 
-            case SDLK_LEFT:
-                event->key = KEY_ARROW_LEFT;
-                return;
+        case SDLK_RIGHT:
+            event->key = KEY_ARROW_RIGHT;
+            return true;
 
-            case SDLK_RIGHT:
-                event->key = KEY_ARROW_RIGHT;
-                return;
+        case SDLK_UP:
+            event->key = KEY_ARROW_UP;
+            return true;
 
-            case SDLK_UP:
-                event->key = KEY_ARROW_UP;
-                return;
+        case SDLK_DOWN:
+            event->key = KEY_ARROW_DOWN;
+            return true;
+        }
+        break;
 
-            case SDLK_DOWN:
-                event->key = KEY_ARROW_DOWN;
-                return;
-            }
-            break;
+    case SDL_QUIT:
+        event->type = EVENT_QUIT;
+        return true;
 
-        case SDL_QUIT:
-            event->type = EVENT_QUIT;
-            return;
-
-        case SDL_WINDOWEVENT:
-            event->type = EVENT_REDRAW;
-            return;
-
-        case SDL_MOUSEBUTTONDOWN:
-            if (menu != NULL) {
-                int selected_menu_item = -1;
-                int label_length       = 0;
-                if (sdl_event.button.y - MENU_ITEM_ROW >= 0) {
-                    selected_menu_item = (sdl_event.button.y - MENU_ITEM_ROW) / MENU_LINE_ITEMS_SPACING;
-                }
-                if ((selected_menu_item < menu->num_items) &&
-                    (selected_menu_item >= 0)) {
-                    label_length = get_label_clickable_length(sg, menu->items[selected_menu_item]);
-                    if ((sdl_event.button.x >= WIN_WIDTH / 2 - label_length / 2) &&
-                        (sdl_event.button.x <= WIN_WIDTH / 2 + label_length / 2)) {
-                        event->type      = EVENT_MENU_ITEM_CLICKED;
-                        event->menu_item = selected_menu_item;
-                        return;
-                    }
+    case SDL_WINDOWEVENT:
+        event->type = EVENT_REDRAW;
+        return true;
+
+    case SDL_MOUSEBUTTONDOWN:
+        if (menu != NULL) {
+            int selected_menu_item = -1;
+            int label_length       = 0;
+            if (sdl_event->button.y - MENU_ITEM_ROW >= 0) {
+                selected_menu_item = (sdl_event->button.y - MENU_ITEM_ROW) / MENU_LINE_ITEMS_SPACING;
+            }
+            if ((selected_menu_item < menu->num_items) &&
+                (selected_menu_item >= 0)) {
+                label_length = get_label_clickable_length(sg, menu->items[selected_menu_item]);
+                if ((sdl_event->button.x >= WIN_WIDTH / 2 - label_length / 2) &&
+                    (sdl_event->button.x <= WIN_WIDTH / 2 + label_length / 2)) {
+                    event->type      = EVENT_MENU_ITEM_CLICKED;
+                    event->menu_item = selected_menu_item;
+                    return true;
                 }
-            } else {
-                // Positions relative to the board.
-                int x = sdl_event.button.x - (BOARD_X - POSITION_WIDTH / 2);
-                int y = sdl_event.button.y - (BOARD_Y - POSITION_HEIGHT / 2);
-
-                if ((x > 0) && ((x < (4 * POSITION_SPACING_WIDTH + POSITION_WIDTH)) &&
-                                (y > 0) && (x < 4 * POSITION_SPACING_HEIGHT + POSITION_HEIGHT))) {
-                    // We are in the board.
-
-                    position_t pos = {
-                        x / POSITION_SPACING_WIDTH,
-                        y / POSITION_SPACING_HEIGHT
-                    };
-
-                    // Positions relative to the placement.
-                    int x_placement = x % 5;
-                    int y_placement = y % 5;
-                    if ((x_placement < POSITION_SPACING_WIDTH) &&
-                        (y_placement < POSITION_SPACING_HEIGHT)) {
-                        event->type     = EVENT_POSITION;
-                        event->position = pos;
-                        return;
-                    }
+            }
+        } else {
+            // Positions relative to the board.
+            int x = sdl_event->button.x - (BOARD_X - POSITION_WIDTH / 2);
+            int y = sdl_event->button.y - (BOARD_Y - POSITION_HEIGHT / 2);
+
+            if ((x > 0) && ((x < (4 * POSITION_SPACING_WIDTH + POSITION_WIDTH)) &&
+                            (y > 0) && (x < 4 * POSITION_SPACING_HEIGHT + POSITION_HEIGHT))) {
+                // We are in the board.
+
+                position_t pos = {
+                    x / POSITION_SPACING_WIDTH,
+                    y / POSITION_SPACING_HEIGHT
+                };
+
+                // Positions relative to the placement.
+                int x_placement = x % 5;
+                int y_placement = y % 5;
+                if ((x_placement < POSITION_SPACING_WIDTH) &&
+                    (y_placement < POSITION_SPACING_HEIGHT)) {
+                    event->type     = EVENT_POSITION;
+                    event->position = pos;
+                    return true;
                 }
             }
         }
     }
+
+    return false;
+}
+
+
+void graphics_minimalist_sdl_wait_menu_event(void *context, event_t *event, menu_t *menu) {
+    graphics_minimalist_sdl_t *sg = context;
+    SDL_Event                 sdl_event;
+
+    do {
+        SDL_WaitEvent(&sdl_event);
+    } while (!convert_event(sg, &sdl_event, event, menu));
+}
+
+
+bool graphics_minimalist_sdl_poll_game_event(void *context, event_t *event, int timeout_ms) {
+    TRACE_FUNCTION();
+
+    graphics_minimalist_sdl_t *sg = context;
+    SDL_Event                 sdl_event;
+
+    if (!SDL_WaitEventTimeout(&sdl_event, timeout_ms)) {
+        return false;
+    }
+
+    return convert_event(sg, &sdl_event, event, NULL);
 }
 
 
@@ -867,6 +926,9 @@ void graphics_minimalist_sdl_quit(graphics_minimalist_sdl_t *sg) {
         if (sg->font) {
             TTF_CloseFont(sg->font);
         }
+        if (sg->info_font) {
+            TTF_CloseFont(sg->info_font);
+        }
 
         SDL_Texture *textures_to_destroy[] = {
             sg->prompt_to_texture,
@@ -908,6 +970,7 @@ void graphics_minimalist_sdl_quit(graphics_minimalist_sdl_t *sg) {
 graphics_callbacks_t graphics_minimalist_sdl_callbacks = {
     .draw_game       = graphics_minimalist_sdl_draw_game,
     .wait_event_game = graphics_minimalist_sdl_wait_game_event,
+    .poll_event_game = graphics_minimalist_sdl_poll_game_event,
     .wait_event_menu = graphics_minimalist_sdl_wait_menu_event,
     .draw_menu       = graphics_draw_menu
 };
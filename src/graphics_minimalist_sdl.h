@@ -12,6 +12,7 @@ typedef struct {
     SDL_Renderer *renderer;
     SDL_Texture  **tags_textures;
     TTF_Font     *font;
+    TTF_Font     *info_font;
     SDL_Texture  *prompt_put_texture;
     SDL_Texture  *prompt_move_texture;
     SDL_Texture  *prompt_to_texture;
@@ -26,6 +27,7 @@ graphics_minimalist_sdl_t *graphics_minimalist_sdl_init(char *font_filename);
 void graphics_minimalist_sdl_draw_game(void *context, game_state_to_draw_t *state);
 void graphics_minimalist_sdl_wait_game_event(void *context, event_t *event);
 void graphics_minimalist_sdl_wait_menu_event(void *context, event_t *event, menu_t *menu);
+bool graphics_minimalist_sdl_poll_game_event(void *context, event_t *event, int timeout_ms);
 void graphics_minimalist_sdl_quit(graphics_minimalist_sdl_t *tg);
 
 extern graphics_callbacks_t graphics_minimalist_sdl_callbacks;
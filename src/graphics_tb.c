@@ -5,6 +5,7 @@
 
 #include "graphics_tb.h"
 #include "menu.h"
+#include "trace.h"
 
 
 /*
@@ -26,11 +27,13 @@
  *
  * Move a1 to b1                                            < MOVE_ROW
  *
+ * d6 +3.0 12.3k nodes 1.2M/s 1st cut 87% pv c3 b2-b3       < INFO_ROW
+ *
  *      ^                    ^      ^       ^
  *      PADDING_COL          + ---- +       TURN_COL
  * ^                         SPACING_COL    GOAT_EATEN_COL
  * MOVE_COL                                 GOAT_LEFT_COL
- *                                          MSG_COL
+ * INFO_COL                                 MSG_COL
  *                                          QUIT_COL
  */
 
@@ -46,6 +49,8 @@
 #define MOVE_COL                               1
 #define MSG_ROW                                9
 #define MSG_COL                                40
+#define INFO_ROW                               19
+#define INFO_COL                               1
 #define QUIT_ROW                               2
 #define QUIT_COL                               40
 #define QUIT_LEN                               4
@@ -289,6 +294,8 @@ void graphics_tb_draw_menu(void *context, menu_t *menu) {
 
 // graphics_tb_draw_game draws the whole screen.
 void graphics_tb_draw_game(void *context, game_state_to_draw_t *state) {
+    TRACE_FUNCTION();
+
     tb_clear();
     draw_board();
     draw_gui(state);
@@ -297,6 +304,7 @@ void graphics_tb_draw_game(void *context, game_state_to_draw_t *state) {
                             state->game->turn);
     draw_input(state);
     print_str(state->msg, MSG_COL, MSG_ROW);
+    print_str(state->info, INFO_COL, INFO_ROW);
     tb_present();
 }
 
@@ -318,103 +326,128 @@ static int get_label_clickable_length(menu_t *menu, int selected_menu_item) {
 
 
 void graphics_tb_wait_game_event(void *context, event_t *event) {
+    TRACE_FUNCTION();
+
     graphics_tb_wait_menu_event(context, event, NULL);
 }
 
 
-void graphics_tb_wait_menu_event(void *context, event_t *event, menu_t *menu) {
-    struct tb_event tevent;
-    int             stop = 0;
-
-    do {
-        tb_poll_event(&tevent);
-        switch (tevent.type) {
-        case TB_EVENT_KEY:
-            event->type = EVENT_KEY;
-            stop        = 1;
-            switch (tevent.key) {
-            case TB_KEY_ENTER:
-                event->key = KEY_ENTER;
-                break;
-
-            case TB_KEY_ESC:
-                event->type = EVENT_QUIT;
-                event->key  = KEY_ESC;
-                break;
+// convert_event sets `event` from the termbox event `tevent`.
+// Returns 1 if the event is one of the game or of the `menu`, 0 otherwise.
+static int convert_event(struct tb_event *tevent, event_t *event, menu_t *menu) {
+    int stop = 0;
 
-            case TB_KEY_ARROW_UP:
-                event->key = KEY_ARROW_UP;
-                break;
+    switch (tevent->type) {
+    case TB_EVENT_KEY:
+        event->type = EVENT_KEY;
+        stop        = 1;
+        switch (tevent->key) {
+        case TB_KEY_ENTER:
+            event->key = KEY_ENTER;
+            break;
 
-            case TB_KEY_ARROW_DOWN:
-                event->key = KEY_ARROW_DOWN;
-                break;
+        case TB_KEY_ESC:
+            event->type = EVENT_QUIT;
+            event->key  = KEY_ESC;
+            break;
 
-            case TB_KEY_ARROW_LEFT:
-                event->key = KEY_ARROW_LEFT;
-                break;
+        case TB_KEY_ARROW_UP:
+            event->key = KEY_ARROW_UP;
+            break;
 
-            case TB_KEY_ARROW_RIGHT:
-                event->key = KEY_ARROW_RIGHT;
-                break;
+        case TB_KEY_ARROW_DOWN:
+            event->key = KEY_ARROW_DOWN;
+            break;
 
-            case TB_KEY_BACKSPACE:
-            case TB_KEY_BACKSPACE2:
-                event->key = KEY_BACKSPACE;
-                break;
+        case TB_KEY_ARROW_LEFT:
+            event->key = KEY_ARROW_LEFT;
+            break;
 
-            default:
-                if (!tevent.key) {
-                    tb_utf8_unicode_to_char(&event->ch, tevent.ch);
-                    event->key = KEY_CH;
-                }
-            }
+        case TB_KEY_ARROW_RIGHT:
+            event->key = KEY_ARROW_RIGHT;
             break;
 
-        case TB_EVENT_RESIZE:
-            event->type = EVENT_REDRAW;
-            stop        = 1;
+        case TB_KEY_BACKSPACE:
+        case TB_KEY_BACKSPACE2:
+            event->key = KEY_BACKSPACE;
             break;
 
-        case TB_EVENT_MOUSE:
-            if (menu != NULL) {
-                int selected_menu_item;
-                selected_menu_item = tevent.y - MENU_ITEM_ROW;
-                if ((selected_menu_item < menu->num_items) &&
-                    (selected_menu_item >= 0) &&
-                    (tevent.x >= MENU_ITEM_COL) &&
-                    (tevent.x < MENU_ITEM_COL +
-                     get_label_clickable_length(menu, selected_menu_item)) &&
-                    (tevent.key == TB_KEY_MOUSE_LEFT)) {
-                    event->type      = EVENT_MENU_ITEM_CLICKED;
-                    event->menu_item = selected_menu_item;
-                    stop             = 1;
-                }
-            } else { // The user clicked on the board
-                if ((tevent.x <= SPACING_COL * 4 + PADDING_COL) &&
-                    (tevent.x >= PADDING_COL) &&
-                    (tevent.y <= SPACING_ROW * 4 + PADDING_ROW) &&
-                    (tevent.y >= PADDING_ROW) &&
-                    (tevent.key == TB_KEY_MOUSE_LEFT)) {
-                    int x0 = tevent.x - PADDING_COL;
-                    int y0 = tevent.y - PADDING_ROW;
-                    if (((x0 % SPACING_COL == 0)) && (y0 % SPACING_ROW == 0)) {
-                        // The user clicked on piece placement on the board
-                        event->type       = EVENT_POSITION;
-                        event->position.c = x0 / SPACING_COL;
-                        event->position.r = y0 / SPACING_ROW;
-                        stop = 1;
-                    }
-                } else if ((tevent.x >= QUIT_COL) &&
-                           (tevent.x < QUIT_COL + QUIT_LEN) &&
-                           (tevent.y == QUIT_ROW)) {
-                    event->type = EVENT_QUIT;
-                    stop        = 1;
+        default:
+            if (!tevent->key) {
+                tb_utf8_unicode_to_char(&event->ch, tevent->ch);
+                event->key = KEY_CH;
+            }
+        }
+        break;
+
+    case TB_EVENT_RESIZE:
+        event->type = EVENT_REDRAW;
+        stop        = 1;
+        break;
+
+    case TB_EVENT_MOUSE:
+        if (menu != NULL) {
+            int selected_menu_item;
+            selected_menu_item = tevent->y - MENU_ITEM_ROW;
+            if ((selected_menu_item < menu->num_items) &&
+                (selected_menu_item >= 0) &&
+                (tevent->x >= MENU_ITEM_COL) &&
+                (tevent->x < MENU_ITEM_COL +
+                 get_label_clickable_length(menu, selected_menu_item)) &&
+                (tevent->key == TB_KEY_MOUSE_LEFT)) {
+                event->type      = EVENT_MENU_ITEM_CLICKED;
+                event->menu_item = selected_menu_item;
+                stop             = 1;
+            }
+        } else { // The user clicked on the board
+            if ((tevent->x <= SPACING_COL * 4 + PADDING_COL) &&
+                (tevent->x >= PADDING_COL) &&
+                (tevent->y <= SPACING_ROW * 4 + PADDING_ROW) &&
+                (tevent->y >= PADDING_ROW) &&
+                (tevent->key == TB_KEY_MOUSE_LEFT)) {
+                int x0 = tevent->x - PADDING_COL;
+                int y0 = tevent->y - PADDING_ROW;
+                if (((x0 % SPACING_COL == 0)) && (y0 % SPACING_ROW == 0)) {
+                    // The user clicked on piece placement on the board
+                    event->type       = EVENT_POSITION;
+                    event->position.c = x0 / SPACING_COL;
+                    event->position.r = y0 / SPACING_ROW;
+                    stop = 1;
                 }
+            } else if ((tevent->x >= QUIT_COL) &&
+                       (tevent->x < QUIT_COL + QUIT_LEN) &&
+                       (tevent->y == QUIT_ROW)) {
+                event->type = EVENT_QUIT;
+                stop        = 1;
             }
-            break;
         }
-    } while (!stop);
+        break;
+    }
+
+    return stop;
+}
+
+
+void graphics_tb_wait_menu_event(void *context, event_t *event, menu_t *menu) {
+    struct tb_event tevent;
+
+    do {
+        tb_poll_event(&tevent);
+    } while (!convert_event(&tevent, event, menu));
+}
+
+
+bool graphics_tb_poll_game_event(void *context, event_t *event,
+                                 int timeout_ms) {
+    TRACE_FUNCTION();
+
+    struct tb_event tevent;
+
+    if (tb_peek_event(&tevent, timeout_ms) <= 0) {
+        return false;
+    }
+
+    return convert_event(&tevent, event, NULL);
 }
 
 
@@ -427,6 +460,7 @@ void graphics_tb_quit(graphics_tb_t *tg) {
 graphics_callbacks_t graphics_tb_callbacks = {
     .draw_game       = graphics_tb_draw_game,
     .wait_event_game = graphics_tb_wait_game_event,
+    .poll_event_game = graphics_tb_poll_game_event,
     .wait_event_menu = graphics_tb_wait_menu_event,
     .draw_menu       = graphics_tb_draw_menu
 };
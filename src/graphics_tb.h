@@ -25,6 +25,12 @@ void graphics_tb_wait_game_event(void *context, event_t *event);
 
 void graphics_tb_wait_menu_event(void *context, event_t *event, menu_t *menu);
 
+// graphics_tb_poll_game_event waits for an event at most `timeout_ms`
+// milliseconds. This function is used as a callback.
+// Returns false if no event happened.
+bool graphics_tb_poll_game_event(void *context, event_t *event,
+                                 int timeout_ms);
+
 // graphics_tb_quit terminates the graphic module.
 void graphics_tb_quit(graphics_tb_t *tg);
 
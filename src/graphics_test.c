@@ -70,6 +70,8 @@ bool test_graphics(void                 *context,
     state.input.to.r      = POSITION_NOT_SET;
     char msg[256] = "";
     state.msg = msg;
+    char info[] = "d6 +3.0 12.3k nodes 1.2M/s 1st cut 87% pv c3 b2-b3";
+    state.info = info;
 
     board_t board = { {
                           TIGER_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, TIGER_CELL,
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "alloc_stats.h"
+#include "game.h"
+#include "ai_rand.h"
+#include "ai_simple_heuristic.h"
+
+#define DEFAULT_NUM_GAMES    40
+
+// OPENING_PLIES random movements start each pair of games, so that the
+// deterministic AIs don't play the same game over and over.
+#define OPENING_PLIES        4
+
+// MAX_PLIES stops the games looping in the movement phase: they are drawn.
+#define MAX_PLIES            150
+
+// player_t is an AI of the arena and its results.
+typedef struct {
+    const char            *name;
+    ai_simple_heuristic_t *ai;
+    int                   num_wins;
+    int                   num_losses;
+    int                   num_draws;
+    int                   num_mvts;
+    uint64_t              num_nodes;
+    uint64_t              num_allocs; // Counted with make alloc_stats.
+    double                time;
+} player_t;
+
+// log_searches tells `play` to print the statistics of every search.
+static bool log_searches = false;
+
+static void usage(char *name) {
+    printf("Usage: %s [-n num games] [-d depth] [-D reference depth] "
+           "[-r reduction] [-m futility margin] [-L] [-F] [-l]\n", name);
+    printf("\n");
+    printf("Plays the simple heuristic AI with the selective search\n");
+    printf("against itself without it, each one playing tigers in half of\n");
+    printf("the games, and reports the results with the nodes searched.\n");
+    printf("Both play at the same depth unless -D is given.\n");
+    printf("With -l, the search of every movement is logged.\n");
+    printf("Built with make alloc_stats, the allocations are reported too.\n");
+    printf("\n");
+    printf("The selective search uses the default parameters, except:\n");
+    printf("  -r: movements late quiet movements are reduced by\n");
+    printf("  -m: futility margin per movement of depth\n");
+    printf("  -L: no late movement reductions\n");
+    printf("  -F: no futility pruning\n");
+}
+
+
+static double elapsed(struct timespec *begin) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
+
+// log_search prints the statistics of the last search of the player.
+static void log_search(player_t *player, int ply) {
+    ai_heuristic_stats_t *stats = &player->ai->stats;
+    char                 info[AI_INFO_LEN];
+
+    ai_heuristic_stats_format(stats, info, sizeof(info));
+    printf("ply %3d %-10s %s\n", ply, player->name, info);
+    if (stats->source != AI_HEURISTIC_SEARCH) {
+        return;
+    }
+
+    printf("        evals %llu, cutoffs %llu (%llu first), exact %llu/%llu, "
+           "ms per depth:",
+           (unsigned long long)stats->num_evals,
+           (unsigned long long)stats->num_cutoffs,
+           (unsigned long long)stats->num_first_cutoffs,
+           (unsigned long long)stats->num_exact_hits,
+           (unsigned long long)stats->num_exact_probes);
+    for (int d = 0; d < stats->depth && d < AI_HEURISTIC_MAX_PLY; d++) {
+        printf(" %.2f", stats->iteration_times[d] * 1e3);
+    }
+    printf("\n");
+}
+
+
+// play plays a game from the current position of `game`.
+// Returns the player who won, NULL if the game is drawn.
+static player_t *play(game_t *game, player_t *tiger, player_t *goat) {
+    for (int ply = 0; ply < MAX_PLIES; ply++) {
+        if (game_is_done(game)) {
+            // The player who has to play has lost.
+            return game->turn == TIGER_TURN ? goat : tiger;
+        }
+
+        player_t        *player    = game->turn == TIGER_TURN ? tiger : goat;
+        uint64_t        num_allocs = alloc_stats_num_allocs();
+        struct timespec begin;
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        mvt_t mvt = ai_simple_heuristic_get_mvt(player->ai, game);
+        player->time       += elapsed(&begin);
+        player->num_nodes  += player->ai->stats.num_nodes;
+        player->num_allocs += alloc_stats_num_allocs() - num_allocs;
+        player->num_mvts++;
+        if (log_searches) {
+            log_search(player, ply);
+        }
+
+        if (!game_do_mvt(game, mvt)) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void count_result(player_t *winner, player_t *a, player_t *b) {
+    if (winner == NULL) {
+        a->num_draws++;
+        b->num_draws++;
+    } else {
+        winner->num_wins++;
+        (winner == a ? b : a)->num_losses++;
+    }
+}
+
+
+static void print_player(player_t *player) {
+    int num_mvts = player->num_mvts > 0 ? player->num_mvts : 1;
+
+    printf("%-10s depth %2d: %3d wins %3d losses %3d draws, "
+           "%10.0f nodes/mvt %8.2f ms/mvt",
+           player->name, player->ai->depth, player->num_wins,
+           player->num_losses, player->num_draws,
+           (double)player->num_nodes / num_mvts, player->time * 1e3 / num_mvts);
+    if (alloc_stats_enabled()) {
+        printf(" %8.1f allocs/mvt", (double)player->num_allocs / num_mvts);
+    }
+    printf("\n");
+}
+
+
+int main(int argc, char **argv) {
+    char *name     = argv[0];
+    int  num_games = DEFAULT_NUM_GAMES;
+    int  ref_depth = -1;
+    int  opt;
+
+    ai_simple_heuristic_t *selective_ai = ai_simple_heuristic_new();
+    ai_simple_heuristic_t *full_ai      = ai_simple_heuristic_new();
+
+    if ((selective_ai == NULL) || (full_ai == NULL)) {
+        fprintf(stderr, "Cannot allocate the AIs.\n");
+        return 1;
+    }
+
+    while ((opt = getopt(argc, argv, "n:d:D:r:m:LFl")) != -1) {
+        switch (opt) {
+        case 'n':
+            num_games = atoi(optarg);
+            break;
+
+        case 'd':
+            selective_ai->depth = atoi(optarg);
+            break;
+
+        case 'D':
+            ref_depth = atoi(optarg);
+            break;
+
+        case 'r':
+            selective_ai->params.lmr_reduction = atoi(optarg);
+            break;
+
+        case 'm':
+            selective_ai->params.futility_margin = atof(optarg);
+            break;
+
+        case 'L':
+            selective_ai->params.lmr = false;
+            break;
+
+        case 'F':
+            selective_ai->params.futility = false;
+            break;
+
+        case 'l':
+            log_searches = true;
+            break;
+
+        default:
+            usage(name);
+            return 1;
+        }
+    }
+
+    full_ai->depth           = ref_depth > 0 ? ref_depth : selective_ai->depth;
+    full_ai->params.lmr      = false;
+    full_ai->params.futility = false;
+
+    if ((optind != argc) || (num_games <= 0) || (selective_ai->depth <= 0) ||
+        (selective_ai->params.lmr_reduction < 0)) {
+        usage(name);
+        return 1;
+    }
+
+    player_t selective = { .name = "selective", .ai = selective_ai };
+    player_t full      = { .name = "full", .ai = full_ai };
+    game_t   *game     = game_new();
+
+    for (int i = 0; i < num_games; i++) {
+        // Both games of a pair start from the same opening.
+        srand(i / 2);
+        game_reset(game);
+        for (int ply = 0; ply < OPENING_PLIES; ply++) {
+            game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+        }
+
+        if (log_searches) {
+            printf("game %d\n", i + 1);
+        }
+        if (i % 2 == 0) {
+            count_result(play(game, &selective, &full), &selective, &full);
+        } else {
+            count_result(play(game, &full, &selective), &selective, &full);
+        }
+    }
+
+    print_player(&selective);
+    print_player(&full);
+    printf("score %.1f%%, %.2fx the nodes, %.2fx the time\n",
+           100.0 * (selective.num_wins + 0.5 * selective.num_draws) / num_games,
+           (double)selective.num_nodes / (full.num_nodes ? full.num_nodes : 1),
+           selective.time / (full.time > 0 ? full.time : 1));
+    if (alloc_stats_enabled()) {
+        printf("\n");
+        alloc_stats_print(stdout, selective.num_mvts + full.num_mvts);
+    }
+
+    game_free(game);
+    ai_simple_heuristic_free(selective_ai);
+    ai_simple_heuristic_free(full_ai);
+    return 0;
+}
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ai_rand.h"
+#include "ai_simple_heuristic.h"
+#include "game.h"
+#include "matrix.h"
+#include "neuralnet.h"
+#include "notation.h"
+#include "perf_counters.h"
+#include "tools.h"
+
+#define DEFAULT_DEPTH             10
+#define DEFAULT_MAX_NODES         2000000
+
+// NUM_MVTGEN_CALLS is the number of times the movements of each position are
+// generated.
+#define NUM_MVTGEN_CALLS          200000
+
+// NUM_RAND_MVTS is the number of movements the random AI picks per position.
+#define NUM_RAND_MVTS             200000
+
+// NUM_FEEDFORWARDS is the number of positions the neural network evaluates.
+#define NUM_FEEDFORWARDS          20000
+
+#define SEED                      0x62656e63
+
+// COUNTERS_JSON_LEN is the size of the JSON field of the hardware counters.
+#define COUNTERS_JSON_LEN         256
+
+// bench_position_t is a position of the suite, in the `notation.h` format.
+typedef struct {
+    const char *name;
+    const char *position;
+} bench_position_t;
+
+// positions is the suite. It goes through the phases of the game: the
+// placement, the movements and the endings where the goats are close to
+// trapping the tigers. Changing it makes results incomparable.
+static const bench_position_t positions[] = {
+    { "opening",          "T...T/...../...../...../T...T g 20" },
+    { "early placement",  "G.T../G..../G.T../GT.../G.T.. g 14" },
+    { "captures",         "T..../T..../..G.T/.GG../T.... g 14" },
+    { "late placement",   "GGG.T/GG.../GGT../GG.T./GGT.. g 8"  },
+    { "last goats",       "GGGGT/GGGG./GGGGT/GGG../GG.TT g 2"  },
+    { "movement",         "GGGGT/.GGTG/GGGTG/GGG../GGG.T g 0"  },
+    { "movement tactics", "GGG.G/TGGTG/G.GG./GGGGT/TGG.. g 0"  },
+    { "near trap",        "GGGGT/GGGTG/GGG.G/GGG.T/GGGT. g 0"  }
+};
+
+// neuralnet_sizes are the layers of the network: one input per cell and token
+// kind.
+static int neuralnet_sizes[] = { 3 * 5 * 5, 128, 32, 1 };
+
+static void usage(char *name) {
+    printf("Usage: %s [-d depth] [-n max nodes] [-p]\n", name);
+    printf("\n");
+    printf("Runs the benchmark suite and writes its results in JSON:\n");
+    printf("for each position, the movements generated per second, the\n");
+    printf("speed of the random AI, and the nodes, nodes per second and\n");
+    printf("time to each depth of the simple heuristic AI searching up to\n");
+    printf("`depth` within `max nodes` (defaults: %d and %d). Then the\n",
+           DEFAULT_DEPTH, DEFAULT_MAX_NODES);
+    printf("feedforwards per second of a neural network.\n");
+    printf("\n");
+    printf("The work is the same from one run to another: the results of\n");
+    printf("two builds can be compared.\n");
+    printf("\n");
+    printf("With -p, the hardware counters of the CPU are read too: the\n");
+    printf("instructions per cycle and the cache and branch misses per call,\n");
+    printf("node or feedforward are added where they are available.\n");
+}
+
+
+static double elapsed(struct timespec *begin) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
+
+// start starts the hardware counters, if any.
+static void start(perf_counters_t *counters, perf_counts_t *counts) {
+    perf_counts_clear(counts);
+    if (counters != NULL) {
+        perf_counters_start(counters);
+    }
+}
+
+
+// stop stops the hardware counters, if any, and writes the counts per unit of
+// work to `str` as a JSON field (", \"counters\": {...}"), or an empty string
+// if none is available. `str` must hold COUNTERS_JSON_LEN chars.
+static void stop(perf_counters_t *counters, perf_counts_t *counts,
+                 uint64_t num_units, const char *unit, char *str) {
+    static const struct {
+        perf_counter_t counter;
+        const char     *name;
+    } misses[] = {
+        { PERF_L1D_MISSES,    "l1d_misses"    },
+        { PERF_LLC_MISSES,    "llc_misses"    },
+        { PERF_BRANCH_MISSES, "branch_misses" }
+    };
+    char fields[COUNTERS_JSON_LEN / 2];
+    int  len = 0;
+
+    str[0] = '\0';
+    if (counters == NULL) {
+        return;
+    }
+
+    perf_counters_stop(counters, counts);
+    if (perf_counts_ipc(counts) > 0) {
+        len += snprintf(fields, sizeof(fields), ", \"ipc\": %.3f",
+                        perf_counts_ipc(counts));
+    }
+    for (int i = 0; (i < ARRAY_LEN(misses)) && (num_units > 0); i++) {
+        if (counts->available[misses[i].counter]) {
+            len += snprintf(fields + len, sizeof(fields) - len, ", \"%s\": %.4f",
+                            misses[i].name,
+                            (double)counts->values[misses[i].counter] / num_units);
+        }
+    }
+
+    if (len > 0) {
+        snprintf(str, COUNTERS_JSON_LEN, ", \"counters\": { \"per\": \"%s\"%s }",
+                 unit, fields);
+    }
+}
+
+
+// bench_mvtgen prints the speed of `game_get_mvts` on the game.
+static void bench_mvtgen(game_t *game, perf_counters_t *counters) {
+    mvt_t           mvts[GAME_MAX_NUM_MVTS];
+    struct timespec begin;
+    perf_counts_t   counts;
+    char            counts_str[COUNTERS_JSON_LEN];
+    uint64_t        num_mvts = 0;
+
+    start(counters, &counts);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < NUM_MVTGEN_CALLS; i++) {
+        num_mvts += game_get_mvts(game, mvts);
+    }
+    double time = elapsed(&begin);
+    stop(counters, &counts, NUM_MVTGEN_CALLS, "call", counts_str);
+
+    printf("      \"mvtgen\": { \"calls\": %d, \"mvts\": %llu, "
+           "\"calls_per_sec\": %.0f, \"mvts_per_sec\": %.0f%s },\n",
+           NUM_MVTGEN_CALLS, (unsigned long long)num_mvts,
+           NUM_MVTGEN_CALLS / time, num_mvts / time, counts_str);
+}
+
+
+// bench_rand_ai prints the speed of the random AI on the game.
+static void bench_rand_ai(game_t *game) {
+    void                  *ai     = ai_rand_callbacks.new();
+    ai_get_mvt_callback_t get_mvt = game->turn == TIGER_TURN ?
+                                    ai_rand_callbacks.get_tiger_mvt :
+                                    ai_rand_callbacks.get_goat_mvt;
+    struct timespec       begin;
+
+    srand(SEED);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < NUM_RAND_MVTS; i++) {
+        get_mvt(ai, game);
+    }
+    double time = elapsed(&begin);
+
+    ai_rand_callbacks.free(ai);
+    printf("        \"rand\": { \"mvts\": %d, \"mvts_per_sec\": %.0f },\n",
+           NUM_RAND_MVTS, NUM_RAND_MVTS / time);
+}
+
+
+// bench_simple_heuristic_ai prints the statistics of the search of the simple
+// heuristic AI on the game.
+// Returns the number of nodes searched and adds the time to `time`.
+static uint64_t bench_simple_heuristic_ai(game_t *game, int depth,
+                                          uint64_t max_nodes,
+                                          perf_counters_t *counters,
+                                          double *time) {
+    ai_simple_heuristic_t *ai      = ai_simple_heuristic_callbacks.new();
+    ai_get_mvt_callback_t get_mvt  = game->turn == TIGER_TURN ?
+                                     ai_simple_heuristic_callbacks.get_tiger_mvt :
+                                     ai_simple_heuristic_callbacks.get_goat_mvt;
+    ai_heuristic_stats_t  *stats   = &ai->stats;
+    char                  mvt[NOTATION_MVT_LEN];
+    double                time_to_depth = 0;
+    perf_counts_t         counts;
+    char                  counts_str[COUNTERS_JSON_LEN];
+
+    ai->depth            = depth;
+    ai->params.max_nodes = max_nodes;
+    start(counters, &counts);
+    mvt_t best = get_mvt(ai, game);
+    stop(counters, &counts, stats->num_nodes, "node", counts_str);
+    notation_format_mvt(best, mvt);
+
+    printf("        \"simple_heuristic\": { \"mvt\": \"%s\", \"depth\": %d, "
+           "\"value\": %.2f, \"nodes\": %llu, \"evals\": %llu, "
+           "\"nps\": %.0f, \"time\": %.6f, \"time_to_depth\": [",
+           mvt, stats->depth, stats->value,
+           (unsigned long long)stats->num_nodes,
+           (unsigned long long)stats->num_evals,
+           ai_heuristic_stats_nps(stats), stats->time);
+    for (int d = 0; d < stats->depth && d < AI_HEURISTIC_MAX_PLY; d++) {
+        time_to_depth += stats->iteration_times[d];
+        printf("%s%.6f", d > 0 ? ", " : "", time_to_depth);
+    }
+    printf("]%s }\n", counts_str);
+
+    uint64_t num_nodes = stats->num_nodes;
+    *time += stats->time;
+    ai_simple_heuristic_callbacks.free(ai);
+    return num_nodes;
+}
+
+
+// encode sets `in` to the input of the neural network for the game: for each
+// cell, whether it is empty, holds a goat or a tiger.
+static void encode(game_t *game, matrix_t *in) {
+    matrix_set_size(in, 3 * 5 * 5, 1);
+    matrix_set_all_values(in, 0);
+    for (int cell = 0; cell < 5 * 5; cell++) {
+        matrix_set_value(in, cell * 3 + game->board.tab[cell], 0, 1);
+    }
+}
+
+
+// bench_neuralnet prints the speed of the feedforward of a neural network
+// evaluating the positions of the suite.
+static void bench_neuralnet(game_t **games, int num_games,
+                            perf_counters_t *counters) {
+    neuralnet_t     *net = make_neuralnet(ARRAY_LEN(neuralnet_sizes),
+                                          neuralnet_sizes);
+    matrix_t        *in  = make_matrix(0, 0, 0);
+    matrix_t        *out = make_matrix(0, 0, 0);
+    struct timespec begin;
+    perf_counts_t   counts;
+    char            counts_str[COUNTERS_JSON_LEN];
+    double          sum = 0;
+
+    srand(SEED);
+    neuralnet_randomize(net);
+
+    start(counters, &counts);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < NUM_FEEDFORWARDS; i++) {
+        encode(games[i % num_games], in);
+        neuralnet_feedforward(net, in, out);
+        sum += matrix_get_value(out, 0, 0);
+    }
+    double time = elapsed(&begin);
+    stop(counters, &counts, NUM_FEEDFORWARDS, "feedforward", counts_str);
+
+    printf("  \"neuralnet\": { \"sizes\": [");
+    for (int i = 0; i < ARRAY_LEN(neuralnet_sizes); i++) {
+        printf("%s%d", i > 0 ? ", " : "", neuralnet_sizes[i]);
+    }
+    printf("], \"feedforwards\": %d, \"feedforwards_per_sec\": %.0f, "
+           "\"mean_output\": %.6f%s },\n",
+           NUM_FEEDFORWARDS, NUM_FEEDFORWARDS / time, sum / NUM_FEEDFORWARDS,
+           counts_str);
+
+    free_matrix(in);
+    free_matrix(out);
+    free_neuralnet(net);
+}
+
+
+int main(int argc, char **argv) {
+    int      depth     = DEFAULT_DEPTH;
+    uint64_t max_nodes = DEFAULT_MAX_NODES;
+    int      opt;
+    game_t   *games[ARRAY_LEN(positions)];
+    uint64_t num_nodes = 0;
+    double   time      = 0;
+    bool     count     = false;
+
+    while ((opt = getopt(argc, argv, "d:n:p")) != -1) {
+        switch (opt) {
+        case 'd':
+            depth = atoi(optarg);
+            break;
+
+        case 'n':
+            max_nodes = strtoull(optarg, NULL, 10);
+            break;
+
+        case 'p':
+            count = true;
+            break;
+
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((optind != argc) || (depth <= 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (int i = 0; i < ARRAY_LEN(positions); i++) {
+        games[i] = game_new();
+        if ((games[i] == NULL) ||
+            (notation_parse_position(positions[i].position, games[i]) != 0)) {
+            fprintf(stderr, "Invalid position %s.\n", positions[i].name);
+            return 1;
+        }
+    }
+
+    // The counters are not read if none is available.
+    perf_counters_t counters;
+    if (count && (perf_counters_open(&counters) == 0)) {
+        fprintf(stderr, "Hardware counters unavailable.\n");
+        count = false;
+    }
+    perf_counters_t *c = count ? &counters : NULL;
+
+    printf("{\n");
+    printf("  \"depth\": %d,\n", depth);
+    printf("  \"max_nodes\": %llu,\n", (unsigned long long)max_nodes);
+    printf("  \"positions\": [\n");
+    for (int i = 0; i < ARRAY_LEN(positions); i++) {
+        printf("    {\n");
+        printf("      \"name\": \"%s\",\n", positions[i].name);
+        printf("      \"position\": \"%s\",\n", positions[i].position);
+        bench_mvtgen(games[i], c);
+        printf("      \"ai\": {\n");
+        bench_rand_ai(games[i]);
+        num_nodes += bench_simple_heuristic_ai(games[i], depth, max_nodes, c,
+                                               &time);
+        printf("      }\n");
+        printf("    }%s\n", i + 1 < ARRAY_LEN(positions) ? "," : "");
+    }
+    printf("  ],\n");
+
+    bench_neuralnet(games, ARRAY_LEN(positions), c);
+
+    printf("  \"search\": { \"nodes\": %llu, \"time\": %.6f, \"nps\": %.0f }\n",
+           (unsigned long long)num_nodes, time, time > 0 ? num_nodes / time : 0);
+    printf("}\n");
+
+    for (int i = 0; i < ARRAY_LEN(positions); i++) {
+        game_free(games[i]);
+    }
+    if (count) {
+        perf_counters_close(&counters);
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ai_simple_heuristic.h"
+#include "game.h"
+#include "opening_book.h"
+#include "zobrist.h"
+
+#define DEFAULT_NUM_PLIES    4
+#define DEFAULT_DEPTH        10
+
+// visited_set_t is an open addressing hash set of canonical position hashes.
+// It is used so that each position is only searched once, whatever the
+// movements (or the symmetry) that led to it.
+typedef struct {
+    uint64_t *keys;
+    size_t   capacity;
+    size_t   num_keys;
+} visited_set_t;
+
+typedef struct {
+    visited_set_t        visited;
+    opening_book_entry_t *entries;
+    size_t               num_entries;
+    size_t               capacity;
+    int                  num_plies;
+    int                  depth;
+} builder_t;
+
+
+static bool visited_set_grow(visited_set_t *set);
+
+
+// visited_set_add adds the key to the set.
+// Returns 1 if the key was not in the set yet, 0 if it was, -1 on allocation
+// failure.
+static int visited_set_add(visited_set_t *set, uint64_t key) {
+    // 0 marks an empty slot. Positions with a null hash are never searched.
+    if (key == 0) {
+        return 0;
+    }
+
+    if ((set->num_keys + 1) * 2 > set->capacity) {
+        if (!visited_set_grow(set)) {
+            return -1;
+        }
+    }
+
+    size_t i = key & (set->capacity - 1);
+    while (set->keys[i] != 0) {
+        if (set->keys[i] == key) {
+            return 0;
+        }
+        i = (i + 1) & (set->capacity - 1);
+    }
+
+    set->keys[i] = key;
+    set->num_keys++;
+    return 1;
+}
+
+
+static bool visited_set_grow(visited_set_t *set) {
+    visited_set_t bigger = {
+        .capacity = set->capacity ? set->capacity * 2 : 1024,
+        .num_keys =                                    0
+    };
+
+    bigger.keys = calloc(bigger.capacity, sizeof(uint64_t));
+    if (bigger.keys == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < set->capacity; i++) {
+        if (set->keys[i] != 0) {
+            visited_set_add(&bigger, set->keys[i]);
+        }
+    }
+
+    free(set->keys);
+    *set = bigger;
+    return true;
+}
+
+
+static int builder_add_entry(builder_t *builder, opening_book_entry_t entry) {
+    if (builder->num_entries == builder->capacity) {
+        size_t               capacity = builder->capacity ? builder->capacity * 2 : 256;
+        opening_book_entry_t *entries = realloc(builder->entries,
+                                                capacity * sizeof(opening_book_entry_t));
+        if (entries == NULL) {
+            return 1;
+        }
+        builder->entries  = entries;
+        builder->capacity = capacity;
+    }
+
+    builder->entries[builder->num_entries++] = entry;
+    return 0;
+}
+
+
+// builder_explore searches the best movement of the current position and then
+// explores every movement while the game is still in the placement phase.
+// Returns 0 on success, 1 on allocation failure.
+static int builder_explore(builder_t *builder, game_t *game, int ply) {
+    if (game_is_done(game) || (game->num_goats_to_put == 0)) {
+        return 0;
+    }
+
+    int added = visited_set_add(&builder->visited,
+                                zobrist_canonical_hash(game, NULL));
+    if (added <= 0) {
+        return added < 0;
+    }
+
+    double value;
+    mvt_t  best = ai_simple_heuristic_search(game, builder->depth, &value);
+
+    if (builder_add_entry(builder,
+                          opening_book_make_entry(game, best, builder->depth,
+                                                  value))) {
+        return 1;
+    }
+
+    if (builder->num_entries % 100 == 0) {
+        fprintf(stderr, "%zu positions searched\n", builder->num_entries);
+    }
+
+    if (ply + 1 >= builder->num_plies) {
+        return 0;
+    }
+
+    possible_positions_t possible_from;
+    possible_positions_t possible_to;
+    mvt_t                mvt;
+
+    game_get_possible_from_positions(game, &possible_from);
+    for (mvt.from.r = 0; mvt.from.r < 5; mvt.from.r++) {
+        for (mvt.from.c = 0; mvt.from.c < 5; mvt.from.c++) {
+            if (!is_position_possible(&possible_from, mvt.from)) {
+                continue;
+            }
+
+            if (game->turn == GOAT_TURN) {
+                mvt.to = (position_t){
+                    POSITION_NOT_SET, POSITION_NOT_SET
+                };
+                int eaten_goat = game_apply_legal_mvt(game, mvt);
+                int err        = builder_explore(builder, game, ply + 1);
+                game_unapply_legal_mvt(game, mvt, eaten_goat);
+                if (err) {
+                    return err;
+                }
+                continue;
+            }
+
+            game_get_possible_to_positions(game, mvt.from, &possible_to);
+            for (mvt.to.r = 0; mvt.to.r < 5; mvt.to.r++) {
+                for (mvt.to.c = 0; mvt.to.c < 5; mvt.to.c++) {
+                    if (is_position_possible(&possible_to, mvt.to)) {
+                        int eaten_goat = game_apply_legal_mvt(game, mvt);
+                        int err        = builder_explore(builder, game,
+                                                         ply + 1);
+                        game_unapply_legal_mvt(game, mvt, eaten_goat);
+                        if (err) {
+                            return err;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+static void usage(char *name) {
+    printf("Usage: %s <book file> [num plies] [depth]\n", name);
+    printf("\n");
+    printf("Builds an opening book by searching every placement position\n");
+    printf("reachable in `num plies` movements (default: %d) with a search\n",
+           DEFAULT_NUM_PLIES);
+    printf("`depth` movements deep (default: %d).\n", DEFAULT_DEPTH);
+}
+
+
+int main(int argc, char **argv) {
+    if ((argc < 2) || (argc > 4)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    builder_t builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.num_plies = argc > 2 ? atoi(argv[2]) : DEFAULT_NUM_PLIES;
+    builder.depth     = argc > 3 ? atoi(argv[3]) : DEFAULT_DEPTH;
+
+    if ((builder.num_plies <= 0) || (builder.depth <= 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    game_t *game = game_new();
+    if (game == NULL) {
+        fprintf(stderr, "Cannot create the game.\n");
+        return 1;
+    }
+
+    clock_t begin = clock();
+    int     err   = builder_explore(&builder, game, 0);
+    game_free(game);
+
+    if (err) {
+        fprintf(stderr, "Not enough memory.\n");
+        return 1;
+    }
+
+    if (opening_book_write(argv[1], builder.entries, builder.num_entries)) {
+        fprintf(stderr, "Cannot write %s.\n", argv[1]);
+        return 1;
+    }
+
+    printf("%zu positions written to %s in %.1fs.\n", builder.num_entries,
+           argv[1], (double)(clock() - begin) / CLOCKS_PER_SEC);
+
+    free(builder.entries);
+    free(builder.visited.keys);
+    return 0;
+}
@@ -0,0 +1,489 @@
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ai_rand.h"
+#include "ai_simple_heuristic.h"
+#include "ai_worker.h"
+#include "game.h"
+#include "notation.h"
+
+#define ENGINE_NAME       "bagh-chal"
+#define START_POSITION    "T...T/...../...../...../T...T g 20"
+
+// LINE_LEN is the size of the longest command read, a position and its
+// movements.
+#define LINE_LEN          4096
+
+// POLL_MS is how often the search is checked on while no command comes.
+#define POLL_MS           5
+
+// limits_t are the limits of a `go` command. 0 means no limit.
+typedef struct {
+    int      depth;
+    uint64_t nodes;
+    int      movetime; // Milliseconds.
+    bool     infinite; // Search until `stop`.
+} limits_t;
+
+// engine_ai_t is an AI the engine can play with.
+typedef struct {
+    const char     *name;
+    ai_callbacks_t *callbacks;
+
+    // set_limits applies the limits to the context of the AI before a
+    // search. NULL if the AI has no limits.
+    void           (*set_limits)(void *context, const limits_t *limits);
+
+    // set_info makes the AI print `info` lines during its searches. NULL if
+    // the AI only describes its search once done (see `ai_callbacks_t`).
+    void           (*set_info)(void *context);
+} engine_ai_t;
+
+static void simple_heuristic_set_limits(void *context, const limits_t *limits);
+static void simple_heuristic_set_info(void *context);
+
+static const engine_ai_t ais[] = {
+    { "simple_heuristic", &ai_simple_heuristic_callbacks,
+      simple_heuristic_set_limits, simple_heuristic_set_info },
+    { "rand",             &ai_rand_callbacks, NULL, NULL }
+};
+
+#define NUM_AIS           ((int)(sizeof(ais) / sizeof(ais[0])))
+
+// engine_t is the state of the engine between two commands.
+typedef struct {
+    game_t            *game;
+    const engine_ai_t *ai;
+    void              *ai_context;
+    ai_worker_t       *worker;
+    struct timespec   search_begin;
+    int               movetime; // Of the running search, 0 if none.
+    bool              infinite; // The running search waits for `stop`.
+    char              input[LINE_LEN]; // Read and not run yet.
+    size_t            input_len;
+    bool              quit;
+} engine_t;
+
+// output_mutex keeps the lines the search thread prints whole.
+static pthread_mutex_t output_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void usage(char *name) {
+    printf("Usage: %s\n", name);
+    printf("\n");
+    printf("Plays Bagh-Chal through a line protocol on the standard input\n");
+    printf("and output, for scripts and graphical interfaces:\n");
+    printf("\n");
+    printf("  protocol                 engine and AIs, then `ok`\n");
+    printf("  isready                  `readyok` once the commands are read\n");
+    printf("  ai <name>                AI searching the movements\n");
+    printf("  position startpos|<position> [moves <mvt>...]\n");
+    printf("  go [depth N] [nodes N] [movetime MS] [infinite]\n");
+    printf("  stop                     `bestmove`, then returns\n");
+    printf("  print                    current position\n");
+    printf("  quit\n");
+    printf("\n");
+    printf("Positions and movements are written as in src/notation.h.\n");
+    printf("A search prints `info` lines, then `bestmove <mvt>`. The other\n");
+    printf("commands wait for it to end; they stop an infinite search.\n");
+}
+
+
+// say prints a line of the protocol.
+static void say(const char *format, ...) {
+    va_list args;
+
+    va_start(args, format);
+    pthread_mutex_lock(&output_mutex);
+    vprintf(format, args);
+    printf("\n");
+    fflush(stdout);
+    pthread_mutex_unlock(&output_mutex);
+    va_end(args);
+}
+
+
+static double elapsed(struct timespec *begin) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
+
+// simple_heuristic_info prints the statistics of an iteration of the search.
+// It is called from the thread of the worker.
+static void simple_heuristic_info(void                       *context,
+                                  const ai_heuristic_stats_t *stats) {
+    char line[AI_INFO_LEN];
+    int  len = snprintf(line, sizeof(line),
+                        "info depth %d score %.2f nodes %llu nps %.0f "
+                        "time %.0f pv", stats->depth, stats->value,
+                        (unsigned long long)stats->num_nodes,
+                        ai_heuristic_stats_nps(stats), stats->time * 1e3);
+
+    for (int i = 0; (i < stats->pv_len) && (len < (int)sizeof(line)); i++) {
+        char mvt[NOTATION_MVT_LEN];
+
+        notation_format_mvt(stats->pv[i], mvt);
+        len += snprintf(line + len, sizeof(line) - len, " %s", mvt);
+    }
+
+    say("%s", line);
+}
+
+
+static void simple_heuristic_set_limits(void *context, const limits_t *limits) {
+    ai_simple_heuristic_t *ai = context;
+
+    // Without a depth, bounded or infinite searches go as deep as a
+    // principal variation is kept; others use the depth of the AI.
+    if (limits->depth > 0) {
+        ai->depth = limits->depth;
+    } else if ((limits->nodes > 0) || (limits->movetime > 0) ||
+               limits->infinite) {
+        ai->depth = AI_HEURISTIC_MAX_PLY;
+    } else {
+        ai->depth = AI_SIMPLE_HEURISTIC_DEPTH;
+    }
+    ai->params.max_nodes = limits->nodes;
+}
+
+
+static void simple_heuristic_set_info(void *context) {
+    ai_simple_heuristic_t *ai = context;
+
+    ai->params.info         = simple_heuristic_info;
+    ai->params.info_context = ai;
+}
+
+
+// set_ai replaces the AI of the engine by `ai`.
+// Returns 0 on success.
+static int set_ai(engine_t *engine, const engine_ai_t *ai) {
+    void *context = ai->callbacks->new();
+
+    if (context == NULL) {
+        return 1;
+    }
+
+    if (engine->ai != NULL) {
+        engine->ai->callbacks->free(engine->ai_context);
+    }
+    if (ai->set_info != NULL) {
+        ai->set_info(context);
+    }
+    engine->ai         = ai;
+    engine->ai_context = context;
+    return 0;
+}
+
+
+// print_best prints the last statistics and the movement of the search once
+// it is done.
+static void print_best(engine_t *engine) {
+    mvt_t mvt;
+    char  str[NOTATION_MVT_LEN];
+
+    if (!ai_worker_poll(engine->worker, &mvt)) {
+        return;
+    }
+
+    if (ai_worker_info(engine->worker)[0] != '\0') {
+        say("info string %s", ai_worker_info(engine->worker));
+    }
+    notation_format_mvt(mvt, str);
+    say("bestmove %s", str);
+}
+
+
+// check_search stops the search at the end of its time, and prints its
+// movement once done.
+static void check_search(engine_t *engine) {
+    if ((engine->movetime > 0) &&
+        (elapsed(&engine->search_begin) * 1e3 >= engine->movetime)) {
+        ai_worker_stop(engine->worker);
+    }
+
+    print_best(engine);
+}
+
+
+// wait_search waits for the running search, if any, to print its movement.
+static void wait_search(engine_t *engine) {
+    while (ai_worker_is_running(engine->worker)) {
+        check_search(engine);
+        usleep(POLL_MS * 1000);
+    }
+}
+
+
+// next_word returns the next word of the line, NULL at its end.
+static char *next_word(char **line) {
+    return strtok_r(NULL, " \t\r\n", line);
+}
+
+
+static void cmd_protocol(engine_t *engine, char **line) {
+    say("id name " ENGINE_NAME);
+    for (int i = 0; i < NUM_AIS; i++) {
+        say("ai %s%s", ais[i].name, &ais[i] == engine->ai ? " current" : "");
+    }
+    say("ok");
+}
+
+
+static void cmd_ai(engine_t *engine, char **line) {
+    char *name = next_word(line);
+
+    for (int i = 0; (name != NULL) && (i < NUM_AIS); i++) {
+        if (strcmp(name, ais[i].name) == 0) {
+            if (set_ai(engine, &ais[i]) != 0) {
+                say("error cannot create ai %s", name);
+            }
+            return;
+        }
+    }
+
+    say("error unknown ai %s", name != NULL ? name : "");
+}
+
+
+static void cmd_position(engine_t *engine, char **line) {
+    char position[LINE_LEN] = START_POSITION;
+    char *word              = next_word(line);
+
+    // A position is three words: rows, player and goats to put.
+    if ((word != NULL) && (strcmp(word, "startpos") != 0)) {
+        char *turn  = next_word(line);
+        char *goats = next_word(line);
+
+        snprintf(position, sizeof(position), "%s %s %s", word,
+                 turn != NULL ? turn : "", goats != NULL ? goats : "");
+    }
+
+    if (notation_parse_position(position, engine->game) != 0) {
+        say("error invalid position %s", position);
+        notation_parse_position(START_POSITION, engine->game);
+        return;
+    }
+
+    word = next_word(line);
+    if ((word == NULL) || (strcmp(word, "moves") != 0)) {
+        return;
+    }
+
+    while ((word = next_word(line)) != NULL) {
+        mvt_t mvt;
+
+        if ((notation_parse_mvt(word, &mvt) != 0) ||
+            !game_do_mvt(engine->game, mvt)) {
+            say("error illegal movement %s", word);
+            return;
+        }
+    }
+}
+
+
+static void cmd_go(engine_t *engine, char **line) {
+    limits_t limits = { 0 };
+    char     *word;
+
+    while ((word = next_word(line)) != NULL) {
+        char *value = NULL;
+
+        if (strcmp(word, "infinite") == 0) {
+            limits.infinite = true;
+            continue;
+        }
+        if ((value = next_word(line)) == NULL) {
+            break;
+        }
+
+        if (strcmp(word, "depth") == 0) {
+            limits.depth = atoi(value);
+        } else if (strcmp(word, "nodes") == 0) {
+            limits.nodes = strtoull(value, NULL, 10);
+        } else if (strcmp(word, "movetime") == 0) {
+            limits.movetime = atoi(value);
+        }
+    }
+
+    if (game_is_done(engine->game)) {
+        say("bestmove none");
+        return;
+    }
+
+    if (engine->ai->set_limits != NULL) {
+        engine->ai->set_limits(engine->ai_context, &limits);
+    }
+    if (ai_worker_start(engine->worker, engine->ai->callbacks,
+                        engine->ai_context, engine->game) != 0) {
+        say("error cannot start the search");
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &engine->search_begin);
+    engine->movetime = limits.infinite ? 0 : limits.movetime;
+    engine->infinite = limits.infinite;
+}
+
+
+static void cmd_stop(engine_t *engine, char **line) {
+    ai_worker_stop(engine->worker);
+    wait_search(engine);
+}
+
+
+static void cmd_isready(engine_t *engine, char **line) {
+    say("readyok");
+}
+
+
+static void cmd_print(engine_t *engine, char **line) {
+    char position[NOTATION_POSITION_LEN];
+
+    notation_format_position(engine->game, position);
+    say("position %s", position);
+}
+
+
+static void cmd_quit(engine_t *engine, char **line) {
+    engine->quit = true;
+}
+
+
+// command_t is a command of the protocol. `line` is the rest of the line, read
+// with `next_word`.
+typedef struct {
+    const char *name;
+    void       (*run)(engine_t *engine, char **line);
+    bool       while_searching; // Can be run during a search.
+} command_t;
+
+static const command_t commands[] = {
+    { "protocol", cmd_protocol, true  },
+    { "ai",       cmd_ai,       false },
+    { "position", cmd_position, false },
+    { "go",       cmd_go,       false },
+    { "stop",     cmd_stop,     true  },
+    { "isready",  cmd_isready,  true  },
+    { "print",    cmd_print,    true  },
+    { "quit",     cmd_quit,     true  }
+};
+
+// run_command runs the command of the line.
+static void run_command(engine_t *engine, char *line) {
+    char *rest;
+    char *name = strtok_r(line, " \t\r\n", &rest);
+
+    if (name == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strcmp(name, commands[i].name) != 0) {
+            continue;
+        }
+
+        // The game and the context of the AI belong to the search until
+        // its movement is printed. No input is read meanwhile: nothing else
+        // would end an infinite search.
+        print_best(engine);
+        if (!commands[i].while_searching &&
+            ai_worker_is_running(engine->worker)) {
+            if (engine->infinite) {
+                ai_worker_stop(engine->worker);
+            }
+            wait_search(engine);
+        }
+        commands[i].run(engine, &rest);
+        return;
+    }
+
+    say("error unknown command %s", name);
+}
+
+
+// read_line sets `line`, which holds LINE_LEN characters, to the next line of
+// the standard input. The search is checked on while waiting: stdin is read
+// without stdio, which would hide the lines it buffered from `poll`.
+// Returns false at the end of the input.
+static bool read_line(engine_t *engine, char *line) {
+    struct pollfd fd = { .fd = STDIN_FILENO, .events = POLLIN };
+
+    for (;;) {
+        char *end = memchr(engine->input, '\n', engine->input_len);
+
+        // Longer lines are cut.
+        if ((end == NULL) && (engine->input_len == LINE_LEN - 1)) {
+            end = &engine->input[LINE_LEN - 2];
+        }
+        if (end != NULL) {
+            size_t len = end - engine->input + 1;
+
+            memcpy(line, engine->input, len);
+            line[len] = '\0';
+            engine->input_len -= len;
+            memmove(engine->input, end + 1, engine->input_len);
+            return true;
+        }
+
+        if (ai_worker_is_running(engine->worker)) {
+            check_search(engine);
+            if (poll(&fd, 1, POLL_MS) <= 0) {
+                continue;
+            }
+        }
+
+        ssize_t n = read(STDIN_FILENO, engine->input + engine->input_len,
+                         LINE_LEN - 1 - engine->input_len);
+        if (n <= 0) {
+            // The last line may have no end of line.
+            memcpy(line, engine->input, engine->input_len);
+            line[engine->input_len] = '\0';
+            engine->input_len = 0;
+            return line[0] != '\0';
+        }
+        engine->input_len += n;
+    }
+}
+
+
+int main(int argc, char **argv) {
+    engine_t engine = { 0 };
+    char     line[LINE_LEN];
+
+    if (argc > 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    engine.game   = game_new();
+    engine.worker = ai_worker_new();
+    if ((engine.game == NULL) || (engine.worker == NULL) ||
+        (notation_parse_position(START_POSITION, engine.game) != 0) ||
+        (set_ai(&engine, &ais[0]) != 0)) {
+        fprintf(stderr, "Failed to create the engine.\n");
+        return 1;
+    }
+
+    while (!engine.quit && read_line(&engine, line)) {
+        run_command(&engine, line);
+        print_best(&engine);
+    }
+
+    // The search is answered before quitting, as after `stop`.
+    ai_worker_stop(engine.worker);
+    wait_search(&engine);
+
+    ai_worker_free(engine.worker);
+    engine.ai->callbacks->free(engine.ai_context);
+    game_free(engine.game);
+    return 0;
+}
@@ -3,6 +3,9 @@
 #include "graphics.h"
 #include "graphics_minimalist_sdl.h"
 #include "ui_main.h"
+#include "opening_book.h"
+#include "pn_search.h"
+#include "tablebase.h"
 
 
 int main(int argc, char **argv) {
@@ -20,8 +23,23 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    // The book is optional: without it, the AIs just search every movement.
+    opening_book_t *book = opening_book_open(DEFAULT_OPENING_BOOK_FILENAME);
+    opening_book_set_default(book);
+
+    // Same for the tablebase of the movement phase.
+    tablebase_t *tb = tablebase_open(DEFAULT_TABLEBASE_DIRECTORY);
+    tablebase_set_default(tb);
+
+    // The AIs look for forced wins with the proof-number solver.
+    pn_solver_t *solver = pn_solver_new(PN_DEFAULT_TABLE_SIZE);
+    pn_set_default(solver);
+
     ui_main(sg, graphics_minimalist_sdl_callbacks);
 
     graphics_minimalist_sdl_quit(sg);
+    opening_book_close(book);
+    tablebase_close(tb);
+    pn_solver_free(solver);
     return 0;
 }
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "notation.h"
+
+#define START_POSITION    "T...T/...../...../...../T...T g 20"
+
+static void usage(char *name) {
+    printf("Usage: %s [-D] depth [position]\n", name);
+    printf("\n");
+    printf("Counts the games reached after `depth` movements from the\n");
+    printf("position (default: the start of the game, \"%s\"),\n",
+           START_POSITION);
+    printf("and the number of games per second. Done games are not played\n");
+    printf("further.\n");
+    printf("\n");
+    printf("With -D (divide), the count is also given for each movement of\n");
+    printf("the position, to find which one a wrong count comes from.\n");
+}
+
+
+static double elapsed(struct timespec *begin) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
+
+// divide prints the number of games reached after each movement of the game.
+// Returns the total.
+static uint64_t divide(game_t *game, int depth) {
+    mvt_t    mvts[GAME_MAX_NUM_MVTS];
+    char     str[NOTATION_MVT_LEN];
+    uint64_t num_games = 0;
+    int      num_mvts  = game_is_done(game) ? 0 : game_get_mvts(game, mvts);
+
+    for (int i = 0; i < num_mvts; i++) {
+        int      eaten_goat = game_apply_legal_mvt(game, mvts[i]);
+        uint64_t n          = game_perft(game, depth - 1);
+        game_unapply_legal_mvt(game, mvts[i], eaten_goat);
+
+        notation_format_mvt(mvts[i], str);
+        printf("%-6s %llu\n", str, (unsigned long long)n);
+        num_games += n;
+    }
+    printf("\n");
+
+    return num_games;
+}
+
+
+int main(int argc, char **argv) {
+    bool            divide_mode = false;
+    char            *position   = START_POSITION;
+    int             opt;
+    struct timespec begin;
+    uint64_t        num_games;
+
+    while ((opt = getopt(argc, argv, "D")) != -1) {
+        switch (opt) {
+        case 'D':
+            divide_mode = true;
+            break;
+
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((optind == argc) || (argc - optind > 2)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int depth = atoi(argv[optind]);
+    if (argc - optind == 2) {
+        position = argv[optind + 1];
+    }
+
+    game_t *game = game_new();
+    if (game == NULL) {
+        return 1;
+    }
+    if ((depth <= 0) || (notation_parse_position(position, game) != 0)) {
+        usage(argv[0]);
+        game_free(game);
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    num_games = divide_mode ? divide(game, depth) : game_perft(game, depth);
+    double time = elapsed(&begin);
+
+    printf("depth %d: %llu games in %.3f s, %.0f games/s\n", depth,
+           (unsigned long long)num_games, time, time > 0 ? num_games / time : 0);
+
+    game_free(game);
+    return 0;
+}
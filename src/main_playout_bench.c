@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "game.h"
+#include "game_state.h"
+
+#define DEFAULT_NUM_PLAYOUTS    100000
+
+// MAX_PLIES stops the playouts looping in the movement phase.
+#define MAX_PLIES               200
+
+#define SEED                    0x706c61796f7574ULL
+
+static void usage(char *name) {
+    printf("Usage: %s [num playouts]\n", name);
+    printf("\n");
+    printf("Plays random games from the initial position and reports the\n");
+    printf("playouts per second when movements are done and undone on a\n");
+    printf("game (do/undo), when they are applied without checks\n");
+    printf("(apply/unapply) and when the state is copied (copy-make).\n");
+    printf("Both play the same games.\n");
+}
+
+
+static double elapsed(struct timespec *begin) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
+
+// playout_do_undo is `game_state_playout` on a game: the movements are undone
+// afterwards, as a search does.
+static bool playout_do_undo(game_t *game, uint64_t *seed) {
+    int  ply = 0;
+    bool done;
+
+    for (; ply < MAX_PLIES; ply++) {
+        mvt_t mvts[GAME_MAX_NUM_MVTS];
+
+        if (game_is_done(game)) {
+            break;
+        }
+
+        int num_mvts = game_get_mvts(game, mvts);
+        if (num_mvts == 0) {
+            break;
+        }
+
+        game_do_mvt(game, mvts[game_state_random(seed) % num_mvts]);
+    }
+
+    done = ply < MAX_PLIES || game_is_done(game);
+    for (; ply > 0; ply--) {
+        game_undo(game);
+    }
+
+    return done;
+}
+
+
+// playout_apply is `playout_do_undo` with `game_apply_legal_mvt`.
+static bool playout_apply(game_t *game, uint64_t *seed) {
+    mvt_t mvts[MAX_PLIES];
+    int   eaten_goats[MAX_PLIES];
+    int   ply = 0;
+    bool  done;
+
+    for (; ply < MAX_PLIES; ply++) {
+        mvt_t possible_mvts[GAME_MAX_NUM_MVTS];
+
+        if (game_is_done(game)) {
+            break;
+        }
+
+        int num_mvts = game_get_mvts(game, possible_mvts);
+        if (num_mvts == 0) {
+            break;
+        }
+
+        mvts[ply]        = possible_mvts[game_state_random(seed) % num_mvts];
+        eaten_goats[ply] = game_apply_legal_mvt(game, mvts[ply]);
+    }
+
+    done = ply < MAX_PLIES || game_is_done(game);
+    while (ply-- > 0) {
+        game_unapply_legal_mvt(game, mvts[ply], eaten_goats[ply]);
+    }
+
+    return done;
+}
+
+
+int main(int argc, char **argv) {
+    int num_playouts = DEFAULT_NUM_PLAYOUTS;
+
+    if (argc > 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (argc > 1) {
+        num_playouts = atoi(argv[1]);
+        if (num_playouts <= 0) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    game_t          *game = game_new();
+    game_state_t    root;
+    struct timespec begin;
+    uint64_t        seed;
+    int             num_done;
+
+    if (game == NULL) {
+        fprintf(stderr, "Cannot allocate the game.\n");
+        return 1;
+    }
+    game_state_from_game(game, &root);
+
+    seed     = SEED;
+    num_done = 0;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < num_playouts; i++) {
+        num_done += playout_do_undo(game, &seed);
+    }
+    double do_undo_time = elapsed(&begin);
+    int    do_undo_done = num_done;
+
+    seed     = SEED;
+    num_done = 0;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < num_playouts; i++) {
+        num_done += playout_apply(game, &seed);
+    }
+    double apply_time = elapsed(&begin);
+    int    apply_done = num_done;
+
+    seed     = SEED;
+    num_done = 0;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < num_playouts; i++) {
+        game_state_t state = root;
+
+        num_done += game_state_playout(&state, MAX_PLIES, &seed);
+    }
+    double copy_make_time = elapsed(&begin);
+
+    printf("%d playouts, %d finished\n", num_playouts, num_done);
+    printf("do/undo:       %.0f playouts/s\n", num_playouts / do_undo_time);
+    printf("apply/unapply: %.0f playouts/s (x%.1f)\n",
+           num_playouts / apply_time, do_undo_time / apply_time);
+    printf("copy-make:     %.0f playouts/s (x%.1f)\n",
+           num_playouts / copy_make_time, do_undo_time / copy_make_time);
+
+    game_free(game);
+
+    if ((do_undo_done != num_done) || (apply_done != num_done)) {
+        fprintf(stderr, "The strategies played different games.\n");
+        return 1;
+    }
+
+    return 0;
+}
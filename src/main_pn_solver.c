@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game.h"
+#include "notation.h"
+#include "pn_search.h"
+#include "tablebase.h"
+
+#define DEFAULT_MAX_NODES    1000000
+#define DEFAULT_TABLE_MB     64
+
+static void usage(char *name) {
+    printf("Usage: %s [max nodes] [table MB]\n", name);
+    printf("\n");
+    printf("Reads positions from the standard input, one per line, and tells\n");
+    printf("which player can force a win. Lines beginning with '#' are\n");
+    printf("ignored. A position is written as:\n");
+    printf("\n");
+    printf("    T...T/...../...../...../T...T g 20\n");
+    printf("\n");
+    printf("The default tablebase is probed if it is found.\n");
+    printf("By default, %d positions are searched with a %dMB table.\n",
+           DEFAULT_MAX_NODES, DEFAULT_TABLE_MB);
+}
+
+
+static double elapsed(struct timespec *begin) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
+
+// solve prints the result of the position and its solution line.
+static void solve(pn_solver_t *solver, game_t *game, uint64_t max_nodes) {
+    static const char *results[] = {
+        [PN_UNPROVEN]   = "unproven",
+        [PN_TIGERS_WIN] = "tigers win",
+        [PN_GOATS_WIN]  = "goats win",
+    };
+    struct timespec    begin;
+    pn_stats_t         stats;
+    mvt_t              line[PN_MAX_LINE_LEN];
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    pn_result_t result = pn_solve(solver, game, max_nodes, &stats);
+    double      time   = elapsed(&begin);
+
+    printf("%s", results[result]);
+
+    int len = pn_solution_line(solver, game, line, PN_MAX_LINE_LEN);
+    for (int i = 0; i < len; i++) {
+        char str[NOTATION_MVT_LEN];
+
+        notation_format_mvt(line[i], str);
+        printf(" %s", str);
+    }
+
+    printf(" (%llu nodes, %.3fs)\n", (unsigned long long)stats.num_nodes,
+           time);
+}
+
+
+int main(int argc, char **argv) {
+    uint64_t max_nodes = DEFAULT_MAX_NODES;
+    size_t   table_mb  = DEFAULT_TABLE_MB;
+
+    if (argc > 3) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (argc > 1) {
+        max_nodes = strtoull(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        table_mb = strtoul(argv[2], NULL, 10);
+    }
+
+    if ((max_nodes == 0) || (table_mb == 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    pn_solver_t *solver = pn_solver_new(table_mb << 20);
+    game_t      *game   = game_new();
+    if ((solver == NULL) || (game == NULL)) {
+        fprintf(stderr, "Cannot allocate the solver.\n");
+        return 1;
+    }
+
+    tablebase_t *tb = tablebase_open(DEFAULT_TABLEBASE_DIRECTORY);
+    tablebase_set_default(tb);
+
+    char line[256];
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        line[strcspn(line, "\n")] = '\0';
+        if ((line[0] == '#') || (line[0] == '\0')) {
+            continue;
+        }
+
+        if (notation_parse_position(line, game)) {
+            fprintf(stderr, "Invalid position: %s\n", line);
+            continue;
+        }
+
+        printf("%s: ", line);
+        solve(solver, game, max_nodes);
+    }
+
+    tablebase_close(tb);
+    game_free(game);
+    pn_solver_free(solver);
+    return 0;
+}
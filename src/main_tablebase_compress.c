@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tablebase.h"
+#include "tablebase_compressed.h"
+
+// NUM_PROBES is the number of probes used to measure the probe latency.
+#define NUM_PROBES    1000000
+
+static void usage(char *name) {
+    printf("Usage: %s <directory> [num eaten goats ...]\n", name);
+    printf("\n");
+    printf("Compresses the tablebase classes of `directory` in place and\n");
+    printf("reports the compression ratio and the probe latency.\n");
+    printf("By default, all the classes are compressed.\n");
+}
+
+
+static double elapsed(struct timespec *begin) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
+
+// probe_latency returns the average time of a probe in nanoseconds. Random
+// probes mostly decode a block, local ones (close indexes, as the positions
+// of a search) mostly hit the cache.
+static double probe_latency(tablebase_class_t *tb_class, bool local) {
+    struct timespec begin;
+    bitboard_t      tigers, goats;
+    uint64_t        index = 0;
+    int             sum   = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < NUM_PROBES; i++) {
+        if (!local || (i % 256 == 0)) {
+            index = ((uint64_t)rand() * RAND_MAX + rand()) %
+                    tb_class->num_positions;
+        } else {
+            index = (index + 1) % tb_class->num_positions;
+        }
+
+        tablebase_position(tb_class->material, index, &tigers, &goats);
+        sum += tablebase_class_get(tb_class, i % 2, tigers, goats);
+    }
+
+    // `sum` keeps the probes from being optimized out.
+    return elapsed(&begin) * 1e9 / NUM_PROBES + (sum == -1);
+}
+
+
+// compress compresses the class and prints its summary.
+// Returns 0 on success.
+static int compress(char *directory, int num_eaten_goats) {
+    tb_material_t       material = tablebase_material(num_eaten_goats);
+    tb_compress_stats_t stats;
+    struct timespec     begin;
+    char                filename[1024];
+
+    tablebase_filename(material, directory, filename, sizeof(filename));
+
+    tablebase_class_t *tb_class = tablebase_class_open(filename);
+    if (tb_class == NULL) {
+        fprintf(stderr, "Cannot open %s.\n", filename);
+        return 1;
+    }
+
+    printf("Class %d tigers, %d goats, %d eaten\n", material.num_tigers,
+           material.num_goats, material.num_eaten_goats);
+    if (tb_class->compressed == NULL) {
+        printf("  raw probe: %.0fns random, %.0fns local\n",
+               probe_latency(tb_class, false), probe_latency(tb_class, true));
+    }
+    tablebase_class_close(tb_class);
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    int err = tablebase_compress(filename, filename, &stats);
+    if (err == 1) {
+        printf("  already compressed\n");
+    } else if (err) {
+        fprintf(stderr, "Cannot compress the class (error %d).\n", err);
+        return err;
+    } else {
+        printf("  %llu -> %llu bytes (ratio %.2f), %llu blocks, %.1fs\n",
+               (unsigned long long)stats.raw_size,
+               (unsigned long long)stats.compressed_size,
+               (double)stats.raw_size / stats.compressed_size,
+               (unsigned long long)stats.num_blocks, elapsed(&begin));
+    }
+
+    tb_class = tablebase_class_open(filename);
+    if (tb_class == NULL) {
+        fprintf(stderr, "Cannot open %s.\n", filename);
+        return 1;
+    }
+    printf("  compressed probe: %.0fns random, %.0fns local\n",
+           probe_latency(tb_class, false), probe_latency(tb_class, true));
+    tablebase_class_close(tb_class);
+
+    return 0;
+}
+
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++) {
+            int num_eaten_goats = atoi(argv[i]);
+            if ((num_eaten_goats < 0) || (num_eaten_goats >= GOATS_EATEN_TO_WIN)) {
+                usage(argv[0]);
+                return 1;
+            }
+            if (compress(argv[1], num_eaten_goats)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    for (int i = GOATS_EATEN_TO_WIN - 1; i >= 0; i--) {
+        if (compress(argv[1], i)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
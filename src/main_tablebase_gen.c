@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tablebase.h"
+#include "tablebase_gen.h"
+
+static void usage(char *name) {
+    printf("Usage: %s [-m memory MB] <directory> [num threads] "
+           "[num eaten goats ...]\n", name);
+    printf("\n");
+    printf("Generates the tablebase of the movement phase in `directory`.\n");
+    printf("Material classes are given by their number of eaten goats and\n");
+    printf("must be generated from the most eaten goats to the least.\n");
+    printf("By default, all the classes are generated (from %d to 0) with\n",
+           GOATS_EATEN_TO_WIN - 1);
+    printf("one thread per core.\n");
+    printf("\n");
+    printf("With -m, classes are generated on disk using at most the given\n");
+    printf("memory. An interrupted generation resumes where it stopped.\n");
+}
+
+
+// generate generates the material class and prints its summary.
+// Returns 0 on success.
+// `memory_cap` is 0 to generate the class in memory.
+static int generate(char *directory, int num_threads, size_t memory_cap,
+                    int num_eaten_goats) {
+    tb_material_t         material = tablebase_material(num_eaten_goats);
+    tablebase_gen_stats_t stats;
+    struct timespec       begin, end;
+
+    printf("Class %d tigers, %d goats, %d eaten: %llu positions\n",
+           material.num_tigers, material.num_goats, material.num_eaten_goats,
+           (unsigned long long)(2 * tablebase_num_positions(material)));
+    fflush(stdout);
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    int err;
+    if (memory_cap > 0) {
+        err = tablebase_generate_out_of_core(material, directory, num_threads,
+                                             memory_cap, 0, &stats);
+    } else {
+        err = tablebase_generate(material, directory, num_threads, &stats);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (err) {
+        fprintf(stderr, "Cannot generate the class (error %d).\n", err);
+        return err;
+    }
+
+    printf("  %llu wins, %llu losses, %llu draws, max distance %d, %.1fs\n",
+           (unsigned long long)stats.num_wins,
+           (unsigned long long)stats.num_losses,
+           (unsigned long long)stats.num_draws, stats.max_dtr,
+           (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) * 1e-9);
+    return 0;
+}
+
+
+int main(int argc, char **argv) {
+    char   *name      = argv[0];
+    size_t memory_cap = 0;
+    int    opt;
+
+    while ((opt = getopt(argc, argv, "m:")) != -1) {
+        if ((opt != 'm') || (atol(optarg) <= 0)) {
+            usage(name);
+            return 1;
+        }
+        memory_cap = (size_t)atol(optarg) << 20;
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+    if (argc < 2) {
+        usage(name);
+        return 1;
+    }
+
+    char *directory   = argv[1];
+    int  num_threads  = argc > 2 ? atoi(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (num_threads <= 0) {
+        usage(name);
+        return 1;
+    }
+
+    mkdir(directory, 0755);
+
+    if (argc > 3) {
+        for (int i = 3; i < argc; i++) {
+            int num_eaten_goats = atoi(argv[i]);
+            if ((num_eaten_goats < 0) || (num_eaten_goats >= GOATS_EATEN_TO_WIN)) {
+                usage(name);
+                return 1;
+            }
+            if (generate(directory, num_threads, memory_cap, num_eaten_goats)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    for (int i = GOATS_EATEN_TO_WIN - 1; i >= 0; i--) {
+        if (generate(directory, num_threads, memory_cap, i)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
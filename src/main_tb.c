@@ -4,6 +4,9 @@
 #include "graphics.h"
 #include "graphics_tb.h"
 #include "ui_main.h"
+#include "opening_book.h"
+#include "pn_search.h"
+#include "tablebase.h"
 
 
 int main(int argc, char **argv) {
@@ -14,8 +17,23 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    // The book is optional: without it, the AIs just search every movement.
+    opening_book_t *book = opening_book_open(DEFAULT_OPENING_BOOK_FILENAME);
+    opening_book_set_default(book);
+
+    // Same for the tablebase of the movement phase.
+    tablebase_t *tb = tablebase_open(DEFAULT_TABLEBASE_DIRECTORY);
+    tablebase_set_default(tb);
+
+    // The AIs look for forced wins with the proof-number solver.
+    pn_solver_t *solver = pn_solver_new(PN_DEFAULT_TABLE_SIZE);
+    pn_set_default(solver);
+
     ui_main(tg, graphics_tb_callbacks);
 
     graphics_tb_quit(tg);
+    opening_book_close(book);
+    tablebase_close(tb);
+    pn_solver_free(solver);
     return 0;
 }
@@ -2,10 +2,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc_stats.h"
 #include "matrix.h"
 
 matrix_t *make_matrix(int rows, int cols, int capacity) {
-    matrix_t *m = malloc(sizeof(matrix_t));
+    matrix_t *m = ALLOC_MALLOC(ALLOC_MATRIX, sizeof(matrix_t));
 
     if (m == NULL) {
         return NULL;
@@ -22,9 +23,9 @@ matrix_t *make_matrix(int rows, int cols, int capacity) {
     m->num_cols = cols;
     m->capacity = capacity;
 
-    m->values = malloc(sizeof(double) * capacity);
+    m->values = ALLOC_MALLOC(ALLOC_MATRIX, sizeof(double) * capacity);
     if (m->values == NULL) {
-        free(m);
+        ALLOC_FREE(ALLOC_MATRIX, m);
         return NULL;
     }
 
@@ -37,8 +38,8 @@ void free_matrix(matrix_t *m) {
         return;
     }
 
-    free(m->values);
-    free(m);
+    ALLOC_FREE(ALLOC_MATRIX, m->values);
+    ALLOC_FREE(ALLOC_MATRIX, m);
 }
 
 
@@ -46,8 +47,8 @@ int matrix_set_size(matrix_t *m, int rows, int cols) {
     int min_capacity = rows * cols;
 
     if (m->capacity < min_capacity) {
-        free(m->values);
-        m->values = malloc(sizeof(double) * min_capacity);
+        ALLOC_FREE(ALLOC_MATRIX, m->values);
+        m->values = ALLOC_MALLOC(ALLOC_MATRIX, sizeof(double) * min_capacity);
         if (m->values == NULL) {
             return 1;
         }
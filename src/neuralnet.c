@@ -4,9 +4,11 @@
 #include <stdint.h>
 #include <math.h>
 
+#include "alloc_stats.h"
 #include "neuralnet.h"
 #include "matrix.h"
 #include "randn.h"
+#include "trace.h"
 
 // FILE_FORMAT_MAGIC_KEY is used to check the file format in which neural
 // networks are saved before loading it.
@@ -27,27 +29,27 @@
 //   double: values biases[num_layers - 2]
 
 neuralnet_t *make_neuralnet(int num_layers, int *sizes) {
-    neuralnet_t *net = malloc(sizeof(neuralnet_t));
+    neuralnet_t *net = ALLOC_MALLOC(ALLOC_NEURALNET, sizeof(neuralnet_t));
 
     if (net == NULL) {
         return NULL;
     }
 
     net->num_layers = num_layers;
-    net->sizes      = malloc(sizeof(int) * num_layers);
+    net->sizes      = ALLOC_MALLOC(ALLOC_NEURALNET, sizeof(int) * num_layers);
     if (net->sizes == NULL) {
-        free(net);
+        ALLOC_FREE(ALLOC_NEURALNET, net);
         return NULL;
     }
     memcpy(net->sizes, sizes, num_layers * sizeof(int));
 
-    net->weights = malloc(sizeof(matrix_t *) * (num_layers - 1));
+    net->weights = ALLOC_MALLOC(ALLOC_NEURALNET, sizeof(matrix_t *) * (num_layers - 1));
     if (net->weights == NULL) {
         free_neuralnet(net);
         return NULL;
     }
 
-    net->biases = malloc(sizeof(matrix_t *) * (num_layers - 1));
+    net->biases = ALLOC_MALLOC(ALLOC_NEURALNET, sizeof(matrix_t *) * (num_layers - 1));
     if (net->biases == NULL) {
         free_neuralnet(net);
         return NULL;
@@ -74,7 +76,7 @@ void free_neuralnet(neuralnet_t *net) {
              i++) {
             free_matrix(net->biases[i]);
         }
-        free(net->biases);
+        ALLOC_FREE(ALLOC_NEURALNET, net->biases);
     }
 
     if (net->weights != NULL) {
@@ -83,14 +85,14 @@ void free_neuralnet(neuralnet_t *net) {
              i++) {
             free_matrix(net->weights[i]);
         }
-        free(net->weights);
+        ALLOC_FREE(ALLOC_NEURALNET, net->weights);
     }
 
     if (net->biases != NULL) {
-        free(net->sizes);
+        ALLOC_FREE(ALLOC_NEURALNET, net->sizes);
     }
 
-    free(net);
+    ALLOC_FREE(ALLOC_NEURALNET, net);
 }
 
 
@@ -100,7 +102,7 @@ int load_neuralnet(neuralnet_t **net, char *filename) {
 
     // FIXME: Needs to handle errors better.
 
-    neuralnet_t *network = malloc(sizeof(neuralnet_t));
+    neuralnet_t *network = ALLOC_MALLOC(ALLOC_NEURALNET, sizeof(neuralnet_t));
 
     if (network == NULL) {
         return 1;
@@ -121,7 +123,7 @@ int load_neuralnet(neuralnet_t **net, char *filename) {
     fread(&value, sizeof(value), 1, f);
     network->num_layers = value;
 
-    network->sizes = malloc(sizeof(int) * network->num_layers);
+    network->sizes = ALLOC_MALLOC(ALLOC_NEURALNET, sizeof(int) * network->num_layers);
     if (network->sizes == NULL) {
         free_neuralnet(network);
         return 2;
@@ -132,7 +134,7 @@ int load_neuralnet(neuralnet_t **net, char *filename) {
         network->sizes[i] = value;
     }
 
-    network->weights = malloc(sizeof(matrix_t) * (network->num_layers - 1));
+    network->weights = ALLOC_MALLOC(ALLOC_NEURALNET, sizeof(matrix_t *) * (network->num_layers - 1));
     if (network->weights == NULL) {
         free_neuralnet(network);
         return 3;
@@ -141,10 +143,10 @@ int load_neuralnet(neuralnet_t **net, char *filename) {
     for (int i = 0; i < network->num_layers - 1; i++) {
         network->weights[i] = make_matrix(network->sizes[i + 1], network->sizes[i], 0);
         size_t size = network->weights[i]->num_cols * network->weights[i]->num_rows;
-        fread(&(network->weights[i]->values), size * sizeof(double), 1, f);
+        fread(network->weights[i]->values, size * sizeof(double), 1, f);
     }
 
-    network->biases = malloc(sizeof(matrix_t) * (network->num_layers - 1));
+    network->biases = ALLOC_MALLOC(ALLOC_NEURALNET, sizeof(matrix_t *) * (network->num_layers - 1));
     if (network->biases == NULL) {
         free_neuralnet(network);
         return 4;
@@ -153,7 +155,7 @@ int load_neuralnet(neuralnet_t **net, char *filename) {
     for (int i = 0; i < network->num_layers - 1; i++) {
         network->biases[i] = make_matrix(network->sizes[i + 1], 1, 0);
         size_t size = network->biases[i]->num_cols * network->biases[i]->num_rows;
-        fread(&(network->biases[i]->values), size * sizeof(double), 1, f);
+        fread(network->biases[i]->values, size * sizeof(double), 1, f);
     }
 
     fclose(f);
@@ -187,12 +189,12 @@ int neuralnet_save(neuralnet_t *net, char *filename) {
 
     for (int i = 0; i < net->num_layers - 1; i++) {
         size_t size = net->weights[i]->num_cols * net->weights[i]->num_rows;
-        fwrite(&net->weights[i]->values, size * sizeof(double), 1, f);
+        fwrite(net->weights[i]->values, size * sizeof(double), 1, f);
     }
 
     for (int i = 0; i < net->num_layers - 1; i++) {
         size_t size = net->biases[i]->num_cols * net->biases[i]->num_rows;
-        fwrite(&net->biases[i]->values, size * sizeof(double), 1, f);
+        fwrite(net->biases[i]->values, size * sizeof(double), 1, f);
     }
 
     fclose(f);
@@ -220,6 +222,8 @@ static double sigmoid(double x) {
 
 int neuralnet_feedforward(neuralnet_t *net,
                           matrix_t *in, matrix_t *out) {
+    TRACE_FUNCTION();
+
     matrix_t *temp = make_matrix(0, 0, 0);
 
     matrix_copy(in, out);
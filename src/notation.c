@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "notation.h"
+
+#define NUM_GOATS     20
+#define NUM_TIGERS    4
+
+
+// See header.
+int notation_parse_position(const char *str, game_t *game) {
+    board_t    board;
+    position_t pos        = { 0, 0 };
+    int        num_goats  = 0;
+    int        num_tigers = 0;
+
+    for (pos.r = 0; pos.r < 5; pos.r++) {
+        if ((pos.r > 0) && (*str++ != '/')) {
+            return 1;
+        }
+
+        for (pos.c = 0; pos.c < 5; pos.c++) {
+            switch (*str++) {
+            case 'T':
+                board_set_cell(&board, pos, TIGER_CELL);
+                num_tigers++;
+                break;
+
+            case 'G':
+                board_set_cell(&board, pos, GOAT_CELL);
+                num_goats++;
+                break;
+
+            case '.':
+                board_set_cell(&board, pos, EMPTY_CELL);
+                break;
+
+            default:
+                return 1;
+            }
+        }
+    }
+
+    // The rules only know games with every tiger on the board.
+    if ((num_tigers != NUM_TIGERS) || ((*str != ' ') && (*str != '\t'))) {
+        return 1;
+    }
+
+    char turn;
+    int  num_goats_to_put;
+    if (sscanf(str, " %c %d", &turn, &num_goats_to_put) != 2) {
+        return 2;
+    }
+
+    if ((turn != 'g') && (turn != 't')) {
+        return 2;
+    }
+
+    int num_eaten_goats = NUM_GOATS - num_goats_to_put - num_goats;
+    if ((num_goats_to_put < 0) || (num_eaten_goats < 0)) {
+        return 3;
+    }
+
+    game->board            = board;
+    game->turn             = turn == 'g' ? GOAT_TURN : TIGER_TURN;
+    game->num_goats_to_put = num_goats_to_put;
+    game->num_eaten_goats  = num_eaten_goats;
+    stack_reset(game->history);
+    game_update_status(game);
+    return 0;
+}
+
+
+// See header.
+void notation_format_position(game_t *game, char *str) {
+    position_t pos;
+
+    for (pos.r = 0; pos.r < 5; pos.r++) {
+        for (pos.c = 0; pos.c < 5; pos.c++) {
+            switch (board_get_cell(&game->board, pos)) {
+            case TIGER_CELL:
+                *str++ = 'T';
+                break;
+
+            case GOAT_CELL:
+                *str++ = 'G';
+                break;
+
+            default:
+                *str++ = '.';
+            }
+        }
+        *str++ = pos.r < 4 ? '/' : ' ';
+    }
+
+    sprintf(str, "%c %d", game->turn == GOAT_TURN ? 'g' : 't',
+            game->num_goats_to_put);
+}
+
+
+// parse_square reads the square at `str`.
+// Returns 0 on success.
+static int parse_square(const char *str, position_t *pos) {
+    if ((str[0] < 'a') || (str[0] > 'e') || (str[1] < '1') || (str[1] > '5')) {
+        return 1;
+    }
+
+    pos->c = str[0] - 'a';
+    pos->r = str[1] - '1';
+    return 0;
+}
+
+
+// See header.
+int notation_parse_mvt(const char *str, mvt_t *mvt) {
+    size_t len = strlen(str);
+
+    if ((len != 2) && ((len != 5) || (str[2] != '-'))) {
+        return 1;
+    }
+
+    if (parse_square(str, &mvt->from)) {
+        return 1;
+    }
+
+    if (len == 2) {
+        mvt->to = (position_t){
+            POSITION_NOT_SET, POSITION_NOT_SET
+        };
+        return 0;
+    }
+
+    return parse_square(str + 3, &mvt->to);
+}
+
+
+// See header.
+void notation_format_mvt(mvt_t mvt, char *str) {
+    *str++ = 'a' + mvt.from.c;
+    *str++ = '1' + mvt.from.r;
+
+    if (position_is_set(mvt.to)) {
+        *str++ = '-';
+        *str++ = 'a' + mvt.to.c;
+        *str++ = '1' + mvt.to.r;
+    }
+
+    *str = '\0';
+}
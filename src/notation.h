@@ -0,0 +1,46 @@
+#ifndef __NOTATION_H__
+#define __NOTATION_H__
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "game.h"
+#include "models.h"
+
+// A position is written as its rows separated by '/', then the player who
+// has to play and the number of goats to put:
+//
+//     T...T/...../...../...../T...T g 20
+//
+// Cells are 'T' (tiger), 'G' (goat) or '.' (empty), from the cell (0, 0) of
+// the board: 5 rows of 5 cells, holding the 4 tigers. The player is 'g' or
+// 't'. The number of eaten goats is deduced from the goats on the board.
+//
+// A square is written as its column letter ('a' to 'e') and its row number
+// ('1' to '5'). Placing a goat is written as its square ("c3") and moving a
+// token as both squares ("a1-b2").
+
+// NOTATION_POSITION_LEN is the size of a buffer holding a position.
+#define NOTATION_POSITION_LEN    40
+
+// NOTATION_MVT_LEN is the size of a buffer holding a movement.
+#define NOTATION_MVT_LEN         6
+
+// notation_parse_position sets the game to the position of `str`. Its history
+// is cleared.
+// Returns 0 on success.
+int notation_parse_position(const char *str, game_t *game);
+
+// notation_format_position writes the position of the game to `str`, which
+// must hold NOTATION_POSITION_LEN characters.
+void notation_format_position(game_t *game, char *str);
+
+// notation_parse_mvt sets `mvt` to the movement of `str`.
+// Returns 0 on success.
+int notation_parse_mvt(const char *str, mvt_t *mvt);
+
+// notation_format_mvt writes the movement to `str`, which must hold
+// NOTATION_MVT_LEN characters.
+void notation_format_mvt(mvt_t mvt, char *str);
+
+#endif
@@ -0,0 +1,278 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "opening_book.h"
+#include "symmetry.h"
+#include "zobrist.h"
+
+// FILE_FORMAT_MAGIC_KEY is used to check the file format of a book before
+// mapping it.
+#define FILE_FORMAT_MAGIC_KEY    0x4b4f4f42
+
+// The book is stored in a binary file so that it can be mapped in memory and
+// searched without being parsed.
+// Format:
+//   uint32: magic key
+//   uint32: size of an entry
+//   uint64: number of entries
+//   opening_book_entry_t: entries, sorted by increasing key. Keys are unique.
+typedef struct {
+    uint32_t magic;
+    uint32_t entry_size;
+    uint64_t num_entries;
+} book_header_t;
+
+static opening_book_t *default_book = NULL;
+
+
+// See header.
+opening_book_t *opening_book_open(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size < sizeof(book_header_t))) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    // The number of entries is compared with the one the size holds: the
+    // size it gives could wrap around.
+    book_header_t *header      = data;
+    size_t        entries_size = st.st_size - sizeof(book_header_t);
+    if ((header->magic != FILE_FORMAT_MAGIC_KEY) ||
+        (header->entry_size != sizeof(opening_book_entry_t)) ||
+        (entries_size % sizeof(opening_book_entry_t) != 0) ||
+        (header->num_entries != entries_size / sizeof(opening_book_entry_t))) {
+        munmap(data, st.st_size);
+        return NULL;
+    }
+
+    opening_book_t *book = malloc(sizeof(opening_book_t));
+    if (book == NULL) {
+        munmap(data, st.st_size);
+        return NULL;
+    }
+
+    book->data        = data;
+    book->size        = st.st_size;
+    book->entries     = (opening_book_entry_t *)(header + 1);
+    book->num_entries = header->num_entries;
+
+    return book;
+}
+
+
+// See header.
+void opening_book_close(opening_book_t *book) {
+    if (book == NULL) {
+        return;
+    }
+
+    if (default_book == book) {
+        default_book = NULL;
+    }
+
+    munmap(book->data, book->size);
+    free(book);
+}
+
+
+static uint8_t position_to_cell(position_t pos) {
+    if (!position_is_set(pos)) {
+        return OPENING_BOOK_CELL_NOT_SET;
+    }
+
+    return pos.r * 5 + pos.c;
+}
+
+
+static position_t cell_to_position(uint8_t cell) {
+    if (cell == OPENING_BOOK_CELL_NOT_SET) {
+        return (position_t){
+                   POSITION_NOT_SET, POSITION_NOT_SET
+        };
+    }
+
+    return (position_t){
+               cell % 5, cell / 5
+    };
+}
+
+
+// find_entry returns the entry with the given key using a binary search.
+// Returns NULL if there is none.
+static opening_book_entry_t *find_entry(opening_book_t *book, uint64_t key) {
+    size_t low  = 0;
+    size_t high = book->num_entries;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (book->entries[middle].key < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if ((low < book->num_entries) && (book->entries[low].key == key)) {
+        return &book->entries[low];
+    }
+
+    return NULL;
+}
+
+
+// mvt_is_possible returns true if the movement is in the possible movements of
+// the current player.
+static bool mvt_is_possible(game_t *game, mvt_t mvt) {
+    possible_positions_t possible_pos;
+
+    if (!position_is_valid(mvt.from)) {
+        return false;
+    }
+
+    game_get_possible_from_positions(game, &possible_pos);
+    if (!is_position_possible(&possible_pos, mvt.from)) {
+        return false;
+    }
+
+    if ((game->turn == GOAT_TURN) && (game->num_goats_to_put > 0)) {
+        return !position_is_set(mvt.to);
+    }
+
+    if (!position_is_valid(mvt.to)) {
+        return false;
+    }
+
+    game_get_possible_to_positions(game, mvt.from, &possible_pos);
+    return is_position_possible(&possible_pos, mvt.to);
+}
+
+
+// See header.
+bool opening_book_probe(opening_book_t *book, game_t *game, mvt_t *mvt,
+                        double *score) {
+    if ((book == NULL) || (book->num_entries == 0)) {
+        return false;
+    }
+
+    int                  sym;
+    uint64_t             key   = zobrist_canonical_hash(game, &sym);
+    opening_book_entry_t *entry = find_entry(book, key);
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    mvt_t canonical_mvt = {
+        cell_to_position(entry->from),
+        cell_to_position(entry->to)
+    };
+    mvt_t book_mvt = symmetry_mvt(symmetry_inverse(sym), canonical_mvt);
+
+    // A hash collision could lead to a movement from another position.
+    if (!mvt_is_possible(game, book_mvt)) {
+        return false;
+    }
+
+    *mvt = book_mvt;
+    if (score != NULL) {
+        *score = entry->score;
+    }
+
+    return true;
+}
+
+
+// See header.
+opening_book_entry_t opening_book_make_entry(game_t *game, mvt_t mvt,
+                                             int depth, double score) {
+    int                  sym;
+    opening_book_entry_t entry;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.key = zobrist_canonical_hash(game, &sym);
+
+    mvt_t canonical_mvt = symmetry_mvt(sym, mvt);
+    entry.from  = position_to_cell(canonical_mvt.from);
+    entry.to    = position_to_cell(canonical_mvt.to);
+    entry.depth = depth;
+    entry.score = score;
+
+    return entry;
+}
+
+
+// compare_entries orders the entries by increasing key, deepest search first.
+static int compare_entries(const void *e1, const void *e2) {
+    const opening_book_entry_t *entry1 = e1;
+    const opening_book_entry_t *entry2 = e2;
+
+    if (entry1->key != entry2->key) {
+        return entry1->key < entry2->key ? -1 : 1;
+    }
+
+    return (int)entry2->depth - (int)entry1->depth;
+}
+
+
+// See header.
+int opening_book_write(const char *filename, opening_book_entry_t *entries,
+                       size_t num_entries) {
+    qsort(entries, num_entries, sizeof(opening_book_entry_t), compare_entries);
+
+    // Only keep the first (and deepest) entry of each key.
+    size_t num_unique = 0;
+    for (size_t i = 0; i < num_entries; i++) {
+        if ((num_unique == 0) || (entries[num_unique - 1].key != entries[i].key)) {
+            entries[num_unique++] = entries[i];
+        }
+    }
+
+    FILE *f = fopen(filename, "wb");
+    if (f == NULL) {
+        return 1;
+    }
+
+    book_header_t header = {
+        .magic       = FILE_FORMAT_MAGIC_KEY,
+        .entry_size  = sizeof(opening_book_entry_t),
+        .num_entries = num_unique
+    };
+
+    if ((fwrite(&header, sizeof(header), 1, f) != 1) ||
+        (fwrite(entries, sizeof(opening_book_entry_t), num_unique, f) !=
+         num_unique)) {
+        fclose(f);
+        return 2;
+    }
+
+    return fclose(f) == 0 ? 0 : 3;
+}
+
+
+// See header.
+void opening_book_set_default(opening_book_t *book) {
+    default_book = book;
+}
+
+
+// See header.
+opening_book_t *opening_book_get_default() {
+    return default_book;
+}
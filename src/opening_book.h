@@ -0,0 +1,65 @@
+#ifndef __OPENING_BOOK_H__
+#define __OPENING_BOOK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "game.h"
+#include "models.h"
+
+// DEFAULT_OPENING_BOOK_FILENAME is the book loaded by the games at start up.
+#define DEFAULT_OPENING_BOOK_FILENAME    "book.bin"
+
+// OPENING_BOOK_CELL_NOT_SET marks the `to` cell of a goat placement.
+#define OPENING_BOOK_CELL_NOT_SET        0xff
+
+// opening_book_entry_t stores the best movement found for a position.
+// Positions are identified by their canonical hash (see
+// `zobrist_canonical_hash`) and the movement is stored in the canonical
+// orientation.
+typedef struct {
+    uint64_t key;
+    uint8_t  from;  // Cell index (r * 5 + c).
+    uint8_t  to;    // Cell index or OPENING_BOOK_CELL_NOT_SET.
+    uint16_t depth; // Depth of the search which found the movement.
+    float    score; // Value of the movement for the player who moves.
+} opening_book_entry_t;
+
+// opening_book_t is a book mapped in memory.
+// Use opening_book_open to create one and opening_book_close to destroy it.
+typedef struct {
+    void                 *data;
+    size_t               size;
+    opening_book_entry_t *entries;
+    size_t               num_entries;
+} opening_book_t;
+
+// opening_book_open maps the given book file in memory.
+// Returns NULL if the file doesn't exist or is not a valid book.
+opening_book_t *opening_book_open(const char *filename);
+void opening_book_close(opening_book_t *book);
+
+// opening_book_probe looks for the current position in the book.
+// Returns true and updates `mvt` (and `score` if not NULL) when the position is
+// found with a movement that is valid in the current game.
+bool opening_book_probe(opening_book_t *book, game_t *game, mvt_t *mvt,
+                        double *score);
+
+// opening_book_make_entry returns the entry storing `mvt` as the best
+// movement of the current game position.
+opening_book_entry_t opening_book_make_entry(game_t *game, mvt_t mvt,
+                                             int depth, double score);
+
+// opening_book_write sorts the entries and writes them as a book file.
+// When several entries have the same key, the deepest one is kept.
+// Returns 0 on success.
+int opening_book_write(const char *filename, opening_book_entry_t *entries,
+                       size_t num_entries);
+
+// opening_book_set_default sets the book probed by the AIs before they search.
+// NULL disables the book.
+void opening_book_set_default(opening_book_t *book);
+opening_book_t *opening_book_get_default();
+
+#endif
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "perf_counters.h"
+#include "tools.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// events are the type and config of each counter.
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} events[PERF_NUM_COUNTERS] = {
+    [PERF_CYCLES]        = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES        },
+    [PERF_INSTRUCTIONS]  = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS      },
+    [PERF_L1D_MISSES]    = { PERF_TYPE_HW_CACHE,
+                             PERF_COUNT_HW_CACHE_L1D |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)            },
+    [PERF_LLC_MISSES]    = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES      },
+    [PERF_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES     }
+};
+
+
+static int open_event(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1; // Allowed with perf_event_paranoid up to 2.
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                          PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+
+// See header.
+int perf_counters_open(perf_counters_t *counters) {
+    int num_available = 0;
+
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        counters->fds[i] = open_event(events[i].type, events[i].config);
+        if (counters->fds[i] >= 0) {
+            num_available++;
+        }
+    }
+
+    return num_available;
+}
+
+
+// See header.
+void perf_counters_close(perf_counters_t *counters) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (counters->fds[i] >= 0) {
+            close(counters->fds[i]);
+            counters->fds[i] = -1;
+        }
+    }
+}
+
+
+// See header.
+void perf_counters_start(perf_counters_t *counters) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+
+// See header.
+void perf_counters_stop(perf_counters_t *counters, perf_counts_t *counts) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        uint64_t data[3]; // Value, time enabled, time running.
+
+        if ((counters->fds[i] < 0) ||
+            (read(counters->fds[i], data, sizeof(data)) != sizeof(data)) ||
+            (data[2] == 0)) {
+            continue;
+        }
+
+        counts->values[i]   += data[2] < data[1] ?
+                               (uint64_t)((double)data[0] * data[1] / data[2]) :
+                               data[0];
+        counts->available[i] = true;
+    }
+}
+
+
+#else
+
+// See header.
+int perf_counters_open(perf_counters_t *counters) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        counters->fds[i] = -1;
+    }
+
+    return 0;
+}
+
+
+// See header.
+void perf_counters_close(perf_counters_t *counters) {
+}
+
+
+// See header.
+void perf_counters_start(perf_counters_t *counters) {
+}
+
+
+// See header.
+void perf_counters_stop(perf_counters_t *counters, perf_counts_t *counts) {
+}
+
+#endif
+
+
+// See header.
+void perf_counts_clear(perf_counts_t *counts) {
+    memset(counts, 0, sizeof(perf_counts_t));
+}
+
+
+// See header.
+double perf_counts_ipc(perf_counts_t *counts) {
+    if (!counts->available[PERF_CYCLES] ||
+        !counts->available[PERF_INSTRUCTIONS] ||
+        (counts->values[PERF_CYCLES] == 0)) {
+        return 0;
+    }
+
+    return (double)counts->values[PERF_INSTRUCTIONS] / counts->values[PERF_CYCLES];
+}
+
+
+// See header.
+void perf_counts_format(perf_counts_t *counts, uint64_t num_units,
+                        const char *unit, char *str) {
+    static const struct {
+        perf_counter_t counter;
+        const char     *name;
+    } misses[] = {
+        { PERF_L1D_MISSES,    "L1d"    },
+        { PERF_LLC_MISSES,    "LLC"    },
+        { PERF_BRANCH_MISSES, "branch" }
+    };
+    int  len      = 0;
+    bool any_miss = false;
+
+    str[0] = '\0';
+    if (perf_counts_ipc(counts) > 0) {
+        len += snprintf(str, PERF_COUNTS_LEN, "IPC %.2f", perf_counts_ipc(counts));
+    }
+
+    for (int i = 0; i < ARRAY_LEN(misses); i++) {
+        if (!counts->available[misses[i].counter] || (num_units == 0) ||
+            (len >= PERF_COUNTS_LEN)) {
+            continue;
+        }
+
+        len += snprintf(str + len, PERF_COUNTS_LEN - len, "%s%s %.2f",
+                        len > 0 ? "  " : "", misses[i].name,
+                        (double)counts->values[misses[i].counter] / num_units);
+        any_miss = true;
+    }
+
+    if (any_miss && (len < PERF_COUNTS_LEN)) {
+        snprintf(str + len, PERF_COUNTS_LEN - len, " misses/%s", unit);
+    }
+}
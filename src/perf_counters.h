@@ -0,0 +1,65 @@
+// perf_counters reads the hardware counters of the CPU around a region of
+// code, through `perf_event_open` on Linux. Counters the kernel or the CPU
+// don't give (virtual machines, `perf_event_paranoid`, other systems) are
+// marked unavailable: the region is still run, only not counted.
+
+#ifndef __PERF_COUNTERS_H__
+#define __PERF_COUNTERS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_NUM_COUNTERS
+} perf_counter_t;
+
+// perf_counters_t holds the counters of the calling thread.
+typedef struct {
+    int fds[PERF_NUM_COUNTERS]; // -1 if the counter is unavailable.
+} perf_counters_t;
+
+// perf_counts_t are the counts of a region.
+typedef struct {
+    uint64_t values[PERF_NUM_COUNTERS];
+    bool     available[PERF_NUM_COUNTERS];
+} perf_counts_t;
+
+// PERF_COUNTS_LEN is the size of the string of `perf_counts_format`.
+#define PERF_COUNTS_LEN    128
+
+// perf_counters_open opens the counters of the calling thread, user space
+// only.
+// Returns the number of available counters.
+int perf_counters_open(perf_counters_t *counters);
+
+// perf_counters_close closes the counters.
+void perf_counters_close(perf_counters_t *counters);
+
+// perf_counters_start resets the counters and starts counting.
+void perf_counters_start(perf_counters_t *counters);
+
+// perf_counters_stop stops counting and adds the counts since
+// `perf_counters_start` to `counts`, whose available counters are set.
+// Counts are scaled if the kernel had to share the counters with others.
+void perf_counters_stop(perf_counters_t *counters, perf_counts_t *counts);
+
+// perf_counts_clear sets the counts to 0 and unavailable.
+void perf_counts_clear(perf_counts_t *counts);
+
+// perf_counts_ipc returns the instructions per cycle, 0 if unavailable.
+double perf_counts_ipc(perf_counts_t *counts);
+
+// perf_counts_format writes the IPC and the misses per unit of work (per
+// node, per operation) to `str`, which must hold PERF_COUNTS_LEN chars, e.g.
+// "IPC 2.41  L1d 0.52  LLC 0.00  branch 1.73 misses/node". Unavailable
+// counters are skipped; `str` is empty if none is available.
+void perf_counts_format(perf_counts_t *counts, uint64_t num_units,
+                        const char *unit, char *str);
+
+#endif
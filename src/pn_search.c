@@ -0,0 +1,492 @@
+#include <string.h>
+
+#include "game_state.h"
+#include "pn_search.h"
+#include "tablebase.h"
+
+// PN_INFINITY is the proof number of a position which cannot be proven. Sums
+// of proof numbers saturate at it.
+#define PN_INFINITY            0x3fffffff
+
+// BUCKET_SIZE is the number of entries a position can be stored in.
+#define BUCKET_SIZE            4
+
+// MAX_PLY is the maximum depth of the search. Deeper positions count as a
+// failure of the attacker.
+#define MAX_PLY                256
+
+// GOATS_ATTACKER_KEY is xored to the hash of the positions when goats are
+// the attacker: the numbers of both searches are stored in the same table.
+#define GOATS_ATTACKER_KEY     0x6e71ad3f5c9e0b27ULL
+
+// entry_t stores the numbers of a position. `phi` is the proof number of the
+// player who has to play: the disproof number when the attacker has to play,
+// the proof number otherwise. `delta` is the other one.
+typedef struct {
+    uint64_t key; // 0 if the entry is empty.
+    uint32_t phi;
+    uint32_t delta;
+    uint64_t work; // Number of positions expanded to compute the numbers.
+} entry_t;
+
+struct pn_solver {
+    entry_t           *entries;
+    uint64_t          num_buckets;
+
+    // State of the current search.
+    player_turn_t     attacker;
+    uint64_t          max_nodes;
+    const ai_cancel_t *cancel; // NULL if the search can't be cancelled.
+    uint64_t          path[MAX_PLY];
+    int               ply;
+    pn_stats_t        stats;
+};
+
+static pn_solver_t *default_solver = NULL;
+
+
+// See header.
+pn_solver_t *pn_solver_new(size_t table_size) {
+    pn_solver_t *solver = malloc(sizeof(pn_solver_t));
+
+    if (solver == NULL) {
+        return NULL;
+    }
+
+    solver->num_buckets = table_size / (BUCKET_SIZE * sizeof(entry_t));
+    if (solver->num_buckets == 0) {
+        solver->num_buckets = 1;
+    }
+
+    solver->entries = calloc(solver->num_buckets * BUCKET_SIZE, sizeof(entry_t));
+    if (solver->entries == NULL) {
+        free(solver);
+        return NULL;
+    }
+
+    return solver;
+}
+
+
+// See header.
+void pn_solver_free(pn_solver_t *solver) {
+    if (solver == NULL) {
+        return;
+    }
+
+    if (default_solver == solver) {
+        default_solver = NULL;
+    }
+
+    free(solver->entries);
+    free(solver);
+}
+
+
+// See header.
+void pn_solver_clear(pn_solver_t *solver) {
+    memset(solver->entries, 0,
+           solver->num_buckets * BUCKET_SIZE * sizeof(entry_t));
+}
+
+
+static uint64_t position_key(const game_state_t *state, player_turn_t attacker) {
+    uint64_t key = state->hash ^ (attacker == GOAT_TURN ? GOATS_ATTACKER_KEY : 0);
+
+    return key != 0 ? key : 1;
+}
+
+
+static entry_t *lookup(pn_solver_t *solver, uint64_t key) {
+    entry_t *bucket = &solver->entries[(key % solver->num_buckets) * BUCKET_SIZE];
+
+    for (int i = 0; i < BUCKET_SIZE; i++) {
+        if (bucket[i].key == key) {
+            return &bucket[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+// store stores the numbers of a position. When the bucket is full, the
+// position which needed the least work is replaced.
+static void store(pn_solver_t *solver, uint64_t key, uint32_t phi,
+                  uint32_t delta, uint64_t work) {
+    entry_t *bucket = &solver->entries[(key % solver->num_buckets) * BUCKET_SIZE];
+    entry_t *entry  = &bucket[0];
+
+    for (int i = 0; i < BUCKET_SIZE; i++) {
+        if ((bucket[i].key == key) || (bucket[i].key == 0)) {
+            entry = &bucket[i];
+            break;
+        }
+        if (bucket[i].work < entry->work) {
+            entry = &bucket[i];
+        }
+    }
+
+    if ((entry->key != 0) && (entry->key != key)) {
+        solver->stats.num_replaced++;
+    }
+
+    solver->stats.num_stored++;
+    entry->key   = key;
+    entry->phi   = phi;
+    entry->delta = delta;
+    entry->work  = work;
+}
+
+
+// set_success sets the numbers of a position won by the player who has to
+// play (`success`) or lost.
+static void set_success(bool success, uint32_t *phi, uint32_t *delta) {
+    *phi   = success ? 0 : PN_INFINITY;
+    *delta = success ? PN_INFINITY : 0;
+}
+
+
+// evaluate sets the numbers of the position if it is solved without search:
+// the game is done or the tablebase knows it. Returns false otherwise.
+static bool evaluate(pn_solver_t *solver, const game_state_t *state,
+                     uint32_t *phi, uint32_t *delta) {
+    bool       attacker_plays = state->turn == solver->attacker;
+    tb_value_t value;
+
+    if (game_state_is_done(state)) {
+        set_success(false, phi, delta);
+        return true;
+    }
+
+    if ((state->num_goats_to_put == 0) &&
+        tablebase_probe_bitboards(tablebase_get_default(),
+                                  state->num_eaten_goats, state->turn,
+                                  state->tigers, state->goats, &value)) {
+        switch (tb_value_result(value)) {
+        case TB_VALUE_WIN:
+            set_success(true, phi, delta);
+            break;
+
+        case TB_VALUE_LOSS:
+            set_success(false, phi, delta);
+            break;
+
+        default:
+            // Only the attacker needs to win.
+            set_success(!attacker_plays, phi, delta);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+
+// child_numbers sets the numbers of a child position played by the attacker
+// if `attacker_plays`. Unknown positions get the numbers of a single position
+// to solve.
+static void child_numbers(pn_solver_t *solver, uint64_t key,
+                          bool attacker_plays, uint32_t *phi,
+                          uint32_t *delta) {
+    // Repetitions depend on the path: they are not stored.
+    for (int i = solver->ply - 1; i >= 0; i--) {
+        if (solver->path[i] == key) {
+            set_success(!attacker_plays, phi, delta);
+            return;
+        }
+    }
+
+    entry_t *entry = lookup(solver, key);
+    if (entry != NULL) {
+        *phi   = entry->phi;
+        *delta = entry->delta;
+    } else {
+        *phi   = 1;
+        *delta = 1;
+    }
+}
+
+
+static uint32_t add(uint32_t x, uint32_t y) {
+    return x + y >= PN_INFINITY ? PN_INFINITY : x + y;
+}
+
+
+// mid (multiple iterative deepening) searches the position until its `phi`
+// reaches `th_phi` or its `delta` reaches `th_delta`, then stores them.
+static void mid(pn_solver_t *solver, const game_state_t *state, uint64_t key,
+                uint32_t th_phi, uint32_t th_delta, uint32_t *phi,
+                uint32_t *delta) {
+    bool attacker_plays = state->turn == solver->attacker;
+
+    solver->stats.num_nodes++;
+
+    // Solved positions may have been replaced in the table.
+    if (evaluate(solver, state, phi, delta)) {
+        store(solver, key, *phi, *delta, 0);
+        return;
+    }
+
+    if (solver->ply >= MAX_PLY) {
+        set_success(!attacker_plays, phi, delta);
+        store(solver, key, *phi, *delta, 0);
+        return;
+    }
+
+    game_state_mvt_t mvts[GAME_MAX_NUM_MVTS];
+    uint64_t         keys[GAME_MAX_NUM_MVTS];
+    int              num_mvts   = game_state_get_mvts(state, mvts);
+    uint64_t         first_node = solver->stats.num_nodes;
+
+    solver->path[solver->ply++] = key;
+
+    // Children solved without search are stored first: their numbers are
+    // then read from the table like the others.
+    for (int i = 0; i < num_mvts; i++) {
+        game_state_t child;
+        uint32_t     child_phi, child_delta;
+
+        game_state_play(state, mvts[i], &child);
+        keys[i] = position_key(&child, solver->attacker);
+        if (evaluate(solver, &child, &child_phi, &child_delta)) {
+            store(solver, keys[i], child_phi, child_delta, 0);
+        }
+    }
+
+    while (true) {
+        // The player wins if one of the children is lost by the opponent: phi
+        // is the smallest delta of the children. It loses if all of them are
+        // won: delta is the sum of the phi of the children.
+        uint32_t min_delta    = PN_INFINITY;
+        uint32_t second_delta = PN_INFINITY;
+        uint32_t best_phi     = PN_INFINITY;
+        uint32_t sum_phi      = 0;
+        int      best         = -1;
+
+        for (int i = 0; i < num_mvts; i++) {
+            uint32_t child_phi, child_delta;
+            child_numbers(solver, keys[i], !attacker_plays, &child_phi,
+                          &child_delta);
+
+            sum_phi = add(sum_phi, child_phi);
+            if (child_delta < min_delta) {
+                second_delta = min_delta;
+                min_delta    = child_delta;
+                best_phi     = child_phi;
+                best         = i;
+            } else if (child_delta < second_delta) {
+                second_delta = child_delta;
+            }
+        }
+
+        *phi   = min_delta;
+        *delta = sum_phi;
+        if ((*phi >= th_phi) || (*delta >= th_delta) ||
+            (solver->stats.num_nodes >= solver->max_nodes) ||
+            ((solver->cancel != NULL) && ai_cancel_is_set(solver->cancel))) {
+            break;
+        }
+
+        // The most proving child is searched until it is not the best one
+        // anymore or its numbers exceed what the parent can afford.
+        uint32_t child_th_phi = th_delta >= PN_INFINITY ? PN_INFINITY :
+                                th_delta - *delta + best_phi;
+        uint32_t child_th_delta = second_delta + 1 < th_phi ?
+                                  second_delta + 1 : th_phi;
+        uint32_t     child_phi, child_delta;
+        game_state_t child;
+
+        game_state_play(state, mvts[best], &child);
+        mid(solver, &child, keys[best], child_th_phi, child_th_delta,
+            &child_phi, &child_delta);
+    }
+
+    solver->ply--;
+    store(solver, key, *phi, *delta, solver->stats.num_nodes - first_node + 1);
+}
+
+
+// proven returns true if the numbers of the position prove the win of the
+// attacker.
+static bool proven(pn_solver_t *solver, const game_state_t *state,
+                   uint32_t phi, uint32_t delta) {
+    return state->turn == solver->attacker ? phi == 0 : delta == 0;
+}
+
+
+// See header.
+bool pn_solve_player(pn_solver_t *solver, game_t *game, player_turn_t attacker,
+                     uint64_t max_nodes, const ai_cancel_t *cancel,
+                     pn_stats_t *stats) {
+    game_state_t state;
+    uint32_t     phi, delta;
+
+    game_state_from_game(game, &state);
+
+    uint64_t key = position_key(&state, attacker);
+
+    memset(&solver->stats, 0, sizeof(pn_stats_t));
+    solver->attacker  = attacker;
+    solver->max_nodes = max_nodes;
+    solver->cancel    = cancel;
+    solver->ply       = 0;
+
+    entry_t *entry = lookup(solver, key);
+    if ((entry != NULL) && proven(solver, &state, entry->phi, entry->delta)) {
+        phi   = entry->phi;
+        delta = entry->delta;
+    } else {
+        mid(solver, &state, key, PN_INFINITY, PN_INFINITY, &phi, &delta);
+    }
+
+    if (stats != NULL) {
+        *stats = solver->stats;
+    }
+
+    return proven(solver, &state, phi, delta);
+}
+
+
+// See header.
+pn_result_t pn_solve(pn_solver_t *solver, game_t *game, uint64_t max_nodes,
+                     pn_stats_t *stats) {
+    pn_stats_t  tigers_stats, goats_stats;
+    pn_result_t result = PN_UNPROVEN;
+
+    memset(&goats_stats, 0, sizeof(pn_stats_t));
+
+    if (pn_solve_player(solver, game, TIGER_TURN, max_nodes, NULL,
+                        &tigers_stats)) {
+        result = PN_TIGERS_WIN;
+    } else if (pn_solve_player(solver, game, GOAT_TURN, max_nodes, NULL,
+                               &goats_stats)) {
+        result = PN_GOATS_WIN;
+    }
+
+    if (stats != NULL) {
+        stats->num_nodes    = tigers_stats.num_nodes + goats_stats.num_nodes;
+        stats->num_stored   = tigers_stats.num_stored + goats_stats.num_stored;
+        stats->num_replaced = tigers_stats.num_replaced +
+                              goats_stats.num_replaced;
+    }
+
+    return result;
+}
+
+
+// proven_in_table returns true if the table proves that `attacker` wins.
+// `work` is set to the work spent on the proof.
+static bool proven_in_table(pn_solver_t *solver, const game_state_t *state,
+                            player_turn_t attacker, uint64_t *work) {
+    entry_t *entry = lookup(solver, position_key(state, attacker));
+
+    *work = 0;
+    if (game_state_is_done(state)) {
+        // The player who has to play lost.
+        return state->turn != attacker;
+    }
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    *work = entry->work;
+    return state->turn == attacker ? entry->phi == 0 : entry->delta == 0;
+}
+
+
+// probe_state is `pn_probe` for a state.
+static bool probe_state(pn_solver_t *solver, const game_state_t *state,
+                        pn_result_t *result) {
+    uint64_t work;
+
+    if (proven_in_table(solver, state, TIGER_TURN, &work)) {
+        *result = PN_TIGERS_WIN;
+        return true;
+    }
+
+    if (proven_in_table(solver, state, GOAT_TURN, &work)) {
+        *result = PN_GOATS_WIN;
+        return true;
+    }
+
+    return false;
+}
+
+
+// See header.
+bool pn_probe(pn_solver_t *solver, game_t *game, pn_result_t *result) {
+    game_state_t state;
+
+    if (solver == NULL) {
+        return false;
+    }
+
+    game_state_from_game(game, &state);
+    return probe_state(solver, &state, result);
+}
+
+
+// See header.
+int pn_solution_line(pn_solver_t *solver, game_t *game, mvt_t *line,
+                     int max_len) {
+    game_state_t state;
+    pn_result_t  result;
+    int          len = 0;
+
+    if (solver == NULL) {
+        return 0;
+    }
+
+    game_state_from_game(game, &state);
+    if (!probe_state(solver, &state, &result)) {
+        return 0;
+    }
+
+    player_turn_t winner = result == PN_TIGERS_WIN ? TIGER_TURN : GOAT_TURN;
+
+    while ((len < max_len) && !game_state_is_done(&state)) {
+        game_state_mvt_t mvts[GAME_MAX_NUM_MVTS];
+        game_state_t     best_child;
+        int              num_mvts  = game_state_get_mvts(&state, mvts);
+        int              best      = -1;
+        uint64_t         best_work = 0;
+
+        // The winner follows the smallest proof, the loser the largest one.
+        for (int i = 0; i < num_mvts; i++) {
+            game_state_t child;
+            uint64_t     work;
+
+            game_state_play(&state, mvts[i], &child);
+            if (proven_in_table(solver, &child, winner, &work) &&
+                ((best < 0) ||
+                 (state.turn == winner ? work < best_work : work > best_work))) {
+                best       = i;
+                best_work  = work;
+                best_child = child;
+            }
+        }
+
+        if (best < 0) {
+            break;
+        }
+
+        line[len++] = game_state_to_mvt(mvts[best]);
+        state       = best_child;
+    }
+
+    return len;
+}
+
+
+// See header.
+void pn_set_default(pn_solver_t *solver) {
+    default_solver = solver;
+}
+
+
+// See header.
+pn_solver_t *pn_get_default() {
+    return default_solver;
+}
@@ -0,0 +1,96 @@
+#ifndef __PN_SEARCH_H__
+#define __PN_SEARCH_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ai.h"
+#include "game.h"
+#include "models.h"
+
+// The proof-number solver tells whether a player can force a win from a
+// position. It runs a depth-first proof-number search (df-pn): the proof
+// number of a position is the minimum number of positions to solve to prove
+// the win, the disproof number the minimum to refute it. The search always
+// expands the most proving position, within thresholds, so that it can run
+// depth-first with a table of the numbers.
+// See: https://en.wikipedia.org/wiki/Proof-number_search
+//
+// A game is won by the player who doesn't have to play once it is done (see
+// `game_is_done`), or whose opponent cannot move. Positions of the default
+// tablebase are solved by probing it. A position repeated on the path
+// counts as a failure of the attacker: a forced win cannot loop.
+//
+// Proven wins are exact. A refutation only means no forced win was found: it
+// can depend on the path which reached the position, so it is not reported
+// as a result.
+
+// PN_DEFAULT_TABLE_SIZE is the size of the table of the default solver in
+// bytes.
+#define PN_DEFAULT_TABLE_SIZE    (16 << 20)
+
+// PN_AI_MAX_NODES is the number of positions the AIs search with the default
+// solver before each movement.
+#define PN_AI_MAX_NODES          20000
+
+// PN_MAX_LINE_LEN is the maximum length of a solution line.
+#define PN_MAX_LINE_LEN          256
+
+// pn_result_t is the result of a position.
+typedef enum {
+    PN_UNPROVEN,
+    PN_TIGERS_WIN,
+    PN_GOATS_WIN
+} pn_result_t;
+
+// pn_stats_t sums up a search.
+typedef struct {
+    uint64_t num_nodes;    // Positions expanded.
+    uint64_t num_stored;   // Entries written in the table.
+    uint64_t num_replaced; // Entries replaced by another position.
+} pn_stats_t;
+
+// pn_solver_t holds the table of proof and disproof numbers. It is kept from
+// a search to the next one: proven positions are found again.
+typedef struct pn_solver pn_solver_t;
+
+// pn_solver_new creates a solver whose table uses `table_size` bytes.
+// Returns NULL on allocation failure.
+pn_solver_t *pn_solver_new(size_t table_size);
+void pn_solver_free(pn_solver_t *solver);
+
+// pn_solver_clear forgets every position of the table.
+void pn_solver_clear(pn_solver_t *solver);
+
+// pn_solve tries to prove that tigers can force a win, then that goats can,
+// expanding at most `max_nodes` positions for each. `stats` can be NULL.
+// Returns the proven result.
+pn_result_t pn_solve(pn_solver_t *solver, game_t *game, uint64_t max_nodes,
+                     pn_stats_t *stats);
+
+// pn_solve_player tries to prove that `attacker` can force a win, expanding
+// at most `max_nodes` positions. The search stops early once `cancel` is set;
+// it can be NULL. `stats` can be NULL.
+// Returns true if the win is proven.
+bool pn_solve_player(pn_solver_t *solver, game_t *game, player_turn_t attacker,
+                     uint64_t max_nodes, const ai_cancel_t *cancel,
+                     pn_stats_t *stats);
+
+// pn_probe sets `result` to the result of the game if the table holds a proof.
+// It doesn't search.
+// Returns false if the position is not proven.
+bool pn_probe(pn_solver_t *solver, game_t *game, pn_result_t *result);
+
+// pn_solution_line writes the movements of a proven win to `line`: the
+// movements of the winner follow the proof and the ones of the loser resist
+// as long as the table knows. At most `max_len` movements are written.
+// Returns the number of movements, 0 if the game is not proven.
+int pn_solution_line(pn_solver_t *solver, game_t *game, mvt_t *line,
+                     int max_len);
+
+// pn_set_default sets the solver used by the AIs. NULL disables it.
+void pn_set_default(pn_solver_t *solver);
+pn_solver_t *pn_get_default();
+
+#endif
@@ -0,0 +1,265 @@
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "position_rank.h"
+#include "symmetry.h"
+
+#define NUM_CELLS    (5 * 5)
+
+static uint64_t binomials[NUM_CELLS + 1][NUM_CELLS + 1];
+static bool     binomials_initialized = false;
+
+// symmetric_tables_t stores, for a number of tigers, the classes of symmetric
+// tiger sets. Tables are indexed by the rank of the tiger sets.
+typedef struct {
+    uint32_t *classes;         // Class of each tiger set.
+    uint8_t  *syms;            // Symmetries sending the tiger set to the
+                               // representative of its class (one bit each).
+    uint32_t *representatives; // Rank of the representative of each class.
+    uint32_t num_classes;
+} symmetric_tables_t;
+
+static symmetric_tables_t symmetric_tables[NUM_CELLS + 1];
+
+
+static void binomials_init() {
+    for (int n = 0; n <= NUM_CELLS; n++) {
+        binomials[n][0] = 1;
+        for (int k = 1; k <= n; k++) {
+            binomials[n][k] = binomials[n - 1][k - 1] +
+                              (k < n ? binomials[n - 1][k] : 0);
+        }
+    }
+
+    binomials_initialized = true;
+}
+
+
+// See header.
+uint64_t position_binomial(int n, int k) {
+    if (!binomials_initialized) {
+        binomials_init();
+    }
+
+    if ((k < 0) || (n < 0) || (k > n)) {
+        return 0;
+    }
+
+    return binomials[n][k];
+}
+
+
+// subset_rank returns the rank of the set among the sets of the same size.
+// Cells of `mask` are skipped: the cells of `set` are renumbered among the
+// other cells.
+static uint64_t subset_rank(bitboard_t set, bitboard_t mask) {
+    uint64_t rank = 0;
+    int      k    = 1;
+
+    for (; set; set &= set - 1) {
+        int cell = bitboard_first(set);
+        cell -= bitboard_count(mask & (bitboard_cell(cell) - 1));
+        // k <= cell: binomials[cell][k] is never out of the table.
+        rank += binomials[cell][k++];
+    }
+
+    return rank;
+}
+
+
+// subset_unrank is the inverse of `subset_rank` for sets of `k` cells and
+// an empty mask.
+static bitboard_t subset_unrank(uint64_t rank, int k) {
+    bitboard_t set = 0;
+    int        c   = NUM_CELLS - 1;
+
+    for (; k > 0; k--) {
+        while (binomials[c][k] > rank) {
+            c--;
+        }
+        set  |= bitboard_cell(c);
+        rank -= binomials[c][k];
+        c--;
+    }
+
+    return set;
+}
+
+
+// expand renumbers the cells of `set` as the cells which are not in `mask`.
+static bitboard_t expand(bitboard_t set, bitboard_t mask) {
+    bitboard_t res  = 0;
+    bitboard_t free = ~mask & BITBOARD_ALL;
+
+    for (int i = 0; set; i++, free &= free - 1) {
+        if (bitboard_has(set, i)) {
+            res |= bitboard_cell(bitboard_first(free));
+            set &= ~bitboard_cell(i);
+        }
+    }
+
+    return res;
+}
+
+
+// See header.
+uint64_t position_rank_count(int num_tigers, int num_goats) {
+    return position_binomial(NUM_CELLS, num_tigers) *
+           position_binomial(NUM_CELLS - num_tigers, num_goats);
+}
+
+
+// See header.
+uint64_t position_rank(int num_tigers, int num_goats, bitboard_t tigers,
+                       bitboard_t goats) {
+    if (!binomials_initialized) {
+        binomials_init();
+    }
+
+    return subset_rank(tigers, 0) *
+           binomials[NUM_CELLS - num_tigers][num_goats] +
+           subset_rank(goats, tigers);
+}
+
+
+// See header.
+void position_unrank(int num_tigers, int num_goats, uint64_t rank,
+                     bitboard_t *tigers, bitboard_t *goats) {
+    if (!binomials_initialized) {
+        binomials_init();
+    }
+
+    uint64_t num_goats_ranks = binomials[NUM_CELLS - num_tigers][num_goats];
+
+    *tigers = subset_unrank(rank / num_goats_ranks, num_tigers);
+    *goats  = expand(subset_unrank(rank % num_goats_ranks, num_goats), *tigers);
+}
+
+
+// See header.
+uint64_t board_rank(board_t *board, int num_tigers, int num_goats) {
+    return position_rank(num_tigers, num_goats,
+                         bitboard_from_board(board, TIGER_CELL),
+                         bitboard_from_board(board, GOAT_CELL));
+}
+
+
+// See header.
+void board_unrank(board_t *board, int num_tigers, int num_goats, uint64_t rank) {
+    bitboard_t tigers, goats;
+
+    position_unrank(num_tigers, num_goats, rank, &tigers, &goats);
+    bitboard_to_board(tigers, goats, board);
+}
+
+
+// See header.
+int position_rank_symmetric_init(int num_tigers) {
+    symmetric_tables_t *tables = &symmetric_tables[num_tigers];
+
+    if (tables->classes != NULL) {
+        return 0;
+    }
+
+    uint64_t num_sets = position_binomial(NUM_CELLS, num_tigers);
+    uint32_t *classes = malloc(num_sets * sizeof(uint32_t));
+    uint8_t  *syms    = calloc(num_sets, sizeof(uint8_t));
+    // There are at least num_sets / NUM_SYMMETRIES classes, and at most
+    // num_sets.
+    uint32_t *representatives = malloc(num_sets * sizeof(uint32_t));
+
+    if ((classes == NULL) || (syms == NULL) || (representatives == NULL)) {
+        free(classes);
+        free(syms);
+        free(representatives);
+        return 1;
+    }
+
+    uint32_t num_classes = 0;
+    for (uint64_t rank = 0; rank < num_sets; rank++) {
+        if (syms[rank] != 0) {
+            continue;
+        }
+
+        // Sets are visited by increasing rank: the first one of a class is its
+        // representative.
+        bitboard_t set = subset_unrank(rank, num_tigers);
+        for (int sym = 0; sym < NUM_SYMMETRIES; sym++) {
+            uint64_t image = subset_rank(symmetry_bitboard(sym, set), 0);
+            classes[image] = num_classes;
+            syms[image]   |= 1 << symmetry_inverse(sym);
+        }
+        representatives[num_classes++] = rank;
+    }
+
+    tables->syms            = syms;
+    tables->representatives = realloc(representatives,
+                                      num_classes * sizeof(uint32_t));
+    tables->num_classes = num_classes;
+    tables->classes     = classes;
+    return 0;
+}
+
+
+// See header.
+uint64_t position_rank_count_symmetric(int num_tigers, int num_goats) {
+    if (position_rank_symmetric_init(num_tigers)) {
+        return 0;
+    }
+
+    return symmetric_tables[num_tigers].num_classes *
+           position_binomial(NUM_CELLS - num_tigers, num_goats);
+}
+
+
+// See header.
+uint64_t position_rank_symmetric(int num_tigers, int num_goats,
+                                 bitboard_t tigers, bitboard_t goats,
+                                 int *sym) {
+    symmetric_tables_t *tables = &symmetric_tables[num_tigers];
+
+    if ((tables->classes == NULL) && position_rank_symmetric_init(num_tigers)) {
+        return 0;
+    }
+
+    uint64_t tigers_rank = subset_rank(tigers, 0);
+    uint8_t  syms        = tables->syms[tigers_rank];
+    uint64_t goats_rank  = UINT64_MAX;
+    int      best_sym    = SYMMETRY_IDENTITY;
+
+    for (; syms; syms &= syms - 1) {
+        int      s    = __builtin_ctz(syms);
+        uint64_t rank = subset_rank(symmetry_bitboard(s, goats),
+                                    symmetry_bitboard(s, tigers));
+        if (rank < goats_rank) {
+            goats_rank = rank;
+            best_sym   = s;
+        }
+    }
+
+    if (sym != NULL) {
+        *sym = best_sym;
+    }
+
+    return tables->classes[tigers_rank] *
+           binomials[NUM_CELLS - num_tigers][num_goats] + goats_rank;
+}
+
+
+// See header.
+void position_unrank_symmetric(int num_tigers, int num_goats, uint64_t rank,
+                               bitboard_t *tigers, bitboard_t *goats) {
+    symmetric_tables_t *tables = &symmetric_tables[num_tigers];
+
+    if ((tables->classes == NULL) && position_rank_symmetric_init(num_tigers)) {
+        *tigers = 0;
+        *goats  = 0;
+        return;
+    }
+
+    uint64_t num_goats_ranks = binomials[NUM_CELLS - num_tigers][num_goats];
+
+    *tigers = subset_unrank(tables->representatives[rank / num_goats_ranks],
+                            num_tigers);
+    *goats = expand(subset_unrank(rank % num_goats_ranks, num_goats), *tigers);
+}
@@ -0,0 +1,63 @@
+#ifndef __POSITION_RANK_H__
+#define __POSITION_RANK_H__
+
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "models.h"
+
+// Position ranking maps the boards with a given number of tigers and goats to
+// the integers from 0 to `position_rank_count - 1` and back. It is used to
+// index dense tables of positions.
+//
+// Tigers are ranked among the sets of `num_tigers` cells with the
+// combinatorial number system. Goats are ranked the same way among the cells
+// left empty by the tigers:
+//     rank = rank(tigers) * binomial(25 - num_tigers, num_goats) + rank(goats)
+// See: https://en.wikipedia.org/wiki/Combinatorial_number_system
+
+// position_binomial returns n choose k.
+uint64_t position_binomial(int n, int k);
+
+// position_rank_count returns the number of positions.
+uint64_t position_rank_count(int num_tigers, int num_goats);
+
+// position_rank returns the rank of the position.
+uint64_t position_rank(int num_tigers, int num_goats, bitboard_t tigers,
+                       bitboard_t goats);
+
+// position_unrank is the inverse of `position_rank`.
+void position_unrank(int num_tigers, int num_goats, uint64_t rank,
+                     bitboard_t *tigers, bitboard_t *goats);
+
+// board_rank and board_unrank do the same on boards.
+uint64_t board_rank(board_t *board, int num_tigers, int num_goats);
+void board_unrank(board_t *board, int num_tigers, int num_goats, uint64_t rank);
+
+// Symmetric ranking gives the same rank to the positions which are symmetric
+// (see symmetry.h). Tigers are ranked among the classes of symmetric tiger
+// sets, which is about 8 times less than the tiger sets. When the tigers are
+// symmetric to themselves, the symmetry with the smallest goat rank is used:
+// some goat ranks are then never used.
+
+// position_rank_count_symmetric returns the number of symmetric ranks.
+uint64_t position_rank_count_symmetric(int num_tigers, int num_goats);
+
+// position_rank_symmetric returns the symmetric rank of the position.
+// If `sym` is not NULL, it is set to the symmetry that transforms the position
+// to the one returned by `position_unrank_symmetric`.
+uint64_t position_rank_symmetric(int num_tigers, int num_goats,
+                                 bitboard_t tigers, bitboard_t goats, int *sym);
+
+// position_unrank_symmetric returns the representative of the symmetric
+// positions with the given rank.
+void position_unrank_symmetric(int num_tigers, int num_goats, uint64_t rank,
+                               bitboard_t *tigers, bitboard_t *goats);
+
+// position_rank_symmetric_init computes the tables used by the symmetric ranks
+// of `num_tigers` tigers. They are computed on first use otherwise; call it
+// before using the symmetric ranks from several threads.
+// Returns 0 on success.
+int position_rank_symmetric_init(int num_tigers);
+
+#endif
@@ -1,12 +1,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc_stats.h"
 #include "stack.h"
 
 #define GROW_FACTOR    2
 
 stack_t *new_stack(size_t element_size, size_t capacity) {
-    stack_t *stack = malloc(sizeof(stack_t));
+    stack_t *stack = ALLOC_MALLOC(ALLOC_STACK, sizeof(stack_t));
 
     if (stack == NULL) {
         return NULL;
@@ -16,9 +17,9 @@ stack_t *new_stack(size_t element_size, size_t capacity) {
     stack->capacity     = capacity;
     stack->num_elements = 0;
 
-    stack->data = malloc(element_size * capacity);
+    stack->data = ALLOC_MALLOC(ALLOC_STACK, element_size * capacity);
     if (stack->data == NULL) {
-        free(stack);
+        ALLOC_FREE(ALLOC_STACK, stack);
         return NULL;
     }
 
@@ -27,20 +28,20 @@ stack_t *new_stack(size_t element_size, size_t capacity) {
 
 
 void free_stack(stack_t *stack) {
-    free(stack->data);
-    free(stack);
+    ALLOC_FREE(ALLOC_STACK, stack->data);
+    ALLOC_FREE(ALLOC_STACK, stack);
 }
 
 
 int stack_change_capacity(stack_t *stack, size_t capacity) {
-    char *buffer = malloc(stack->element_size * capacity);
+    char *buffer = ALLOC_MALLOC(ALLOC_STACK, stack->element_size * capacity);
 
     if (buffer == NULL) {
         return 1;
     }
 
     memcpy(buffer, stack->data, stack->num_elements * stack->element_size);
-    free(stack->data);
+    ALLOC_FREE(ALLOC_STACK, stack->data);
     stack->data     = buffer;
     stack->capacity = capacity;
 
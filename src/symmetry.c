@@ -0,0 +1,97 @@
+#include <stdbool.h>
+
+#include "symmetry.h"
+
+static int  cells[NUM_SYMMETRIES][5 * 5];
+static bool initialized = false;
+
+// symmetry_transform applies the symmetry `sym` to the coordinates.
+// Symmetries 0 to 3 are the rotations by 0, 90, 180 and 270 degrees.
+// Symmetries 4 to 7 are the same rotations followed by a transposition.
+static position_t symmetry_transform(int sym, position_t pos) {
+    position_t res = pos;
+
+    if (sym >= 4) {
+        res.c = pos.r;
+        res.r = pos.c;
+    }
+
+    for (int i = 0; i < sym % 4; i++) {
+        position_t rotated = { 4 - res.r, res.c };
+        res = rotated;
+    }
+
+    return res;
+}
+
+
+// See header.
+position_t symmetry_position(int sym, position_t pos) {
+    if (!position_is_set(pos)) {
+        return pos;
+    }
+
+    return symmetry_transform(sym, pos);
+}
+
+
+static void symmetry_init() {
+    for (int sym = 0; sym < NUM_SYMMETRIES; sym++) {
+        for (int cell = 0; cell < 5 * 5; cell++) {
+            position_t pos = symmetry_transform(sym, (position_t){cell % 5, cell / 5 });
+            cells[sym][cell] = pos.r * 5 + pos.c;
+        }
+    }
+
+    initialized = true;
+}
+
+
+// See header.
+int symmetry_cell(int sym, int cell) {
+    if (!initialized) {
+        symmetry_init();
+    }
+
+    return cells[sym][cell];
+}
+
+
+// See header.
+mvt_t symmetry_mvt(int sym, mvt_t mvt) {
+    mvt.from = symmetry_position(sym, mvt.from);
+    mvt.to   = symmetry_position(sym, mvt.to);
+    return mvt;
+}
+
+
+// See header.
+void symmetry_board(int sym, board_t *src, board_t *dest) {
+    for (int i = 0; i < 5 * 5; i++) {
+        dest->tab[symmetry_cell(sym, i)] = src->tab[i];
+    }
+}
+
+
+// See header.
+bitboard_t symmetry_bitboard(int sym, bitboard_t bb) {
+    bitboard_t res = 0;
+
+    for (; bb; bb &= bb - 1) {
+        res |= bitboard_cell(symmetry_cell(sym, bitboard_first(bb)));
+    }
+
+    return res;
+}
+
+
+// See header.
+int symmetry_inverse(int sym) {
+    // Transpositions are their own inverse. Rotations are undone by the
+    // rotation of the opposite angle.
+    if (sym >= 4) {
+        return sym;
+    }
+
+    return (4 - sym) % 4;
+}
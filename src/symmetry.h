@@ -0,0 +1,36 @@
+#ifndef __SYMMETRY_H__
+#define __SYMMETRY_H__
+
+#include "bitboard.h"
+#include "models.h"
+
+// The board is invariant under the 8 symmetries of the square (rotations and
+// reflections). Every symmetry maps diagonal points to diagonal points, so a
+// movement which is valid on a board is valid on its transformed board.
+#define NUM_SYMMETRIES    8
+
+// SYMMETRY_IDENTITY is the symmetry which doesn't change anything.
+#define SYMMETRY_IDENTITY    0
+
+// symmetry_position returns the image of `pos` through the symmetry `sym`.
+// Positions which are not set are returned as is.
+position_t symmetry_position(int sym, position_t pos);
+
+// symmetry_cell returns the image of the cell index `cell` (r * 5 + c) through
+// the symmetry `sym`.
+int symmetry_cell(int sym, int cell);
+
+// symmetry_mvt returns the image of `mvt` through the symmetry `sym`.
+mvt_t symmetry_mvt(int sym, mvt_t mvt);
+
+// symmetry_board stores the image of `src` through `sym` in `dest`.
+// `src` and `dest` must not be the same board.
+void symmetry_board(int sym, board_t *src, board_t *dest);
+
+// symmetry_bitboard returns the image of the set of cells through `sym`.
+bitboard_t symmetry_bitboard(int sym, bitboard_t bb);
+
+// symmetry_inverse returns the symmetry that undoes `sym`.
+int symmetry_inverse(int sym);
+
+#endif
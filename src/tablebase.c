@@ -0,0 +1,433 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tablebase.h"
+#include "tablebase_compressed.h"
+#include "position_rank.h"
+
+// FILE_FORMAT_MAGIC_KEY is used to check the file format of a material class
+// before mapping it.
+#define FILE_FORMAT_MAGIC_KEY    0x42544342
+
+// A material class is stored in a binary file so that it can be mapped in
+// memory and probed without being parsed.
+// Format:
+//   uint32: magic key
+//   uint32: size of a value
+//   int32: number of tigers
+//   int32: number of goats
+//   int32: number of eaten goats
+//   uint32: padding
+//   uint64: number of positions per player turn
+//   tb_value_t: values of the positions when goats have to play
+//   tb_value_t: values of the positions when tigers have to play
+typedef struct {
+    uint32_t magic;
+    uint32_t value_size;
+    int32_t  num_tigers;
+    int32_t  num_goats;
+    int32_t  num_eaten_goats;
+    uint32_t padding;
+    uint64_t num_positions;
+} tb_header_t;
+
+static tablebase_t *default_tablebase = NULL;
+
+
+// See header.
+tb_material_t tablebase_material(int num_eaten_goats) {
+    return (tb_material_t){
+               4, 20 - num_eaten_goats, num_eaten_goats
+    };
+}
+
+
+// See header.
+uint64_t tablebase_num_positions(tb_material_t material) {
+    return position_rank_count(material.num_tigers, material.num_goats);
+}
+
+
+// See header.
+uint64_t tablebase_index(tb_material_t material, bitboard_t tigers,
+                         bitboard_t goats) {
+    return position_rank(material.num_tigers, material.num_goats, tigers, goats);
+}
+
+
+// See header.
+void tablebase_position(tb_material_t material, uint64_t index,
+                        bitboard_t *tigers, bitboard_t *goats) {
+    position_unrank(material.num_tigers, material.num_goats, index, tigers,
+                    goats);
+}
+
+
+// See header.
+void tablebase_filename(tb_material_t material, const char *directory,
+                        char *filename, size_t size) {
+    snprintf(filename, size, "%s/tb_t%d_g%d_e%d.bin", directory,
+             material.num_tigers, material.num_goats, material.num_eaten_goats);
+}
+
+
+// See header.
+tablebase_class_t *tablebase_class_open(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size < sizeof(tb_header_t))) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    tb_header_t     *header     = data;
+    tb_material_t   material    = {
+        header->num_tigers, header->num_goats, header->num_eaten_goats
+    };
+    tb_compressed_t *compressed = NULL;
+
+    if (header->magic != FILE_FORMAT_MAGIC_KEY) {
+        compressed = tb_compressed_open(data, st.st_size, &material);
+        if (compressed == NULL) {
+            munmap(data, st.st_size);
+            return NULL;
+        }
+    } else if ((header->value_size != sizeof(tb_value_t)) ||
+               (header->num_positions != tablebase_num_positions(material)) ||
+               (st.st_size != sizeof(tb_header_t) +
+                2 * header->num_positions * sizeof(tb_value_t))) {
+        munmap(data, st.st_size);
+        return NULL;
+    }
+
+    tablebase_class_t *tb_class = malloc(sizeof(tablebase_class_t));
+    if (tb_class == NULL) {
+        tb_compressed_close(compressed);
+        munmap(data, st.st_size);
+        return NULL;
+    }
+
+    tb_class->material      = material;
+    tb_class->num_positions = tablebase_num_positions(material);
+    tb_class->data          = data;
+    tb_class->size          = st.st_size;
+    tb_class->compressed    = compressed;
+
+    if (compressed != NULL) {
+        tb_class->values[GOAT_TURN]  = NULL;
+        tb_class->values[TIGER_TURN] = NULL;
+    } else {
+        tb_class->values[GOAT_TURN]  = (tb_value_t *)(header + 1);
+        tb_class->values[TIGER_TURN] = tb_class->values[GOAT_TURN] +
+                                       header->num_positions;
+    }
+
+    return tb_class;
+}
+
+
+// See header.
+void tablebase_class_close(tablebase_class_t *tb_class) {
+    if (tb_class == NULL) {
+        return;
+    }
+
+    tb_compressed_close(tb_class->compressed);
+    munmap(tb_class->data, tb_class->size);
+    free(tb_class);
+}
+
+
+// See header.
+int tablebase_class_write_header(FILE *f, tb_material_t material) {
+    tb_header_t header = {
+        .magic           = FILE_FORMAT_MAGIC_KEY,
+        .value_size      = sizeof(tb_value_t),
+        .num_tigers      = material.num_tigers,
+        .num_goats       = material.num_goats,
+        .num_eaten_goats = material.num_eaten_goats,
+        .num_positions   = tablebase_num_positions(material)
+    };
+
+    return fwrite(&header, sizeof(header), 1, f) == 1 ? 0 : 1;
+}
+
+
+// See header.
+int tablebase_class_write(const char *filename, tb_material_t material,
+                          tb_value_t *values[2]) {
+    FILE     *f             = fopen(filename, "wb");
+    uint64_t num_positions = tablebase_num_positions(material);
+
+    if (f == NULL) {
+        return 1;
+    }
+
+    if (tablebase_class_write_header(f, material) ||
+        (fwrite(values[GOAT_TURN], sizeof(tb_value_t), num_positions, f) !=
+         num_positions) ||
+        (fwrite(values[TIGER_TURN], sizeof(tb_value_t), num_positions, f) !=
+         num_positions)) {
+        fclose(f);
+        return 2;
+    }
+
+    return fclose(f) == 0 ? 0 : 3;
+}
+
+
+// See header.
+tb_value_t tablebase_class_get(tablebase_class_t *tb_class, player_turn_t turn,
+                               bitboard_t tigers, bitboard_t goats) {
+    uint64_t index = tablebase_index(tb_class->material, tigers, goats);
+
+    if (tb_class->compressed != NULL) {
+        return tb_compressed_get(tb_class->compressed, turn, index);
+    }
+    return tb_class->values[turn][index];
+}
+
+
+// See header.
+tablebase_t *tablebase_open(const char *directory) {
+    tablebase_t *tb = malloc(sizeof(tablebase_t));
+
+    if (tb == NULL) {
+        return NULL;
+    }
+
+    bool found = false;
+    for (int i = 0; i < GOATS_EATEN_TO_WIN; i++) {
+        tb_material_t material = tablebase_material(i);
+        char          filename[1024];
+
+        tablebase_filename(material, directory, filename, sizeof(filename));
+        tb->classes[i] = tablebase_class_open(filename);
+
+        // Positions are indexed with the material of the file: a misnamed
+        // class would be probed out of its values.
+        tablebase_class_t *tb_class = tb->classes[i];
+        if ((tb_class != NULL) &&
+            ((tb_class->material.num_tigers != material.num_tigers) ||
+             (tb_class->material.num_goats != material.num_goats) ||
+             (tb_class->material.num_eaten_goats !=
+              material.num_eaten_goats))) {
+            tablebase_class_close(tb_class);
+            tb->classes[i] = NULL;
+        }
+        found |= tb->classes[i] != NULL;
+    }
+
+    if (!found) {
+        free(tb);
+        return NULL;
+    }
+
+    return tb;
+}
+
+
+// See header.
+void tablebase_close(tablebase_t *tb) {
+    if (tb == NULL) {
+        return;
+    }
+
+    if (default_tablebase == tb) {
+        default_tablebase = NULL;
+    }
+
+    for (int i = 0; i < GOATS_EATEN_TO_WIN; i++) {
+        tablebase_class_close(tb->classes[i]);
+    }
+    free(tb);
+}
+
+
+// lookup sets `value` to the value of the position of the real game.
+// Returns false if the material class is not loaded.
+static bool lookup(tablebase_t *tb, int num_eaten_goats, player_turn_t turn,
+                   bitboard_t tigers, bitboard_t goats, tb_value_t *value) {
+    if ((num_eaten_goats >= GOATS_EATEN_TO_WIN) ||
+        bitboard_tigers_blocked(tigers, goats)) {
+        *value = TB_VALUE_LOSS;
+        return true;
+    }
+
+    tablebase_class_t *tb_class = tb->classes[num_eaten_goats];
+    if (tb_class == NULL) {
+        return false;
+    }
+
+    *value = tablebase_class_get(tb_class, turn, tigers, goats);
+    return *value != TB_VALUE_INVALID;
+}
+
+
+// is_real returns true if the material is the one of a real game.
+static bool is_real(int num_eaten_goats, bitboard_t tigers, bitboard_t goats) {
+    tb_material_t material = tablebase_material(num_eaten_goats);
+
+    return bitboard_count(tigers) == material.num_tigers &&
+           bitboard_count(goats) == material.num_goats;
+}
+
+
+// can_probe returns true if the game is in the movement phase of a real game.
+static bool can_probe(tablebase_t *tb, game_t *game, bitboard_t *tigers,
+                      bitboard_t *goats) {
+    if ((tb == NULL) || (game->num_goats_to_put > 0)) {
+        return false;
+    }
+
+    *tigers = bitboard_from_board(&game->board, TIGER_CELL);
+    *goats  = bitboard_from_board(&game->board, GOAT_CELL);
+    return is_real(game->num_eaten_goats, *tigers, *goats);
+}
+
+
+// See header.
+bool tablebase_probe(tablebase_t *tb, game_t *game, tb_value_t *value) {
+    bitboard_t tigers, goats;
+
+    if (!can_probe(tb, game, &tigers, &goats)) {
+        return false;
+    }
+
+    return lookup(tb, game->num_eaten_goats, game->turn, tigers, goats, value);
+}
+
+
+// See header.
+bool tablebase_probe_bitboards(tablebase_t *tb, int num_eaten_goats,
+                               player_turn_t turn, bitboard_t tigers,
+                               bitboard_t goats, tb_value_t *value) {
+    if ((tb == NULL) || (num_eaten_goats > GOATS_EATEN_TO_WIN) ||
+        !is_real(num_eaten_goats, tigers, goats)) {
+        return false;
+    }
+
+    return lookup(tb, num_eaten_goats, turn, tigers, goats, value);
+}
+
+
+// mvt_rank orders the values of the positions reached by a movement from the
+// point of view of the player who moves: the higher, the better.
+static int mvt_rank(tb_value_t child_value) {
+    switch (tb_value_result(child_value)) {
+    case TB_VALUE_LOSS:
+        return 2 * TB_VALUE_DTR_MASK - tb_value_dtr(child_value);
+
+    case TB_VALUE_WIN:
+        return tb_value_dtr(child_value);
+
+    default:
+        return TB_VALUE_DTR_MASK;
+    }
+}
+
+
+static mvt_t make_mvt(int from, int to) {
+    return (mvt_t){
+               { from % 5, from / 5 }, { to % 5, to / 5 }
+    };
+}
+
+
+// See header.
+bool tablebase_best_mvt(tablebase_t *tb, game_t *game, mvt_t *mvt) {
+    bitboard_t tigers, goats;
+
+    if (!can_probe(tb, game, &tigers, &goats) || game_is_done(game)) {
+        return false;
+    }
+
+    bitboard_t    empty     = ~(tigers | goats) & BITBOARD_ALL;
+    bitboard_t    movables  = game->turn == TIGER_TURN ? tigers : goats;
+    player_turn_t next_turn = game->turn == TIGER_TURN ? GOAT_TURN : TIGER_TURN;
+    int           best_rank = -1;
+    tb_value_t    value;
+
+    for (bitboard_t m = movables; m; m &= m - 1) {
+        int                         from = bitboard_first(m);
+        const bitboard_neighbours_t *n   = bitboard_neighbours(from);
+
+        for (int i = 0; i < n->num_neighbours; i++) {
+            int to = n->neighbours[i];
+            if (!bitboard_has(empty, to)) {
+                continue;
+            }
+
+            bitboard_t step = bitboard_cell(from) | bitboard_cell(to);
+            bool       found;
+            if (game->turn == TIGER_TURN) {
+                found = lookup(tb, game->num_eaten_goats, next_turn,
+                               tigers ^ step, goats, &value);
+            } else {
+                found = lookup(tb, game->num_eaten_goats, next_turn,
+                               tigers, goats ^ step, &value);
+            }
+
+            if (!found) {
+                return false;
+            }
+
+            if (mvt_rank(value) > best_rank) {
+                best_rank = mvt_rank(value);
+                *mvt      = make_mvt(from, to);
+            }
+        }
+
+        if (game->turn != TIGER_TURN) {
+            continue;
+        }
+
+        for (int i = 0; i < n->num_jumps; i++) {
+            int over = n->jumps[i].over;
+            int to   = n->jumps[i].to;
+            if (!bitboard_has(goats, over) || !bitboard_has(empty, to)) {
+                continue;
+            }
+
+            if (!lookup(tb, game->num_eaten_goats + 1, GOAT_TURN,
+                        tigers ^ bitboard_cell(from) ^ bitboard_cell(to),
+                        goats ^ bitboard_cell(over), &value)) {
+                return false;
+            }
+
+            if (mvt_rank(value) > best_rank) {
+                best_rank = mvt_rank(value);
+                *mvt      = make_mvt(from, to);
+            }
+        }
+    }
+
+    return best_rank >= 0;
+}
+
+
+// See header.
+void tablebase_set_default(tablebase_t *tb) {
+    default_tablebase = tb;
+}
+
+
+// See header.
+tablebase_t *tablebase_get_default() {
+    return default_tablebase;
+}
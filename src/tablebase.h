@@ -0,0 +1,140 @@
+#ifndef __TABLEBASE_H__
+#define __TABLEBASE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitboard.h"
+#include "game.h"
+#include "models.h"
+
+// A tablebase stores the result of every position of the movement phase (all
+// the goats have been put on the board) under perfect play.
+//
+// Positions are grouped by material class: the number of tigers, goats on the
+// board and eaten goats. A tiger jump moves the game to the class with one goat
+// less, so classes are generated from the most eaten goats to the least.
+//
+// The results follow the `game_is_done` semantics: when the game is done, the
+// player who has to play lost. A player who cannot move also lost.
+
+// DEFAULT_TABLEBASE_DIRECTORY is the directory the games load tablebases from.
+#define DEFAULT_TABLEBASE_DIRECTORY    "tablebases"
+
+// tb_value_t is the result of a position for the player who has to play and
+// its distance to the result: the number of movements before the game is done
+// when the winner wins as fast as possible and the looser resists as long as
+// possible. Draws have no distance.
+typedef uint16_t tb_value_t;
+
+#define TB_VALUE_DRAW            0x0000
+#define TB_VALUE_WIN             0x4000
+#define TB_VALUE_LOSS            0x8000
+#define TB_VALUE_RESULT_MASK     0xc000
+#define TB_VALUE_DTR_MASK        0x3fff
+// TB_VALUE_INVALID is returned when the value can't be read. It is no result.
+#define TB_VALUE_INVALID         0xffff
+
+#define tb_value_result(v)    ((v) & TB_VALUE_RESULT_MASK)
+#define tb_value_dtr(v)       ((v) & TB_VALUE_DTR_MASK)
+
+// tb_material_t defines a material class.
+// The classes of a real game have 4 tigers and 20 - `num_eaten_goats` goats.
+typedef struct {
+    int num_tigers;
+    int num_goats;
+    int num_eaten_goats;
+} tb_material_t;
+
+// tablebase_material returns the material class of the real game in which
+// `num_eaten_goats` goats have been eaten.
+tb_material_t tablebase_material(int num_eaten_goats);
+
+// tablebase_num_positions returns the number of positions of the material
+// class for each player turn.
+uint64_t tablebase_num_positions(tb_material_t material);
+
+// tablebase_index returns the index of the position in its material class
+// (see `position_rank`). Indexes go from 0 to
+// `tablebase_num_positions(material) - 1`.
+uint64_t tablebase_index(tb_material_t material, bitboard_t tigers,
+                         bitboard_t goats);
+
+// tablebase_position is the inverse of `tablebase_index`.
+void tablebase_position(tb_material_t material, uint64_t index,
+                        bitboard_t *tigers, bitboard_t *goats);
+
+// tablebase_filename writes the name of the file storing the material class
+// in `directory` to `filename`.
+void tablebase_filename(tb_material_t material, const char *directory,
+                        char *filename, size_t size);
+
+// tablebase_class_t is a material class file mapped in memory.
+typedef struct {
+    tb_material_t        material;
+    uint64_t             num_positions;
+    void                 *data;
+    size_t               size;
+    tb_value_t           *values[2];  // Indexed by player_turn_t. NULL if the
+                                      // file is compressed.
+    struct tb_compressed *compressed; // See tablebase_compressed.h.
+} tablebase_class_t;
+
+// tablebase_class_open maps the given material class file in memory. The file
+// can be raw or compressed.
+// Returns NULL if the file doesn't exist or is not valid.
+tablebase_class_t *tablebase_class_open(const char *filename);
+void tablebase_class_close(tablebase_class_t *tb_class);
+
+// tablebase_class_write writes the values of a material class.
+// `values` is indexed by player_turn_t and each table holds
+// `tablebase_num_positions(material)` values.
+// Returns 0 on success.
+int tablebase_class_write(const char *filename, tb_material_t material,
+                          tb_value_t *values[2]);
+
+// tablebase_class_write_header writes the header of a material class file.
+// The values of the goats, then of the tigers, must follow. It lets classes
+// which don't fit in memory be written sequentially.
+// Returns 0 on success.
+int tablebase_class_write_header(FILE *f, tb_material_t material);
+
+// tablebase_class_get returns the value of the position, or TB_VALUE_INVALID
+// if the file of the class is corrupt.
+tb_value_t tablebase_class_get(tablebase_class_t *tb_class, player_turn_t turn,
+                               bitboard_t tigers, bitboard_t goats);
+
+// tablebase_t gathers the material classes of the real game.
+// Classes which have not been generated are NULL.
+typedef struct {
+    tablebase_class_t *classes[GOATS_EATEN_TO_WIN];
+} tablebase_t;
+
+// tablebase_open loads all the material classes found in `directory`.
+// Returns NULL if there is none.
+tablebase_t *tablebase_open(const char *directory);
+void tablebase_close(tablebase_t *tb);
+
+// tablebase_probe sets `value` to the value of the current game.
+// Returns false if the game is not in the movement phase or if its material
+// class is not loaded.
+bool tablebase_probe(tablebase_t *tb, game_t *game, tb_value_t *value);
+
+// tablebase_probe_bitboards is `tablebase_probe` for a position of the
+// movement phase given by its tokens.
+bool tablebase_probe_bitboards(tablebase_t *tb, int num_eaten_goats,
+                               player_turn_t turn, bitboard_t tigers,
+                               bitboard_t goats, tb_value_t *value);
+
+// tablebase_best_mvt sets `mvt` to the movement with the best result:
+// the fastest win, a draw or the slowest loss.
+// Returns false if the position cannot be probed.
+bool tablebase_best_mvt(tablebase_t *tb, game_t *game, mvt_t *mvt);
+
+// tablebase_set_default sets the tablebase used by the AIs. NULL disables it.
+void tablebase_set_default(tablebase_t *tb);
+tablebase_t *tablebase_get_default();
+
+#endif
@@ -0,0 +1,578 @@
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tablebase_compressed.h"
+
+// FILE_FORMAT_MAGIC_KEY is used to recognize compressed class files.
+#define FILE_FORMAT_MAGIC_KEY    0x5a544342
+
+// MAX_CODE_LENGTH is the maximum number of bits of a Huffman code.
+#define MAX_CODE_LENGTH          16
+
+// LOOKUP_BITS is the number of bits decoded at once.
+#define LOOKUP_BITS              8
+
+// EMPTY_BLOCK marks the cache entries which hold no block.
+#define EMPTY_BLOCK              UINT64_MAX
+
+#define NUM_BUCKETS              (2 * TB_CACHE_NUM_BLOCKS)
+
+// A compressed class is stored in a binary file.
+// Format:
+//   uint32: magic key
+//   uint32: number of values of a block
+//   int32: number of tigers
+//   int32: number of goats
+//   int32: number of eaten goats
+//   uint32: padding
+//   uint64: number of positions per player turn
+//   uint64: number of blocks
+//   uint64[number of blocks + 1]: offset of each block in the file, then the
+//                                 size of the file
+//   blocks
+//
+// The values of the goats then of the tigers are cut in blocks. A block is
+// Huffman coded with a canonical code:
+//   uint16: number of distinct values
+//   uint16[]: the distinct values, sorted by code length then value
+//   uint8[]: the code length of each value (0 if there is a single value)
+//   bits: the codes of the values of the block, most significant bit first
+typedef struct {
+    uint32_t magic;
+    uint32_t block_size;
+    int32_t  num_tigers;
+    int32_t  num_goats;
+    int32_t  num_eaten_goats;
+    uint32_t padding;
+    uint64_t num_positions;
+    uint64_t num_blocks;
+} tb_compressed_header_t;
+
+// cache_entry_t is a decoded block.
+typedef struct {
+    uint64_t   block;
+    uint64_t   last_use;
+    int        next; // Next entry of the bucket, or -1.
+    tb_value_t values[TB_BLOCK_SIZE];
+} cache_entry_t;
+
+struct tb_compressed {
+    uint8_t         *data;
+    uint64_t        num_values; // For both player turns.
+    uint64_t        num_positions;
+    uint64_t        num_blocks;
+    uint64_t        *offsets;
+    pthread_mutex_t lock;
+    uint64_t        clock;
+    int             buckets[NUM_BUCKETS];
+    cache_entry_t   entries[TB_CACHE_NUM_BLOCKS];
+};
+
+// symbol_t is a distinct value of a block being compressed.
+typedef struct {
+    tb_value_t value;
+    uint32_t   freq;
+    int        length;
+    uint32_t   code;
+} symbol_t;
+
+
+// See header.
+tb_compressed_t *tb_compressed_open(void *data, size_t size,
+                                    tb_material_t *material) {
+    tb_compressed_header_t *header = data;
+
+    if ((size < sizeof(tb_compressed_header_t)) ||
+        (header->magic != FILE_FORMAT_MAGIC_KEY) ||
+        (header->block_size != TB_BLOCK_SIZE)) {
+        return NULL;
+    }
+
+    *material = (tb_material_t){
+        header->num_tigers, header->num_goats, header->num_eaten_goats
+    };
+
+    uint64_t num_values = 2 * header->num_positions;
+    uint64_t *offsets   = (uint64_t *)(header + 1);
+    if ((header->num_positions != tablebase_num_positions(*material)) ||
+        (header->num_blocks != (num_values + TB_BLOCK_SIZE - 1) / TB_BLOCK_SIZE) ||
+        (size < sizeof(tb_compressed_header_t) +
+         (header->num_blocks + 1) * sizeof(uint64_t)) ||
+        (offsets[header->num_blocks] != size)) {
+        return NULL;
+    }
+
+    // The blocks are read from their offsets: they must lie in order between
+    // the index and the end of the file.
+    uint64_t index_end = sizeof(tb_compressed_header_t) +
+                         (header->num_blocks + 1) * sizeof(uint64_t);
+    for (uint64_t i = 0; i < header->num_blocks; i++) {
+        if ((offsets[i] < (i == 0 ? index_end : offsets[i - 1])) ||
+            (offsets[i] > offsets[i + 1])) {
+            return NULL;
+        }
+    }
+
+    tb_compressed_t *compressed = malloc(sizeof(tb_compressed_t));
+    if (compressed == NULL) {
+        return NULL;
+    }
+
+    compressed->data          = data;
+    compressed->num_values    = num_values;
+    compressed->num_positions = header->num_positions;
+    compressed->num_blocks    = header->num_blocks;
+    compressed->offsets       = offsets;
+    compressed->clock         = 0;
+    pthread_mutex_init(&compressed->lock, NULL);
+
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        compressed->buckets[i] = -1;
+    }
+    for (int i = 0; i < TB_CACHE_NUM_BLOCKS; i++) {
+        compressed->entries[i].block    = EMPTY_BLOCK;
+        compressed->entries[i].last_use = 0;
+        compressed->entries[i].next     = -1;
+    }
+
+    return compressed;
+}
+
+
+// See header.
+void tb_compressed_close(tb_compressed_t *compressed) {
+    if (compressed == NULL) {
+        return;
+    }
+
+    pthread_mutex_destroy(&compressed->lock);
+    free(compressed);
+}
+
+
+static uint64_t block_num_values(uint64_t num_values, uint64_t block) {
+    uint64_t first = block * TB_BLOCK_SIZE;
+
+    return num_values - first < TB_BLOCK_SIZE ? num_values - first :
+           TB_BLOCK_SIZE;
+}
+
+
+static uint16_t read_uint16(const uint8_t *p) {
+    uint16_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+// decode_block decodes the block to `values`. The block is checked as it is
+// read: a corrupt file must not make it read outside of the block.
+// Returns 0 on success.
+static int decode_block(tb_compressed_t *compressed, uint64_t block,
+                        tb_value_t *values) {
+    const uint8_t *p          = compressed->data + compressed->offsets[block];
+    const uint8_t *end        = compressed->data +
+                                compressed->offsets[block + 1];
+    uint64_t      size        = block_num_values(compressed->num_values, block);
+
+    if (end - p < (ptrdiff_t)sizeof(uint16_t)) {
+        return 1;
+    }
+
+    int           num_symbols = read_uint16(p);
+    const uint8_t *symbols    = p + sizeof(uint16_t);
+    const uint8_t *lengths    = symbols + num_symbols * sizeof(uint16_t);
+    const uint8_t *bits       = lengths + num_symbols;
+
+    if ((num_symbols < 1) || (num_symbols > TB_BLOCK_SIZE) || (bits > end)) {
+        return 2;
+    }
+
+    if (num_symbols == 1) {
+        for (uint64_t i = 0; i < size; i++) {
+            values[i] = read_uint16(symbols);
+        }
+        return 0;
+    }
+
+    // Canonical codes of a length are consecutive: `first_code` is the code of
+    // the first symbol of each length and `first_index` its index.
+    int      count[MAX_CODE_LENGTH + 1] = { 0 };
+    int      first_index[MAX_CODE_LENGTH + 1];
+    uint32_t first_code[MAX_CODE_LENGTH + 1];
+
+    for (int i = 0; i < num_symbols; i++) {
+        if ((lengths[i] < 1) || (lengths[i] > MAX_CODE_LENGTH)) {
+            return 3;
+        }
+        count[lengths[i]]++;
+    }
+
+    uint32_t code  = 0;
+    int      index = 0;
+    for (int len = 1; len <= MAX_CODE_LENGTH; len++) {
+        first_code[len]  = code;
+        first_index[len] = index;
+
+        // More codes than the length allows would overflow the lookup table.
+        if (code + count[len] > (1u << len)) {
+            return 4;
+        }
+        code   = (code + count[len]) << 1;
+        index += count[len];
+    }
+
+    // Codes of at most LOOKUP_BITS bits are decoded with a table indexed by
+    // the next LOOKUP_BITS bits: the symbol and its length. The others are
+    // compared with the first code of each longer length.
+    int16_t lookup_symbols[1 << LOOKUP_BITS];
+    uint8_t lookup_lengths[1 << LOOKUP_BITS];
+    memset(lookup_lengths, 0, sizeof(lookup_lengths));
+    for (int len = 1; len <= LOOKUP_BITS; len++) {
+        for (int c = 0; c < count[len]; c++) {
+            int first = (first_code[len] + c) << (LOOKUP_BITS - len);
+            for (int j = 0; j < 1 << (LOOKUP_BITS - len); j++) {
+                lookup_symbols[first + j] = first_index[len] + c;
+                lookup_lengths[first + j] = len;
+            }
+        }
+    }
+
+    uint64_t buffer   = 0; // Next bits, most significant first.
+    int      num_bits = 0;
+    for (uint64_t i = 0; i < size; i++) {
+        while ((num_bits <= 56) && (bits < end)) {
+            buffer   |= (uint64_t)*bits++ << (56 - num_bits);
+            num_bits += 8;
+        }
+
+        int s   = lookup_symbols[buffer >> (64 - LOOKUP_BITS)];
+        int len = lookup_lengths[buffer >> (64 - LOOKUP_BITS)];
+        if (len == 0) {
+            for (len = LOOKUP_BITS + 1; ; len++) {
+                code = buffer >> (64 - len);
+                if ((code - first_code[len] < (uint32_t)count[len]) ||
+                    (len == MAX_CODE_LENGTH)) {
+                    break;
+                }
+            }
+            if (code - first_code[len] >= (uint32_t)count[len]) {
+                return 5;
+            }
+            s = first_index[len] + code - first_code[len];
+        }
+
+        if ((s >= num_symbols) || (len > num_bits)) {
+            return 5;
+        }
+        values[i] = read_uint16(symbols + s * sizeof(uint16_t));
+        buffer  <<= len;
+        num_bits -= len;
+    }
+
+    return 0;
+}
+
+
+// See header.
+tb_value_t tb_compressed_get(tb_compressed_t *compressed, player_turn_t turn,
+                             uint64_t index) {
+    uint64_t value_index = turn * compressed->num_positions + index;
+    uint64_t block       = value_index / TB_BLOCK_SIZE;
+    int      bucket      = block % NUM_BUCKETS;
+    int      e;
+
+    pthread_mutex_lock(&compressed->lock);
+
+    for (e = compressed->buckets[bucket]; e >= 0;
+         e = compressed->entries[e].next) {
+        if (compressed->entries[e].block == block) {
+            break;
+        }
+    }
+
+    if (e < 0) {
+        // Replaces the least recently used block.
+        e = 0;
+        for (int i = 1; i < TB_CACHE_NUM_BLOCKS; i++) {
+            if (compressed->entries[i].last_use <
+                compressed->entries[e].last_use) {
+                e = i;
+            }
+        }
+
+        cache_entry_t *entry = &compressed->entries[e];
+        if (entry->block != EMPTY_BLOCK) {
+            int *link = &compressed->buckets[entry->block % NUM_BUCKETS];
+            while (*link != e) {
+                link = &compressed->entries[*link].next;
+            }
+            *link = entry->next;
+        }
+
+        if (decode_block(compressed, block, entry->values) != 0) {
+            entry->block    = EMPTY_BLOCK;
+            entry->last_use = 0;
+            pthread_mutex_unlock(&compressed->lock);
+            return TB_VALUE_INVALID;
+        }
+        entry->block                = block;
+        entry->next                 = compressed->buckets[bucket];
+        compressed->buckets[bucket] = e;
+    }
+
+    cache_entry_t *entry = &compressed->entries[e];
+    entry->last_use = ++compressed->clock;
+    tb_value_t value = entry->values[value_index % TB_BLOCK_SIZE];
+
+    pthread_mutex_unlock(&compressed->lock);
+
+    return value;
+}
+
+
+static int compare_values(const void *a, const void *b) {
+    return *(const tb_value_t *)a - *(const tb_value_t *)b;
+}
+
+
+static int compare_freqs(const void *a, const void *b) {
+    const symbol_t *x = *(symbol_t *const *)a;
+    const symbol_t *y = *(symbol_t *const *)b;
+
+    return x->freq < y->freq ? -1 : x->freq > y->freq;
+}
+
+
+static int compare_lengths(const void *a, const void *b) {
+    const symbol_t *x = a;
+    const symbol_t *y = b;
+
+    if (x->length != y->length) {
+        return x->length - y->length;
+    }
+    return x->value - y->value;
+}
+
+
+// huffman_lengths sets the code length of the symbols from their frequencies.
+// Returns the longest length.
+static int huffman_lengths(symbol_t *symbols, int n) {
+    symbol_t *leaves[n];
+    uint64_t weights[2 * n];
+    int      parents[2 * n];
+    int      depths[2 * n];
+
+    for (int i = 0; i < n; i++) {
+        leaves[i] = &symbols[i];
+    }
+    qsort(leaves, n, sizeof(symbol_t *), compare_freqs);
+    for (int i = 0; i < n; i++) {
+        weights[i] = leaves[i]->freq;
+    }
+
+    // Leaves and internal nodes are both created by increasing weights: the
+    // two lightest nodes are at the front of one of them.
+    int next_leaf = 0;
+    int next_node = n;
+    for (int k = n; k < 2 * n - 1; k++) {
+        weights[k] = 0;
+        for (int j = 0; j < 2; j++) {
+            int node;
+            if ((next_leaf < n) &&
+                ((next_node >= k) || (weights[next_leaf] <= weights[next_node]))) {
+                node = next_leaf++;
+            } else {
+                node = next_node++;
+            }
+            weights[k]   += weights[node];
+            parents[node] = k;
+        }
+    }
+
+    int max_length = 0;
+    depths[2 * n - 2] = 0;
+    for (int k = 2 * n - 3; k >= 0; k--) {
+        depths[k] = depths[parents[k]] + 1;
+        if ((k < n) && (depths[k] > max_length)) {
+            max_length = depths[k];
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        leaves[i]->length = depths[i];
+    }
+
+    return max_length;
+}
+
+
+// encode_block writes the compressed block to `out`. `symbols_by_value` is
+// a table of 1 << 16 entries used to find the symbol of each value.
+// Returns the size of the block.
+static size_t encode_block(const tb_value_t *values, size_t size,
+                           uint8_t *out, int16_t *symbols_by_value) {
+    tb_value_t sorted[TB_BLOCK_SIZE];
+    symbol_t   symbols[TB_BLOCK_SIZE];
+    int        n = 0;
+
+    memcpy(sorted, values, size * sizeof(tb_value_t));
+    qsort(sorted, size, sizeof(tb_value_t), compare_values);
+    for (size_t i = 0; i < size; i++) {
+        if ((n == 0) || (symbols[n - 1].value != sorted[i])) {
+            symbols[n++] = (symbol_t){
+                sorted[i], 0, 0, 0
+            };
+        }
+        symbols[n - 1].freq++;
+    }
+
+    if (n > 1) {
+        // Flattens the frequencies until the codes are short enough.
+        while (huffman_lengths(symbols, n) > MAX_CODE_LENGTH) {
+            for (int i = 0; i < n; i++) {
+                symbols[i].freq = (symbols[i].freq >> 1) | 1;
+            }
+        }
+    }
+
+    qsort(symbols, n, sizeof(symbol_t), compare_lengths);
+    uint32_t code = 0;
+    for (int i = 0; i < n; i++) {
+        if (i > 0) {
+            code = (code + 1) << (symbols[i].length - symbols[i - 1].length);
+        }
+        symbols[i].code = code;
+    }
+
+    uint16_t num_symbols = n;
+    uint8_t  *p          = out;
+    memcpy(p, &num_symbols, sizeof(uint16_t));
+    p += sizeof(uint16_t);
+    for (int i = 0; i < n; i++) {
+        memcpy(p, &symbols[i].value, sizeof(uint16_t));
+        p += sizeof(uint16_t);
+    }
+    for (int i = 0; i < n; i++) {
+        *p++ = symbols[i].length;
+    }
+
+    if (n == 1) {
+        return p - out;
+    }
+
+    for (int i = 0; i < n; i++) {
+        symbols_by_value[symbols[i].value] = i;
+    }
+
+    uint64_t pos = 0;
+    for (size_t i = 0; i < size; i++) {
+        symbol_t *s = &symbols[symbols_by_value[values[i]]];
+        for (int b = s->length - 1; b >= 0; b--, pos++) {
+            if ((pos & 7) == 0) {
+                p[pos >> 3] = 0;
+            }
+            p[pos >> 3] |= ((s->code >> b) & 1) << (7 - (pos & 7));
+        }
+    }
+
+    return (p - out) + (pos + 7) / 8;
+}
+
+
+// See header.
+int tablebase_compress(const char *src, const char *dst,
+                       tb_compress_stats_t *stats) {
+    tablebase_class_t *tb_class = tablebase_class_open(src);
+
+    if ((tb_class == NULL) || (tb_class->compressed != NULL)) {
+        tablebase_class_close(tb_class);
+        return 1;
+    }
+
+    char tmp[1100];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", dst) >= (int)sizeof(tmp)) {
+        tablebase_class_close(tb_class);
+        return 4;
+    }
+    FILE *f = fopen(tmp, "wb");
+    if (f == NULL) {
+        tablebase_class_close(tb_class);
+        return 2;
+    }
+
+    uint64_t               num_values = 2 * tb_class->num_positions;
+    tb_compressed_header_t header     = {
+        .magic           = FILE_FORMAT_MAGIC_KEY,
+        .block_size      = TB_BLOCK_SIZE,
+        .num_tigers      = tb_class->material.num_tigers,
+        .num_goats       = tb_class->material.num_goats,
+        .num_eaten_goats = tb_class->material.num_eaten_goats,
+        .num_positions   = tb_class->num_positions,
+        .num_blocks      = (num_values + TB_BLOCK_SIZE - 1) / TB_BLOCK_SIZE
+    };
+
+    uint64_t *offsets = malloc((header.num_blocks + 1) * sizeof(uint64_t));
+    // A code has at most MAX_CODE_LENGTH bits.
+    uint8_t  *block   = malloc(sizeof(uint16_t) +
+                               TB_BLOCK_SIZE * (sizeof(uint16_t) + 1) +
+                               TB_BLOCK_SIZE * MAX_CODE_LENGTH / 8);
+    int16_t  *symbols_by_value = malloc((1 << 16) * sizeof(int16_t));
+    int      err = (offsets == NULL) || (block == NULL) ||
+                   (symbols_by_value == NULL) ? 3 : 0;
+
+    // The index is written again once the blocks are known.
+    if (!err) {
+        offsets[0] = sizeof(header) + (header.num_blocks + 1) * sizeof(uint64_t);
+    }
+    if (!err &&
+        ((fwrite(&header, sizeof(header), 1, f) != 1) ||
+         (fwrite(offsets, sizeof(uint64_t), header.num_blocks + 1, f) !=
+          header.num_blocks + 1))) {
+        err = 2;
+    }
+
+    // Values of the goats and tigers are contiguous in the raw file.
+    tb_value_t *values = tb_class->values[GOAT_TURN];
+    for (uint64_t b = 0; !err && b < header.num_blocks; b++) {
+        size_t size = encode_block(values + b * TB_BLOCK_SIZE,
+                                   block_num_values(num_values, b), block,
+                                   symbols_by_value);
+        if (fwrite(block, 1, size, f) != size) {
+            err = 2;
+        }
+        offsets[b + 1] = offsets[b] + size;
+    }
+
+    if (!err &&
+        ((fseek(f, sizeof(header), SEEK_SET) != 0) ||
+         (fwrite(offsets, sizeof(uint64_t), header.num_blocks + 1, f) !=
+          header.num_blocks + 1))) {
+        err = 2;
+    }
+
+    if ((fclose(f) != 0) && !err) {
+        err = 2;
+    }
+    if (!err && (rename(tmp, dst) != 0)) {
+        err = 2;
+    }
+
+    if (!err && (stats != NULL)) {
+        stats->raw_size        = tb_class->size;
+        stats->compressed_size = offsets[header.num_blocks];
+        stats->num_blocks      = header.num_blocks;
+    }
+
+    if (err) {
+        remove(tmp);
+    }
+    free(offsets);
+    free(block);
+    free(symbols_by_value);
+    tablebase_class_close(tb_class);
+    return err;
+}
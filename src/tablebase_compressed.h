@@ -0,0 +1,52 @@
+#ifndef __TABLEBASE_COMPRESSED_H__
+#define __TABLEBASE_COMPRESSED_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "tablebase.h"
+
+// A compressed material class stores the values of the positions in blocks of
+// TB_BLOCK_SIZE values, each of them Huffman coded on its own, and an index
+// of the blocks. A probe decodes the block of the position: the last decoded
+// blocks are kept in a small LRU cache since probes of a search are close to
+// each other.
+//
+// `tablebase_class_open` recognizes compressed files: they replace the raw
+// files in a tablebase directory.
+
+// TB_BLOCK_SIZE is the number of values of a block.
+#define TB_BLOCK_SIZE          2048
+
+// TB_CACHE_NUM_BLOCKS is the number of decoded blocks kept by a class.
+#define TB_CACHE_NUM_BLOCKS    64
+
+// tb_compressed_t is a compressed class mapped in memory.
+typedef struct tb_compressed tb_compressed_t;
+
+// tb_compressed_open reads the compressed class file mapped at `data`.
+// Returns NULL if it is not a valid compressed file.
+tb_compressed_t *tb_compressed_open(void *data, size_t size,
+                                    tb_material_t *material);
+void tb_compressed_close(tb_compressed_t *compressed);
+
+// tb_compressed_get returns the value of the position of the given index, or
+// TB_VALUE_INVALID if its block is corrupt.
+// It can be called from several threads.
+tb_value_t tb_compressed_get(tb_compressed_t *compressed, player_turn_t turn,
+                             uint64_t index);
+
+// tb_compress_stats_t sums up the compression of a class.
+typedef struct {
+    uint64_t raw_size; // Bytes.
+    uint64_t compressed_size;
+    uint64_t num_blocks;
+} tb_compress_stats_t;
+
+// tablebase_compress writes the raw class file `src` compressed to `dst`.
+// `dst` can be `src`: it is replaced once compressed.
+// Returns 0 on success.
+int tablebase_compress(const char *src, const char *dst,
+                       tb_compress_stats_t *stats);
+
+#endif
@@ -0,0 +1,1081 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tablebase_gen.h"
+
+// TB_VALUE_PENDING_WIN marks a position won by a tiger jump to the next
+// material class. Its distance to result is stored with it, but a faster win
+// within the class can still be found. It becomes a TB_VALUE_WIN once the
+// generation reaches its distance.
+#define TB_VALUE_PENDING_WIN    0xc000
+
+// A value of 0 (TB_VALUE_DRAW) marks positions which are not solved yet.
+#define TB_VALUE_UNKNOWN        TB_VALUE_DRAW
+
+// generator_t holds the state of the generation of a material class.
+//
+// `counters` stores, for each unsolved position, the number of movements
+// within the class which don't lead to a position won by the opponent yet.
+// When it reaches 0, the position is lost.
+typedef struct {
+    tb_material_t     material;
+    uint64_t          num_positions;
+    tb_value_t        *values[2];
+    uint8_t           *counters[2];
+    tablebase_class_t *next_class; // NULL if eating a goat wins the game.
+    int               layer;
+    int               last_layer;  // Highest distance to result seen so far.
+} generator_t;
+
+// worker_t is the part of the positions handled by a thread.
+typedef struct {
+    generator_t *gen;
+    uint64_t    begin;
+    uint64_t    end;
+} worker_t;
+
+
+static void update_last_layer(generator_t *gen, int layer) {
+    int last = __atomic_load_n(&gen->last_layer, __ATOMIC_RELAXED);
+
+    while (layer > last &&
+           !__atomic_compare_exchange_n(&gen->last_layer, &last, layer, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+
+// jump_value returns the value for goats of the position reached by a tiger
+// jump.
+static tb_value_t jump_value(tablebase_class_t *next_class, bitboard_t tigers,
+                             bitboard_t goats) {
+    if ((next_class == NULL) || bitboard_tigers_blocked(tigers, goats)) {
+        return TB_VALUE_LOSS;
+    }
+
+    return tablebase_class_get(next_class, GOAT_TURN, tigers, goats);
+}
+
+
+// jumps_summary goes through the tiger jumps of the position. `next_class` is
+// NULL if eating a goat wins the game.
+// `win` is set to the distance of the fastest jump which wins, or -1.
+// `loss` is set to the distance of the slowest jump which loses, or -1.
+// Returns true if one of the jumps leads to a draw.
+static bool jumps_summary(tablebase_class_t *next_class, bitboard_t tigers,
+                          bitboard_t goats, int *win, int *loss) {
+    bitboard_t empty = ~(tigers | goats) & BITBOARD_ALL;
+    bool       draw  = false;
+
+    *win  = -1;
+    *loss = -1;
+
+    for (bitboard_t t = tigers; t; t &= t - 1) {
+        int                         from = bitboard_first(t);
+        const bitboard_neighbours_t *n   = bitboard_neighbours(from);
+
+        for (int i = 0; i < n->num_jumps; i++) {
+            if (!bitboard_has(goats, n->jumps[i].over) ||
+                !bitboard_has(empty, n->jumps[i].to)) {
+                continue;
+            }
+
+            tb_value_t value = jump_value(next_class,
+                                          tigers ^ bitboard_cell(from) ^
+                                          bitboard_cell(n->jumps[i].to),
+                                          goats ^ bitboard_cell(n->jumps[i].over));
+            int dtr = tb_value_dtr(value) + 1;
+
+            switch (tb_value_result(value)) {
+            case TB_VALUE_LOSS:
+                if ((*win < 0) || (dtr < *win)) {
+                    *win = dtr;
+                }
+                break;
+
+            case TB_VALUE_WIN:
+                if (dtr > *loss) {
+                    *loss = dtr;
+                }
+                break;
+
+            default:
+                draw = true;
+            }
+        }
+    }
+
+    return draw;
+}
+
+
+// count_steps returns the number of steps the player can do.
+static int count_steps(bitboard_t movables, bitboard_t empty) {
+    int count = 0;
+
+    for (; movables; movables &= movables - 1) {
+        count += bitboard_count(bitboard_neighbours(bitboard_first(movables))->mask &
+                                empty);
+    }
+
+    return count;
+}
+
+
+// initial_value returns the value of a position which doesn't depend on the
+// other positions of the class, or TB_VALUE_UNKNOWN.
+// `num_steps` is set to the number of steps of the player, `draw` to true if
+// a tiger jump leads to a draw and `loss` to the distance of the slowest tiger
+// jump which loses (-1 if there is none).
+static tb_value_t initial_value(tablebase_class_t *next_class,
+                                player_turn_t turn, bitboard_t tigers,
+                                bitboard_t goats, int *num_steps, bool *draw,
+                                int *loss) {
+    bitboard_t empty = ~(tigers | goats) & BITBOARD_ALL;
+    int        win   = -1;
+
+    *num_steps = 0;
+    *draw      = false;
+    *loss      = -1;
+
+    if (bitboard_tigers_blocked(tigers, goats)) {
+        return TB_VALUE_LOSS;
+    }
+
+    *num_steps = count_steps(turn == TIGER_TURN ? tigers : goats, empty);
+    if (turn == TIGER_TURN) {
+        *draw = jumps_summary(next_class, tigers, goats, &win, loss);
+    }
+
+    if (win >= 0) {
+        return TB_VALUE_PENDING_WIN | win;
+    }
+    if ((*num_steps == 0) && !*draw) {
+        // Every movement loses (or there is none).
+        return TB_VALUE_LOSS | (*loss < 0 ? 0 : *loss);
+    }
+    return TB_VALUE_UNKNOWN;
+}
+
+
+// init_position sets the initial value and counter of a position.
+static void init_position(generator_t *gen, player_turn_t turn,
+                          uint64_t index) {
+    bitboard_t tigers, goats;
+    int        num_steps, loss;
+    bool       draw;
+
+    tablebase_position(gen->material, index, &tigers, &goats);
+
+    tb_value_t value = initial_value(gen->next_class, turn, tigers, goats,
+                                     &num_steps, &draw, &loss);
+
+    gen->values[turn][index]   = value;
+    gen->counters[turn][index] = 0;
+
+    if (value != TB_VALUE_UNKNOWN) {
+        update_last_layer(gen, tb_value_dtr(value));
+    } else {
+        // A jump to a draw means the position can never be lost: the counter
+        // cannot reach 0.
+        gen->counters[turn][index] = num_steps + (draw ? 1 : 0);
+    }
+}
+
+
+// mark_win marks the position as won in `dtr` movements, unless it is already
+// solved.
+static void mark_win(generator_t *gen, player_turn_t turn, uint64_t index,
+                     int dtr) {
+    tb_value_t *value   = &gen->values[turn][index];
+    tb_value_t current  = __atomic_load_n(value, __ATOMIC_RELAXED);
+    tb_value_t new_value = TB_VALUE_WIN | dtr;
+
+    while ((current == TB_VALUE_UNKNOWN) ||
+           ((tb_value_result(current) == TB_VALUE_PENDING_WIN) &&
+            (tb_value_dtr(current) > dtr))) {
+        if (__atomic_compare_exchange_n(value, &current, new_value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            update_last_layer(gen, dtr);
+            return;
+        }
+    }
+}
+
+
+// mark_loss marks the position as lost: all its steps lead to positions won
+// by the opponent, the last one in `dtr - 1` movements.
+static void mark_loss(generator_t *gen, player_turn_t turn, uint64_t index,
+                      bitboard_t tigers, bitboard_t goats, int dtr) {
+    if (turn == TIGER_TURN) {
+        // Jumps all lose too (otherwise the position would be won or could
+        // not be lost). The slowest one may be slower than the steps.
+        int win, loss;
+        jumps_summary(gen->next_class, tigers, goats, &win, &loss);
+        if (loss > dtr) {
+            dtr = loss;
+        }
+    }
+
+    tb_value_t expected = TB_VALUE_UNKNOWN;
+    if (__atomic_compare_exchange_n(&gen->values[turn][index], &expected,
+                                    TB_VALUE_LOSS | dtr, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        update_last_layer(gen, dtr);
+    }
+}
+
+
+// propagate updates the predecessors of a position solved at the current
+// layer. Predecessors are found by undoing a step of the other player: jumps
+// come from the previous material class.
+static void propagate(generator_t *gen, player_turn_t turn, uint64_t index,
+                      tb_value_t value) {
+    bitboard_t tigers, goats;
+
+    tablebase_position(gen->material, index, &tigers, &goats);
+
+    player_turn_t prev_turn = turn == TIGER_TURN ? GOAT_TURN : TIGER_TURN;
+    bitboard_t    empty     = ~(tigers | goats) & BITBOARD_ALL;
+    bitboard_t    movables  = prev_turn == TIGER_TURN ? tigers : goats;
+    int           dtr       = gen->layer + 1;
+
+    for (bitboard_t m = movables; m; m &= m - 1) {
+        int        to    = bitboard_first(m);
+        bitboard_t froms = bitboard_neighbours(to)->mask & empty;
+
+        for (; froms; froms &= froms - 1) {
+            bitboard_t step       = bitboard_cell(to) | bitboard_cell(bitboard_first(froms));
+            bitboard_t prev_tigers = prev_turn == TIGER_TURN ? tigers ^ step : tigers;
+            bitboard_t prev_goats  = prev_turn == GOAT_TURN ? goats ^ step : goats;
+            uint64_t   prev_index  = tablebase_index(gen->material, prev_tigers,
+                                                     prev_goats);
+
+            if (tb_value_result(value) == TB_VALUE_LOSS) {
+                mark_win(gen, prev_turn, prev_index, dtr);
+            } else if ((__atomic_sub_fetch(&gen->counters[prev_turn][prev_index],
+                                           1, __ATOMIC_RELAXED) == 0) &&
+                       (__atomic_load_n(&gen->values[prev_turn][prev_index],
+                                        __ATOMIC_RELAXED) == TB_VALUE_UNKNOWN)) {
+                mark_loss(gen, prev_turn, prev_index, prev_tigers, prev_goats,
+                          dtr);
+            }
+        }
+    }
+}
+
+
+static void *init_worker(void *w) {
+    worker_t *worker = w;
+
+    for (uint64_t i = worker->begin; i < worker->end; i++) {
+        init_position(worker->gen, GOAT_TURN, i);
+        init_position(worker->gen, TIGER_TURN, i);
+    }
+
+    return NULL;
+}
+
+
+// layer_worker propagates the positions solved at the current layer.
+static void *layer_worker(void *w) {
+    worker_t    *worker = w;
+    generator_t *gen    = worker->gen;
+    tb_value_t  pending = TB_VALUE_PENDING_WIN | gen->layer;
+    tb_value_t  win     = TB_VALUE_WIN | gen->layer;
+    tb_value_t  loss    = TB_VALUE_LOSS | gen->layer;
+
+    for (int turn = GOAT_TURN; turn <= TIGER_TURN; turn++) {
+        tb_value_t *values = gen->values[turn];
+
+        for (uint64_t i = worker->begin; i < worker->end; i++) {
+            tb_value_t value = __atomic_load_n(&values[i], __ATOMIC_RELAXED);
+
+            if (value == pending) {
+                // Nobody can find a faster win anymore.
+                __atomic_store_n(&values[i], win, __ATOMIC_RELAXED);
+                value = win;
+            }
+
+            if ((value == win) || (value == loss)) {
+                propagate(gen, turn, i, value);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+// run_workers runs `f` on `num_threads` threads, each of them on a part of the
+// positions. Returns 0 on success.
+static int run_workers(generator_t *gen, int num_threads, void *(*f)(void *)) {
+    pthread_t threads[num_threads];
+    worker_t  workers[num_threads];
+    int       num_started = 0;
+    int       err         = 0;
+
+    for (int i = 0; i < num_threads; i++) {
+        workers[i].gen   = gen;
+        workers[i].begin = gen->num_positions * i / num_threads;
+        workers[i].end   = gen->num_positions * (i + 1) / num_threads;
+
+        if (pthread_create(&threads[i], NULL, f, &workers[i]) != 0) {
+            err = 1;
+            break;
+        }
+        num_started++;
+    }
+
+    for (int i = 0; i < num_started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    return err;
+}
+
+
+static void compute_stats(generator_t *gen, tablebase_gen_stats_t *stats) {
+    memset(stats, 0, sizeof(tablebase_gen_stats_t));
+    stats->num_positions = 2 * gen->num_positions;
+
+    for (int turn = GOAT_TURN; turn <= TIGER_TURN; turn++) {
+        for (uint64_t i = 0; i < gen->num_positions; i++) {
+            tb_value_t value = gen->values[turn][i];
+
+            switch (tb_value_result(value)) {
+            case TB_VALUE_WIN:
+                stats->num_wins++;
+                break;
+
+            case TB_VALUE_LOSS:
+                stats->num_losses++;
+                break;
+
+            default:
+                stats->num_draws++;
+            }
+
+            if (tb_value_dtr(value) > stats->max_dtr) {
+                stats->max_dtr = tb_value_dtr(value);
+            }
+        }
+    }
+}
+
+
+static void free_generator(generator_t *gen) {
+    for (int turn = GOAT_TURN; turn <= TIGER_TURN; turn++) {
+        free(gen->values[turn]);
+        free(gen->counters[turn]);
+    }
+    tablebase_class_close(gen->next_class);
+}
+
+
+// See header.
+int tablebase_generate(tb_material_t material, const char *directory,
+                       int num_threads, tablebase_gen_stats_t *stats) {
+    generator_t gen;
+    char        filename[1024];
+
+    memset(&gen, 0, sizeof(gen));
+    gen.material      = material;
+    gen.num_positions = tablebase_num_positions(material);
+
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    if (material.num_eaten_goats + 1 < GOATS_EATEN_TO_WIN) {
+        tb_material_t next = material;
+        next.num_goats--;
+        next.num_eaten_goats++;
+
+        tablebase_filename(next, directory, filename, sizeof(filename));
+        gen.next_class = tablebase_class_open(filename);
+        if (gen.next_class == NULL) {
+            return 1;
+        }
+    }
+
+    for (int turn = GOAT_TURN; turn <= TIGER_TURN; turn++) {
+        gen.values[turn]   = malloc(gen.num_positions * sizeof(tb_value_t));
+        gen.counters[turn] = malloc(gen.num_positions * sizeof(uint8_t));
+        if ((gen.values[turn] == NULL) || (gen.counters[turn] == NULL)) {
+            free_generator(&gen);
+            return 2;
+        }
+    }
+
+    // Positions are unranked and ranked by every thread: make sure the
+    // neighbours tables exist before.
+    bitboard_neighbours(0);
+
+    if (run_workers(&gen, num_threads, init_worker)) {
+        free_generator(&gen);
+        return 3;
+    }
+
+    for (gen.layer = 0; gen.layer <= gen.last_layer; gen.layer++) {
+        if (run_workers(&gen, num_threads, layer_worker)) {
+            free_generator(&gen);
+            return 3;
+        }
+    }
+
+    if (stats != NULL) {
+        compute_stats(&gen, stats);
+    }
+
+    tablebase_filename(material, directory, filename, sizeof(filename));
+    int err = tablebase_class_write(filename, material, gen.values);
+    free_generator(&gen);
+
+    return err ? 4 : 0;
+}
+
+
+// Out-of-core generation.
+//
+// Each partition (the positions of the class for one player turn) is stored in
+// files next to the class file:
+//   <class file>.values.<turn>: tb_value_t of each position.
+//   <class file>.exits: for the tigers, what their jumps lead to (see
+//                       EXIT_DRAW), so that the next class is read only once.
+//   <class file>.bits.<turn>.<layer % 2>: 2 bits per position, set if the
+//                                         position is won (1) or lost (2)
+//                                         within `layer` movements.
+//   <class file>.state: the checkpoint (see checkpoint_t).
+//
+// Instead of propagating results backward, which needs random writes, every
+// layer solves the unsolved positions of a partition forward: a position is
+// won in `layer` movements if one of its steps leads to a position lost within
+// `layer - 1` movements, and lost if all of them lead to positions won within
+// `layer - 1` movements. Only the bits of the other partition are read at
+// random, so they are the only data kept in memory. The values of the
+// partition are streamed by chunks.
+//
+// Files are written under a temporary name and renamed, then the checkpoint is
+// updated: after a crash, the generation starts again from the partition it
+// was processing, which gives the same result when processed twice.
+
+#define CHECKPOINT_MAGIC_KEY    0x4b434342
+
+// EXIT_DRAW flags the tiger positions with a jump leading to a draw. The other
+// bits hold the distance of the slowest jump which loses.
+#define EXIT_DRAW               0x8000
+#define EXIT_LOSS_MASK          0x7fff
+
+// Positions whose bits fit in a bits word.
+#define POSITIONS_PER_WORD      32
+
+// MIN_CHUNK_SIZE is the minimum number of positions streamed at once.
+#define MIN_CHUNK_SIZE          4096
+
+// checkpoint_t is the progression of the generation of a class.
+// Steps 0 and 1 initialize the goat and tiger partitions, then step
+// 2 * layer + turn solves the positions of the partition at `layer`.
+typedef struct {
+    uint32_t magic;
+    int32_t  next_step;
+    int32_t  last_layer; // Highest distance to result seen so far.
+    int32_t  solved;     // All the partitions are solved.
+    uint64_t num_positions;
+} checkpoint_t;
+
+// disk_generator_t holds the state of an out-of-core generation.
+typedef struct {
+    tb_material_t     material;
+    uint64_t          num_positions;
+    tablebase_class_t *next_class; // NULL if eating a goat wins the game.
+    char              filename[1024];
+    uint64_t          chunk_size;
+    int               num_threads;
+} disk_generator_t;
+
+// disk_worker_t is the part of a chunk handled by a thread.
+typedef struct {
+    disk_generator_t *gen;
+    player_turn_t    turn;
+    int              layer;
+    uint64_t         first;      // Index of the first position of the chunk.
+    uint64_t         begin;      // Within the chunk.
+    uint64_t         end;
+    tb_value_t       *values;    // Values of the chunk.
+    uint16_t         *exits;     // Exits of the chunk, NULL for goats.
+    uint64_t         *opp_bits;  // Bits of the other partition.
+    uint64_t         *bits;      // Bits of the chunk.
+    int              last_layer; // Highest distance seen by the thread.
+} disk_worker_t;
+
+
+static uint64_t num_words(uint64_t num_positions) {
+    return (num_positions + POSITIONS_PER_WORD - 1) / POSITIONS_PER_WORD;
+}
+
+
+static int get_bits(uint64_t *bits, uint64_t index) {
+    return (bits[index / POSITIONS_PER_WORD] >>
+            (2 * (index % POSITIONS_PER_WORD))) & 3;
+}
+
+
+// work_filename writes the name of a file of the generation to `filename`.
+static void work_filename(disk_generator_t *gen, char *filename, size_t size,
+                          const char *suffix, int turn, int parity) {
+    if (strcmp(suffix, "values") == 0) {
+        snprintf(filename, size, "%s.values.%d", gen->filename, turn);
+    } else if (strcmp(suffix, "bits") == 0) {
+        snprintf(filename, size, "%s.bits.%d.%d", gen->filename, turn, parity);
+    } else {
+        snprintf(filename, size, "%s.%s", gen->filename, suffix);
+    }
+}
+
+
+// commit closes the temporary file `f` and renames it to `filename`.
+// Returns 0 on success.
+static int commit(FILE *f, const char *filename) {
+    char tmp[1100];
+
+    // A truncated name would be another file than the one opened.
+    bool truncated = snprintf(tmp, sizeof(tmp), "%s.tmp", filename) >=
+                     (int)sizeof(tmp);
+    if ((fclose(f) != 0) || truncated) {
+        return 1;
+    }
+    return rename(tmp, filename) == 0 ? 0 : 1;
+}
+
+
+// open_tmp opens the temporary file of `filename` for writing.
+// Returns NULL on failure.
+static FILE *open_tmp(const char *filename) {
+    char tmp[1100];
+
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", filename) >= (int)sizeof(tmp)) {
+        return NULL;
+    }
+    return fopen(tmp, "wb");
+}
+
+
+// init_disk_position returns the initial value of a position and sets its
+// exit.
+static tb_value_t init_disk_position(disk_generator_t *gen, player_turn_t turn,
+                                     uint64_t index, uint16_t *exit) {
+    bitboard_t tigers, goats;
+    int        num_steps, loss;
+    bool       draw;
+
+    tablebase_position(gen->material, index, &tigers, &goats);
+
+    tb_value_t value = initial_value(gen->next_class, turn, tigers, goats,
+                                     &num_steps, &draw, &loss);
+
+    if (exit != NULL) {
+        *exit = (draw ? EXIT_DRAW : 0) | (loss < 0 ? 0 : loss);
+    }
+    return value;
+}
+
+
+// solve_disk_position returns the value of a position at `layer` from the
+// bits of the other partition at `layer - 1`.
+static tb_value_t solve_disk_position(disk_generator_t *gen,
+                                      player_turn_t turn, int layer,
+                                      uint64_t index, tb_value_t value,
+                                      uint16_t exit, uint64_t *opp_bits) {
+    if ((tb_value_result(value) == TB_VALUE_WIN) ||
+        (tb_value_result(value) == TB_VALUE_LOSS)) {
+        return value;
+    }
+
+    if (value == (TB_VALUE_PENDING_WIN | layer)) {
+        // Nobody can find a faster win anymore.
+        return TB_VALUE_WIN | layer;
+    }
+
+    bitboard_t tigers, goats;
+    tablebase_position(gen->material, index, &tigers, &goats);
+
+    bitboard_t empty    = ~(tigers | goats) & BITBOARD_ALL;
+    bitboard_t movables = turn == TIGER_TURN ? tigers : goats;
+    bool       all_won  = true;
+
+    for (bitboard_t m = movables; m; m &= m - 1) {
+        int        from = bitboard_first(m);
+        bitboard_t tos  = bitboard_neighbours(from)->mask & empty;
+
+        for (; tos; tos &= tos - 1) {
+            bitboard_t step       = bitboard_cell(from) | bitboard_cell(bitboard_first(tos));
+            bitboard_t next_tigers = turn == TIGER_TURN ? tigers ^ step : tigers;
+            bitboard_t next_goats  = turn == GOAT_TURN ? goats ^ step : goats;
+            int        bits        = get_bits(opp_bits,
+                                              tablebase_index(gen->material,
+                                                              next_tigers,
+                                                              next_goats));
+
+            if (bits == 2) {
+                return TB_VALUE_WIN | layer;
+            }
+            all_won &= bits == 1;
+        }
+    }
+
+    if ((value == TB_VALUE_UNKNOWN) && all_won && !(exit & EXIT_DRAW)) {
+        // Jumps all lose too. The slowest one may be slower than the steps.
+        int dtr = exit & EXIT_LOSS_MASK;
+        return TB_VALUE_LOSS | (dtr > layer ? dtr : layer);
+    }
+
+    return value;
+}
+
+
+static void *disk_worker(void *w) {
+    disk_worker_t    *worker = w;
+    disk_generator_t *gen    = worker->gen;
+
+    worker->last_layer = -1;
+
+    for (uint64_t i = worker->begin; i < worker->end; i++) {
+        uint16_t   *exit = worker->exits != NULL ? &worker->exits[i] : NULL;
+        tb_value_t value;
+
+        if (worker->layer == 0) {
+            value = init_disk_position(gen, worker->turn, worker->first + i,
+                                       exit);
+        } else {
+            value = solve_disk_position(gen, worker->turn, worker->layer,
+                                        worker->first + i, worker->values[i],
+                                        exit != NULL ? *exit : 0,
+                                        worker->opp_bits);
+        }
+        worker->values[i] = value;
+
+        if (value == TB_VALUE_UNKNOWN) {
+            continue;
+        }
+
+        if (tb_value_dtr(value) > worker->last_layer) {
+            worker->last_layer = tb_value_dtr(value);
+        }
+
+        if ((tb_value_dtr(value) <= worker->layer) &&
+            (tb_value_result(value) != TB_VALUE_PENDING_WIN)) {
+            uint64_t bits = tb_value_result(value) == TB_VALUE_WIN ? 1 : 2;
+            worker->bits[i / POSITIONS_PER_WORD] |=
+                bits << (2 * (i % POSITIONS_PER_WORD));
+        }
+    }
+
+    return NULL;
+}
+
+
+// run_disk_workers processes a chunk of `size` positions on the threads of
+// the generator. `worker` holds the fields shared by the threads.
+// Returns 0 on success.
+static int run_disk_workers(disk_worker_t *worker, uint64_t size) {
+    int           num_threads = worker->gen->num_threads;
+    pthread_t     threads[num_threads];
+    disk_worker_t workers[num_threads];
+    uint64_t      num_chunk_words = num_words(size);
+    int           num_started     = 0;
+    int           err             = 0;
+
+    for (int i = 0; i < num_threads; i++) {
+        // Threads share no bits word.
+        workers[i]       = *worker;
+        workers[i].begin = num_chunk_words * i / num_threads * POSITIONS_PER_WORD;
+        workers[i].end   = num_chunk_words * (i + 1) / num_threads *
+                           POSITIONS_PER_WORD;
+        if (workers[i].end > size) {
+            workers[i].end = size;
+        }
+
+        if (pthread_create(&threads[i], NULL, disk_worker, &workers[i]) != 0) {
+            err = 1;
+            break;
+        }
+        num_started++;
+    }
+
+    for (int i = 0; i < num_started; i++) {
+        pthread_join(threads[i], NULL);
+        if (workers[i].last_layer > worker->last_layer) {
+            worker->last_layer = workers[i].last_layer;
+        }
+    }
+
+    return err;
+}
+
+
+// read_bits loads the bits of a partition.
+static uint64_t *read_bits(disk_generator_t *gen, player_turn_t turn,
+                           int parity) {
+    char     filename[1100];
+    uint64_t words = num_words(gen->num_positions);
+    uint64_t *bits = malloc(words * sizeof(uint64_t));
+
+    work_filename(gen, filename, sizeof(filename), "bits", turn, parity);
+    FILE *f = fopen(filename, "rb");
+
+    if ((bits == NULL) || (f == NULL) ||
+        (fread(bits, sizeof(uint64_t), words, f) != words)) {
+        free(bits);
+        bits = NULL;
+    }
+
+    if (f != NULL) {
+        fclose(f);
+    }
+    return bits;
+}
+
+
+// process_partition streams the partition of `turn` through the workers:
+// it initializes it if `layer` is 0 and solves it at `layer` otherwise.
+// `last_layer` is set to the highest distance to result of the partition.
+// Returns 0 on success or an error code of `tablebase_generate_out_of_core`.
+static int process_partition(disk_generator_t *gen, player_turn_t turn,
+                             int layer, int *last_layer) {
+    char          values_name[1100], exits_name[1100], bits_name[1100];
+    player_turn_t opp_turn  = turn == TIGER_TURN ? GOAT_TURN : TIGER_TURN;
+    bool          has_exits = turn == TIGER_TURN;
+    FILE          *in_values = NULL, *in_exits = NULL;
+    FILE          *out_values, *out_exits = NULL, *out_bits;
+    int           err = 0;
+
+    work_filename(gen, values_name, sizeof(values_name), "values", turn, 0);
+    work_filename(gen, exits_name, sizeof(exits_name), "exits", 0, 0);
+    work_filename(gen, bits_name, sizeof(bits_name), "bits", turn, layer % 2);
+
+    disk_worker_t worker = {
+        .gen        = gen,
+        .turn       = turn,
+        .layer      = layer,
+        .values     = malloc(gen->chunk_size * sizeof(tb_value_t)),
+        .exits      = has_exits ? malloc(gen->chunk_size * sizeof(uint16_t)) : NULL,
+        .bits       = malloc(num_words(gen->chunk_size) * sizeof(uint64_t)),
+        .opp_bits   = layer > 0 ? read_bits(gen, opp_turn, (layer - 1) % 2) : NULL,
+        .last_layer = -1
+    };
+
+    if ((worker.values == NULL) || (has_exits && (worker.exits == NULL)) ||
+        (worker.bits == NULL) || ((layer > 0) && (worker.opp_bits == NULL))) {
+        free(worker.values);
+        free(worker.exits);
+        free(worker.bits);
+        free(worker.opp_bits);
+        return layer > 0 && worker.opp_bits == NULL ? 4 : 2;
+    }
+
+    if (layer > 0) {
+        in_values = fopen(values_name, "rb");
+        in_exits  = has_exits ? fopen(exits_name, "rb") : NULL;
+    } else if (has_exits) {
+        out_exits = open_tmp(exits_name);
+    }
+    out_values = open_tmp(values_name);
+    out_bits   = open_tmp(bits_name);
+
+    if (((layer > 0) && (in_values == NULL)) ||
+        ((layer > 0) && has_exits && (in_exits == NULL)) ||
+        ((layer == 0) && has_exits && (out_exits == NULL)) ||
+        (out_values == NULL) || (out_bits == NULL)) {
+        err = 4;
+    }
+
+    for (uint64_t first = 0; !err && first < gen->num_positions;
+         first += gen->chunk_size) {
+        uint64_t size = gen->num_positions - first;
+        if (size > gen->chunk_size) {
+            size = gen->chunk_size;
+        }
+        uint64_t words = num_words(size);
+
+        if ((layer > 0) &&
+            ((fread(worker.values, sizeof(tb_value_t), size, in_values) != size) ||
+             (has_exits &&
+              (fread(worker.exits, sizeof(uint16_t), size, in_exits) != size)))) {
+            err = 4;
+            break;
+        }
+
+        memset(worker.bits, 0, words * sizeof(uint64_t));
+        worker.first = first;
+        if (run_disk_workers(&worker, size)) {
+            err = 3;
+            break;
+        }
+
+        if ((fwrite(worker.values, sizeof(tb_value_t), size, out_values) != size) ||
+            ((out_exits != NULL) &&
+             (fwrite(worker.exits, sizeof(uint16_t), size, out_exits) != size)) ||
+            (fwrite(worker.bits, sizeof(uint64_t), words, out_bits) != words)) {
+            err = 4;
+        }
+    }
+
+    if (in_values != NULL) {
+        fclose(in_values);
+    }
+    if (in_exits != NULL) {
+        fclose(in_exits);
+    }
+
+    // The values are committed last: they are the input of the next run if
+    // this one is interrupted.
+    if (!err && (((out_exits != NULL) && commit(out_exits, exits_name)) ||
+                 commit(out_bits, bits_name) ||
+                 commit(out_values, values_name))) {
+        err = 4;
+    } else if (err) {
+        if (out_exits != NULL) {
+            fclose(out_exits);
+        }
+        if (out_bits != NULL) {
+            fclose(out_bits);
+        }
+        if (out_values != NULL) {
+            fclose(out_values);
+        }
+    }
+
+    free(worker.values);
+    free(worker.exits);
+    free(worker.bits);
+    free(worker.opp_bits);
+
+    *last_layer = worker.last_layer;
+    return err;
+}
+
+
+static int write_checkpoint(disk_generator_t *gen, checkpoint_t *checkpoint) {
+    char filename[1100];
+
+    work_filename(gen, filename, sizeof(filename), "state", 0, 0);
+    FILE *f = open_tmp(filename);
+
+    if (f == NULL) {
+        return 4;
+    }
+    if (fwrite(checkpoint, sizeof(checkpoint_t), 1, f) != 1) {
+        fclose(f);
+        return 4;
+    }
+    return commit(f, filename) ? 4 : 0;
+}
+
+
+// read_checkpoint loads the checkpoint of a previous run, or initializes it.
+static void read_checkpoint(disk_generator_t *gen, checkpoint_t *checkpoint) {
+    char filename[1100];
+
+    work_filename(gen, filename, sizeof(filename), "state", 0, 0);
+    FILE *f = fopen(filename, "rb");
+
+    if ((f == NULL) ||
+        (fread(checkpoint, sizeof(checkpoint_t), 1, f) != 1) ||
+        (checkpoint->magic != CHECKPOINT_MAGIC_KEY) ||
+        (checkpoint->num_positions != gen->num_positions)) {
+        memset(checkpoint, 0, sizeof(checkpoint_t));
+        checkpoint->magic         = CHECKPOINT_MAGIC_KEY;
+        checkpoint->last_layer    = -1;
+        checkpoint->num_positions = gen->num_positions;
+    }
+
+    if (f != NULL) {
+        fclose(f);
+    }
+}
+
+
+static void add_stats(tablebase_gen_stats_t *stats, tb_value_t *values,
+                      uint64_t size) {
+    for (uint64_t i = 0; i < size; i++) {
+        switch (tb_value_result(values[i])) {
+        case TB_VALUE_WIN:
+            stats->num_wins++;
+            break;
+
+        case TB_VALUE_LOSS:
+            stats->num_losses++;
+            break;
+
+        default:
+            stats->num_draws++;
+        }
+
+        if (tb_value_dtr(values[i]) > stats->max_dtr) {
+            stats->max_dtr = tb_value_dtr(values[i]);
+        }
+    }
+}
+
+
+// write_class writes the class file from the values of both partitions and
+// removes the files of the generation.
+static int write_class(disk_generator_t *gen, tablebase_gen_stats_t *stats) {
+    char       filename[1100];
+    tb_value_t *chunk = malloc(gen->chunk_size * sizeof(tb_value_t));
+    FILE       *out   = open_tmp(gen->filename);
+    int        err    = (chunk == NULL) ? 2 : (out == NULL) ? 4 : 0;
+
+    memset(stats, 0, sizeof(tablebase_gen_stats_t));
+    stats->num_positions = 2 * gen->num_positions;
+
+    if (!err && tablebase_class_write_header(out, gen->material)) {
+        err = 4;
+    }
+
+    for (int turn = GOAT_TURN; !err && turn <= TIGER_TURN; turn++) {
+        work_filename(gen, filename, sizeof(filename), "values", turn, 0);
+        FILE *in = fopen(filename, "rb");
+
+        for (uint64_t first = 0; in != NULL && first < gen->num_positions;
+             first += gen->chunk_size) {
+            uint64_t size = gen->num_positions - first;
+            if (size > gen->chunk_size) {
+                size = gen->chunk_size;
+            }
+
+            if ((fread(chunk, sizeof(tb_value_t), size, in) != size) ||
+                (fwrite(chunk, sizeof(tb_value_t), size, out) != size)) {
+                err = 4;
+                break;
+            }
+            add_stats(stats, chunk, size);
+        }
+
+        if (in == NULL) {
+            err = 4;
+        } else {
+            fclose(in);
+        }
+    }
+
+    free(chunk);
+    if (out != NULL) {
+        if (err) {
+            fclose(out);
+        } else if (commit(out, gen->filename)) {
+            err = 4;
+        }
+    }
+    if (err) {
+        return err;
+    }
+
+    // The checkpoint first: the other files are useless without it.
+    work_filename(gen, filename, sizeof(filename), "state", 0, 0);
+    remove(filename);
+    for (int turn = GOAT_TURN; turn <= TIGER_TURN; turn++) {
+        work_filename(gen, filename, sizeof(filename), "values", turn, 0);
+        remove(filename);
+        for (int parity = 0; parity < 2; parity++) {
+            work_filename(gen, filename, sizeof(filename), "bits", turn, parity);
+            remove(filename);
+        }
+    }
+    work_filename(gen, filename, sizeof(filename), "exits", 0, 0);
+    remove(filename);
+
+    return 0;
+}
+
+
+// See header.
+int tablebase_generate_out_of_core(tb_material_t material,
+                                   const char *directory, int num_threads,
+                                   size_t memory_cap, int max_partitions,
+                                   tablebase_gen_stats_t *stats) {
+    disk_generator_t gen;
+    checkpoint_t     checkpoint;
+    char             filename[1024];
+
+    memset(&gen, 0, sizeof(gen));
+    gen.material      = material;
+    gen.num_positions = tablebase_num_positions(material);
+    gen.num_threads   = num_threads < 1 ? 1 : num_threads;
+    tablebase_filename(material, directory, gen.filename, sizeof(gen.filename));
+
+    // The bits of the other partition stay in memory. Each position of a chunk
+    // takes a value, an exit and 2 bits.
+    uint64_t bits_size = num_words(gen.num_positions) * sizeof(uint64_t);
+    if (memory_cap <= bits_size) {
+        return 5;
+    }
+    gen.chunk_size = (memory_cap - bits_size) * 4 /
+                     (4 * (sizeof(tb_value_t) + sizeof(uint16_t)) + 1);
+    gen.chunk_size -= gen.chunk_size % POSITIONS_PER_WORD;
+    if (gen.chunk_size > num_words(gen.num_positions) * POSITIONS_PER_WORD) {
+        gen.chunk_size = num_words(gen.num_positions) * POSITIONS_PER_WORD;
+    }
+    if ((gen.chunk_size < MIN_CHUNK_SIZE) &&
+        (gen.chunk_size < gen.num_positions)) {
+        return 5;
+    }
+
+    if (material.num_eaten_goats + 1 < GOATS_EATEN_TO_WIN) {
+        tb_material_t next = material;
+        next.num_goats--;
+        next.num_eaten_goats++;
+
+        // The next class is only read when initializing the tiger partition.
+        // It is mapped: its pages are managed by the kernel.
+        tablebase_filename(next, directory, filename, sizeof(filename));
+        gen.next_class = tablebase_class_open(filename);
+        if (gen.next_class == NULL) {
+            return 1;
+        }
+    }
+
+    // Positions are unranked and ranked by every thread: make sure the
+    // neighbours tables exist before.
+    bitboard_neighbours(0);
+
+    read_checkpoint(&gen, &checkpoint);
+
+    int err = 0;
+    for (int n = 0; !err && !checkpoint.solved; n++) {
+        if ((max_partitions > 0) && (n >= max_partitions)) {
+            tablebase_class_close(gen.next_class);
+            return 6;
+        }
+
+        int           step  = checkpoint.next_step;
+        int           layer = step / 2;
+        player_turn_t turn  = step % 2;
+        int           last_layer;
+
+        err = process_partition(&gen, turn, layer, &last_layer);
+        if (err) {
+            break;
+        }
+
+        if (last_layer > checkpoint.last_layer) {
+            checkpoint.last_layer = last_layer;
+        }
+        checkpoint.next_step++;
+        // Positions solved at this layer can only solve others at the next.
+        checkpoint.solved = (turn == TIGER_TURN) &&
+                            (checkpoint.last_layer < layer);
+        err = write_checkpoint(&gen, &checkpoint);
+    }
+
+    tablebase_class_close(gen.next_class);
+    if (err) {
+        return err;
+    }
+
+    tablebase_gen_stats_t local_stats;
+    return write_class(&gen, stats != NULL ? stats : &local_stats);
+}
@@ -0,0 +1,53 @@
+#ifndef __TABLEBASE_GEN_H__
+#define __TABLEBASE_GEN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tablebase.h"
+
+// tablebase_gen_stats_t sums up a generated material class.
+typedef struct {
+    uint64_t num_positions; // For both player turns.
+    uint64_t num_wins;
+    uint64_t num_losses;
+    uint64_t num_draws;
+    int      max_dtr;
+} tablebase_gen_stats_t;
+
+// tablebase_generate solves every position of the material class by
+// retrograde analysis and writes the result in `directory`.
+//
+// Positions which are done are lost for the player who has to play. Then, the
+// results are propagated backward, one distance to result at a time: the
+// positions which can move to a lost position are won, the positions which can
+// only move to won positions are lost. The positions left are draws.
+//
+// Tiger jumps lead to the class with one goat less. Its file must have been
+// generated in `directory` first, unless tigers win by eating this goat.
+//
+// The work is split over `num_threads` threads.
+// Returns 0 on success.
+int tablebase_generate(tb_material_t material, const char *directory,
+                       int num_threads, tablebase_gen_stats_t *stats);
+
+// tablebase_generate_out_of_core generates the same file as
+// `tablebase_generate` for classes which don't fit in memory.
+//
+// The positions are partitioned by player turn and each partition is stored in
+// files in `directory`. Partitions are processed one after the other by
+// reading and writing their files sequentially, and the memory used stays
+// below `memory_cap` bytes (the next class file is mapped and not counted).
+//
+// After `max_partitions` partitions (0 for no limit), or if the process is
+// stopped, the generation can be resumed by calling the function again: it
+// starts from the last partition completed.
+//
+// Returns 0 on success, 5 if `memory_cap` is too small for the class and 6 if
+// the generation stopped after `max_partitions` partitions.
+int tablebase_generate_out_of_core(tb_material_t material,
+                                   const char *directory, int num_threads,
+                                   size_t memory_cap, int max_partitions,
+                                   tablebase_gen_stats_t *stats);
+
+#endif
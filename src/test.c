@@ -1,6 +1,11 @@
 #include "test.h"
+#include "perf_counters.h"
 
+#include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 static void test_run_individual(test_t *t, test_function_t test_function) {
     test_function.f(t);
@@ -34,3 +39,271 @@ int test_run(test_function_t test_functions[], size_t num_tests) {
 
     return test.failed;
 }
+
+
+// BENCH_SAMPLE_TIME is the minimal duration of a sample, in seconds: the
+// number of iterations is raised until a sample takes it.
+#define BENCH_SAMPLE_TIME    0.01
+
+// BENCH_NUM_WARMUPS is the number of samples run and discarded once the
+// number of iterations is set.
+#define BENCH_NUM_WARMUPS    3
+
+#define BENCH_NUM_SAMPLES    21
+
+// bench_sink receives the results of the benchmarks, so that their work is
+// not optimized away.
+static volatile double bench_sink;
+
+// bench_baseline_t is the median time of a benchmark in a baseline file.
+typedef struct {
+    char   name[TEST_FUNCTION_NAME_MAX_SIZE];
+    double median;
+} bench_baseline_t;
+
+// BENCH_MAX_BASELINES is the maximum number of benchmarks of a baseline file.
+#define BENCH_MAX_BASELINES    256
+
+
+// bench_time returns the time taken by `num_iterations` iterations of the
+// benchmark, in seconds.
+static double bench_time(bench_function_t bench_function, long num_iterations) {
+    bench_t         b = { num_iterations, 0 };
+    struct timespec begin, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    bench_function.f(&b);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    bench_sink += b.result;
+    return (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) * 1e-9;
+}
+
+
+// bench_num_iterations returns the number of iterations of a sample of the
+// benchmark. Finding it warms the benchmark up.
+static long bench_num_iterations(bench_function_t bench_function) {
+    long num_iterations = 1;
+
+    for (;;) {
+        double time = bench_time(bench_function, num_iterations);
+        if (time >= BENCH_SAMPLE_TIME) {
+            break;
+        }
+
+        // Aims a bit over the sample time, without growing too fast on
+        // operations too short to be timed.
+        long next = time > 0 ?
+                    (long)(num_iterations * BENCH_SAMPLE_TIME * 1.2 / time) :
+                    num_iterations * 100;
+        if (next > num_iterations * 100) {
+            next = num_iterations * 100;
+        }
+        num_iterations = next > num_iterations ? next : num_iterations + 1;
+    }
+
+    for (int i = 0; i < BENCH_NUM_WARMUPS; i++) {
+        bench_time(bench_function, num_iterations);
+    }
+
+    return num_iterations;
+}
+
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+// format_time writes the duration `time` (in seconds) with its unit to `str`.
+static void format_time(double time, char *str, size_t size) {
+    if (time < 1e-6) {
+        snprintf(str, size, "%.1f ns", time * 1e9);
+    } else if (time < 1e-3) {
+        snprintf(str, size, "%.2f us", time * 1e6);
+    } else if (time < 1) {
+        snprintf(str, size, "%.2f ms", time * 1e3);
+    } else {
+        snprintf(str, size, "%.2f s", time);
+    }
+}
+
+
+// bench_load reads the baseline file `filename`.
+// Returns the number of benchmarks read, -1 if the file can't be read.
+static int bench_load(char *filename, bench_baseline_t *baselines) {
+    FILE *f = fopen(filename, "r");
+    int  num_baselines = 0;
+
+    if (f == NULL) {
+        return -1;
+    }
+
+    while ((num_baselines < BENCH_MAX_BASELINES) &&
+           (fscanf(f, "%255s %lf", baselines[num_baselines].name,
+                   &baselines[num_baselines].median) == 2)) {
+        num_baselines++;
+    }
+
+    fclose(f);
+    return num_baselines;
+}
+
+
+// bench_run_individual runs the benchmark, prints its times and, if it has a
+// baseline, compares them to it. With `counters`, the hardware counters of the
+// samples are printed too.
+// Returns its median time per operation and sets `regressed`.
+static double bench_run_individual(bench_function_t bench_function,
+                                   bench_baseline_t *baseline, int threshold,
+                                   perf_counters_t *counters, bool *regressed) {
+    double        samples[BENCH_NUM_SAMPLES];
+    char          median_str[32], p90_str[32], min_str[32];
+    char          counts_str[PERF_COUNTS_LEN];
+    perf_counts_t counts;
+    long          num_iterations = bench_num_iterations(bench_function);
+
+    perf_counts_clear(&counts);
+    for (int i = 0; i < BENCH_NUM_SAMPLES; i++) {
+        if (counters != NULL) {
+            perf_counters_start(counters);
+        }
+        samples[i] = bench_time(bench_function, num_iterations) / num_iterations;
+        if (counters != NULL) {
+            perf_counters_stop(counters, &counts);
+        }
+    }
+    qsort(samples, BENCH_NUM_SAMPLES, sizeof(double), compare_doubles);
+
+    double median = samples[BENCH_NUM_SAMPLES / 2];
+    format_time(median, median_str, sizeof(median_str));
+    format_time(samples[BENCH_NUM_SAMPLES * 9 / 10], p90_str, sizeof(p90_str));
+    format_time(samples[0], min_str, sizeof(min_str));
+
+    printf("\x1b[1;36m[BENCH]\x1b[0m %-32s median %10s  p90 %10s  min %10s  "
+           "%12.0f ops/s", bench_function.name, median_str, p90_str, min_str,
+           1 / median);
+
+    *regressed = false;
+    if (baseline != NULL) {
+        double change = (median / baseline->median - 1) * 100;
+        *regressed = change > threshold;
+        printf("  %+6.1f%%%s", change,
+               *regressed ? " \x1b[1;31m[REGRESSED]\x1b[0m" : "");
+    }
+    printf("\n");
+
+    perf_counts_format(&counts, (uint64_t)num_iterations * BENCH_NUM_SAMPLES,
+                       "op", counts_str);
+    if (counts_str[0] != '\0') {
+        printf("%-40s %s\n", "", counts_str);
+    }
+
+    return median;
+}
+
+
+int bench_main(int argc, char **argv, bench_function_t bench_functions[],
+               size_t num_benchs) {
+    bench_baseline_t baselines[BENCH_MAX_BASELINES];
+    int              num_baselines   = 0;
+    bool             run             = false;
+    char             *output         = NULL;
+    char             *compare        = NULL;
+    int              threshold       = BENCH_DEFAULT_THRESHOLD;
+    int              num_regressions = 0;
+    bool             count           = false;
+    perf_counters_t  counters;
+    int              opt;
+
+    while ((opt = getopt(argc, argv, "bo:c:t:p")) != -1) {
+        switch (opt) {
+        case 'b':
+            run = true;
+            break;
+
+        case 'o':
+            run    = true;
+            output = optarg;
+            break;
+
+        case 'c':
+            run     = true;
+            compare = optarg;
+            break;
+
+        case 't':
+            threshold = atoi(optarg);
+            break;
+
+        case 'p':
+            count = true;
+            break;
+
+        default:
+            printf("Usage: %s [-b] [-o baseline] [-c baseline] [-t threshold] "
+                   "[-p]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!run) {
+        return -1;
+    }
+
+    if (compare != NULL) {
+        num_baselines = bench_load(compare, baselines);
+        if (num_baselines < 0) {
+            printf("Can't read the baseline %s.\n", compare);
+            return 1;
+        }
+    }
+
+    FILE *f = NULL;
+    if ((output != NULL) && ((f = fopen(output, "w")) == NULL)) {
+        printf("Can't write the baseline %s.\n", output);
+        return 1;
+    }
+
+    if (count && (perf_counters_open(&counters) == 0)) {
+        printf("Hardware counters unavailable, only times are measured.\n");
+        count = false;
+    }
+
+    for (int i = 0; i < num_benchs; i++) {
+        bench_baseline_t *baseline = NULL;
+        bool             regressed;
+
+        for (int j = 0; j < num_baselines; j++) {
+            if (!strcmp(baselines[j].name, bench_functions[i].name)) {
+                baseline = &baselines[j];
+            }
+        }
+
+        double median = bench_run_individual(bench_functions[i], baseline,
+                                             threshold,
+                                             count ? &counters : NULL,
+                                             &regressed);
+        num_regressions += regressed;
+        if (f != NULL) {
+            fprintf(f, "%s %.9e\n", bench_functions[i].name, median);
+        }
+    }
+
+    if (f != NULL) {
+        fclose(f);
+    }
+    if (count) {
+        perf_counters_close(&counters);
+    }
+
+    if (num_regressions > 0) {
+        printf("\n\x1b[31m%d regressed by more than %d%%.\x1b[0m\n",
+               num_regressions, threshold);
+    }
+
+    return num_regressions > 0;
+}
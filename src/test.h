@@ -31,4 +31,42 @@ int test_run(test_function_t test_functions[], size_t num_tests);
 // TEST_FUNCTION defines the function structure.
 #define TEST_FUNCTION(f)    { f, # f }
 
+// bench_t represents the state of a benchmark. A benchmark function does the
+// operation it measures `num_iterations` times. Results the compiler could
+// optimize away are added to `result`.
+typedef struct {
+    long   num_iterations;
+    double result;
+} bench_t;
+
+// bench_function_t stores a pointer to a benchmark function and its name, like
+// `test_function_t`.
+typedef struct {
+    void (*f)(bench_t * b);
+    char name[TEST_FUNCTION_NAME_MAX_SIZE];
+} bench_function_t;
+
+// BENCH_FUNCTION defines the benchmark function structure.
+#define BENCH_FUNCTION(f)    { f, # f }
+
+// BENCH_DEFAULT_THRESHOLD is the slowdown, in percents, over which a benchmark
+// is reported as a regression.
+#define BENCH_DEFAULT_THRESHOLD    10
+
+// bench_main runs the benchmarks if the arguments of the test binary ask for
+// it:
+//   -b             runs them,
+//   -o file        runs them and writes their median times to the file,
+//   -c file        runs them and compares them to a file written by -o,
+//   -t threshold   sets the slowdown of -c in percents (default 10),
+//   -p             also reads the hardware counters (see `perf_counters.h`).
+// Each benchmark is warmed up, then timed over samples on a monotonic clock;
+// its median, 90th percentile and minimum time per operation and its
+// operations per second are printed. With -p, so are the instructions per
+// cycle and the cache and branch misses per operation, if available.
+// Returns -1 if benchmarks are not asked for, 1 if the arguments are wrong or
+// a benchmark regressed, 0 otherwise.
+int bench_main(int argc, char **argv, bench_function_t bench_functions[],
+               size_t num_benchs);
+
 #endif
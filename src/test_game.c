@@ -1,9 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "test.h"
+#include "alloc_stats.h"
 #include "game.h"
 #include "ai_rand.h"
+#include "notation.h"
 #include "tools.h"
 
 static bool board_equals(board_t *b1, board_t *b2) {
@@ -333,7 +336,7 @@ static void test_ai_rand(test_t *t) {
 
 
     ai_rand_callbacks.free(ai);
-    free(game);
+    game_free(game);
 }
 
 
@@ -366,7 +369,476 @@ static void test_undo(test_t *t) {
         test_fail(t);
     }
 
-    free(game);
+    game_free(game);
+}
+
+
+static void test_get_mvts(test_t *t) {
+    game_t *game = game_new();
+
+    for (int num_mvt = 0; (num_mvt < 200) && !game_is_done(game); num_mvt++) {
+        mvt_t                mvts[GAME_MAX_NUM_MVTS];
+        possible_positions_t possible_from;
+        int                  num_mvts = game_get_mvts(game, mvts);
+
+        // Every movable token has a movement.
+        game_get_possible_from_positions(game, &possible_from);
+        if (num_mvts < possible_positions_count(&possible_from)) {
+            printf("%s:%d: %d movements for %d movable tokens\n",
+                   __FILE__, __LINE__, num_mvts,
+                   possible_positions_count(&possible_from));
+            test_fail(t);
+        }
+
+        for (int i = 0; i < num_mvts; i++) {
+            if (!game_do_mvt(game, mvts[i])) {
+                printf("%s:%d: Movement %d refused: ", __FILE__, __LINE__, i);
+                print_mvt(mvts[i]);
+                puts("");
+                test_fail(t);
+                continue;
+            }
+            game_undo(game);
+        }
+
+        game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+    }
+
+    game_free(game);
+}
+
+
+static void test_apply_legal_mvt(test_t *t) {
+    game_t *game    = game_new();
+    game_t *checked = game_new();
+
+    for (int num_mvt = 0; (num_mvt < 200) && !game_is_done(game); num_mvt++) {
+        mvt_t  mvts[GAME_MAX_NUM_MVTS];
+        game_t before   = *game;
+        int    num_mvts = game_get_mvts(game, mvts);
+
+        for (int i = 0; i < num_mvts; i++) {
+            checked->board            = game->board;
+            checked->turn             = game->turn;
+            checked->num_goats_to_put = game->num_goats_to_put;
+            checked->num_eaten_goats  = game->num_eaten_goats;
+            game_update_status(checked);
+            game_do_mvt(checked, mvts[i]);
+
+            int eaten_goat = game_apply_legal_mvt(game, mvts[i]);
+            if (!game_equals(game, checked)) {
+                printf("%s:%d: Movement %d applied differently: ", __FILE__,
+                       __LINE__, i);
+                print_mvt(mvts[i]);
+                puts("");
+                test_fail(t);
+            }
+            game_undo(checked);
+
+            game_unapply_legal_mvt(game, mvts[i], eaten_goat);
+            if (!game_equals(game, &before)) {
+                printf("%s:%d: Movement %d badly unapplied\n", __FILE__,
+                       __LINE__, i);
+                test_fail(t);
+            }
+        }
+
+        game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+    }
+
+    game_free(game);
+    game_free(checked);
+}
+
+
+static void test_movable_tigers(test_t *t) {
+    game_t *game = game_new();
+
+    for (int num_mvt = 0; num_mvt < 200; num_mvt++) {
+        possible_positions_t possible_from;
+        player_turn_t        turn = game->turn;
+
+        // The possible positions of tigers are computed from the board.
+        game->turn = TIGER_TURN;
+        game_get_possible_from_positions(game, &possible_from);
+        game->turn = turn;
+
+        int expected = possible_positions_count(&possible_from);
+        if (game_count_num_movable_tigers(game) != expected) {
+            printf("%s:%d: %d movable tigers instead of %d\n", __FILE__,
+                   __LINE__, game_count_num_movable_tigers(game), expected);
+            test_fail(t);
+        }
+
+        if (game_is_done(game) !=
+            ((expected == 0) || (game->num_eaten_goats >= GOATS_EATEN_TO_WIN))) {
+            printf("%s:%d: game_is_done is wrong\n", __FILE__, __LINE__);
+            test_fail(t);
+        }
+
+        if (game_is_done(game)) {
+            // Undoing a few movements checks the tracking backwards.
+            for (int i = 0; i < 5; i++) {
+                game_undo(game);
+            }
+        }
+
+        game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+    }
+
+    game_free(game);
+}
+
+
+// expected_features computes the features of the game from the possible
+// positions of the tigers.
+static game_features_t expected_features(game_t *game) {
+    game_features_t      features = { .num_eaten_goats = game->num_eaten_goats };
+    player_turn_t        turn     = game->turn;
+    possible_positions_t possible_to;
+    bool                 threatened[5 * 5] = { false };
+    position_t           from, to;
+
+    game->turn = TIGER_TURN;
+    for (from.r = 0; from.r < 5; from.r++) {
+        for (from.c = 0; from.c < 5; from.c++) {
+            if (board_get_cell(&game->board, from) != TIGER_CELL) {
+                continue;
+            }
+
+            features.num_tigers_on_diagonals += position_has_diagonal(from);
+
+            game_get_possible_to_positions(game, from, &possible_to);
+            int num_mvts = possible_positions_count(&possible_to);
+            features.tiger_mobility     += num_mvts;
+            features.num_movable_tigers += num_mvts > 0;
+
+            for (to.r = 0; to.r < 5; to.r++) {
+                for (to.c = 0; to.c < 5; to.c++) {
+                    if (is_position_possible(&possible_to, to) &&
+                        ((abs(to.c - from.c) == 2) || (abs(to.r - from.r) == 2))) {
+                        threatened[(to.r + from.r) / 2 * 5 + (to.c + from.c) / 2] = true;
+                    }
+                }
+            }
+        }
+    }
+    game->turn = turn;
+
+    for (int i = 0; i < 5 * 5; i++) {
+        features.num_threatened_goats += threatened[i];
+    }
+
+    return features;
+}
+
+
+static void test_features(test_t *t) {
+    game_t *game = game_new();
+
+    for (int num_mvt = 0; (num_mvt < 200) && !game_is_done(game); num_mvt++) {
+        game_features_t got      = game_get_features(game);
+        game_features_t expected = expected_features(game);
+
+        if (memcmp(&got, &expected, sizeof(game_features_t))) {
+            printf("%s:%d: Movement %d: features (%d, %d, %d, %d, %d) instead "
+                   "of (%d, %d, %d, %d, %d)\n", __FILE__, __LINE__, num_mvt,
+                   got.num_eaten_goats, got.num_tigers_on_diagonals,
+                   got.num_movable_tigers, got.tiger_mobility,
+                   got.num_threatened_goats, expected.num_eaten_goats,
+                   expected.num_tigers_on_diagonals,
+                   expected.num_movable_tigers, expected.tiger_mobility,
+                   expected.num_threatened_goats);
+            test_fail(t);
+        }
+
+        game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+    }
+
+    game_free(game);
+}
+
+
+// tiger_can_eat returns true if a tiger can eat the goat on `goat`.
+static bool tiger_can_eat(game_t *game, position_t goat, bitboard_t *landing) {
+    player_turn_t        turn    = game->turn;
+    bool                 can_eat = false;
+    possible_positions_t possible_to;
+    position_t           from, to;
+
+    game->turn = TIGER_TURN;
+    for (from.r = 0; from.r < 5; from.r++) {
+        for (from.c = 0; from.c < 5; from.c++) {
+            if (board_get_cell(&game->board, from) != TIGER_CELL) {
+                continue;
+            }
+
+            game_get_possible_to_positions(game, from, &possible_to);
+            for (to.r = 0; to.r < 5; to.r++) {
+                for (to.c = 0; to.c < 5; to.c++) {
+                    if (is_position_possible(&possible_to, to) &&
+                        ((abs(to.c - from.c) == 2) || (abs(to.r - from.r) == 2)) &&
+                        ((to.c + from.c) / 2 == goat.c) &&
+                        ((to.r + from.r) / 2 == goat.r)) {
+                        can_eat   = true;
+                        *landing |= bitboard_cell(to.r * 5 + to.c);
+                    }
+                }
+            }
+        }
+    }
+    game->turn = turn;
+
+    return can_eat;
+}
+
+
+static void test_threats(test_t *t) {
+    game_t *game = game_new();
+
+    for (int num_mvt = 0; (num_mvt < 200) && !game_is_done(game); num_mvt++) {
+        game_threats_t threats;
+        game_threats_t expected = { 0, 0, 0 };
+        position_t     pos;
+
+        game_get_threats(game, &threats);
+
+        for (pos.r = 0; pos.r < 5; pos.r++) {
+            for (pos.c = 0; pos.c < 5; pos.c++) {
+                bitboard_t   cell  = bitboard_cell(pos.r * 5 + pos.c);
+                cell_state_t state = board_get_cell(&game->board, pos);
+
+                if (state == GOAT_CELL) {
+                    if (tiger_can_eat(game, pos, &expected.landing_cells)) {
+                        expected.capturable_goats |= cell;
+                    }
+                } else if (state == EMPTY_CELL) {
+                    // A goat is put there to check it.
+                    bitboard_t landing = 0;
+
+                    board_set_cell(&game->board, pos, GOAT_CELL);
+                    if (!tiger_can_eat(game, pos, &landing)) {
+                        expected.safe_cells |= cell;
+                    }
+                    board_set_cell(&game->board, pos, EMPTY_CELL);
+                }
+            }
+        }
+
+        if ((threats.capturable_goats != expected.capturable_goats) ||
+            (threats.landing_cells != expected.landing_cells) ||
+            (threats.safe_cells != expected.safe_cells)) {
+            printf("%s:%d: Movement %d: threats (0x%x, 0x%x, 0x%x) instead of "
+                   "(0x%x, 0x%x, 0x%x)\n", __FILE__, __LINE__, num_mvt,
+                   threats.capturable_goats, threats.landing_cells,
+                   threats.safe_cells, expected.capturable_goats,
+                   expected.landing_cells, expected.safe_cells);
+            test_fail(t);
+        }
+
+        game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+    }
+
+    game_free(game);
+}
+
+
+// slow_perft is `game_perft` trying every cell pair with `game_do_mvt` and
+// `game_undo` instead of generating the movements.
+static uint64_t slow_perft(game_t *game, int depth) {
+    mvt_t    mvt;
+    uint64_t num_games = 0;
+
+    if (depth == 0) {
+        return 1;
+    }
+    if (game_is_done(game)) {
+        return 0;
+    }
+
+    // Placements have no `to` cell.
+    bool placing = (game->turn == GOAT_TURN) && (game->num_goats_to_put > 0);
+
+    for (int from = 0; from < 5 * 5; from++) {
+        for (int to = placing ? -1 : 0; to < (placing ? 0 : 5 * 5); to++) {
+            mvt.from = (position_t){ .r = from / 5, .c = from % 5 };
+            mvt.to   = to < 0 ?
+                       (position_t){ POSITION_NOT_SET, POSITION_NOT_SET } :
+                       (position_t){ .r = to / 5, .c = to % 5 };
+            if (game_do_mvt(game, mvt)) {
+                num_games += slow_perft(game, depth - 1);
+                game_undo(game);
+            }
+        }
+    }
+
+    return num_games;
+}
+
+
+static void test_perft(test_t *t) {
+    // Counts of build/perft. The positions are the ones of build/bench.
+    struct {
+        const char *position;
+        int        depth;
+        uint64_t   num_games;
+    } perfts[] = {
+        { "T...T/...../...../...../T...T g 20", 1, 21      },
+        { "T...T/...../...../...../T...T g 20", 2, 252     },
+        { "T...T/...../...../...../T...T g 20", 3, 5052    },
+        { "T...T/...../...../...../T...T g 20", 4, 68204   },
+        { "T...T/...../...../...../T...T g 20", 5, 1304788 },
+        { "G.T../G..../G.T../GT.../G.T.. g 14", 4, 71612   },
+        { "T..../T..../..G.T/.GG../T.... g 14", 4, 39583   },
+        { "GGGGT/.GGTG/GGGTG/GGG../GGG.T g 0",  5, 20301   },
+        { "GGGGT/GGGTG/GGG.G/GGG.T/GGGT. g 0",  5, 12025   }
+    };
+    game_t *game = game_new();
+
+    for (int i = 0; i < ARRAY_LEN(perfts); i++) {
+        if (notation_parse_position(perfts[i].position, game) != 0) {
+            printf("%s:%d: Invalid position %s\n", __FILE__, __LINE__,
+                   perfts[i].position);
+            test_fail(t);
+        }
+
+        uint64_t num_games = game_perft(game, perfts[i].depth);
+        if (num_games != perfts[i].num_games) {
+            printf("%s:%d: %s: %llu games at depth %d instead of %llu\n",
+                   __FILE__, __LINE__, perfts[i].position,
+                   (unsigned long long)num_games, perfts[i].depth,
+                   (unsigned long long)perfts[i].num_games);
+            test_fail(t);
+        }
+
+        // The generated movements are the ones `game_do_mvt` accepts.
+        int depth = perfts[i].depth < 3 ? perfts[i].depth : 3;
+        if (game_perft(game, depth) != slow_perft(game, depth)) {
+            printf("%s:%d: %s: game_do_mvt accepts other movements at depth "
+                   "%d\n", __FILE__, __LINE__, perfts[i].position, depth);
+            test_fail(t);
+        }
+    }
+
+    game_free(game);
+}
+
+
+// test_no_allocations checks that the movement generation and the movements
+// done by the searches and by the players don't allocate. Allocations are only
+// counted in builds made with make alloc_stats.
+static void test_no_allocations(test_t *t) {
+    game_t *game = game_new();
+    mvt_t  mvts[GAME_MAX_NUM_MVTS];
+
+    notation_parse_position("GGG.T/GG.../GGT../GG.T./GGT.. g 8", game);
+    uint64_t num_allocs = alloc_stats_num_allocs();
+
+    int num_mvts = game_get_mvts(game, mvts);
+    for (int i = 0; i < num_mvts; i++) {
+        int eaten_goat = game_apply_legal_mvt(game, mvts[i]);
+        game_unapply_legal_mvt(game, mvts[i], eaten_goat);
+        game_do_mvt(game, mvts[i]);
+        game_undo(game);
+    }
+    game_perft(game, 3);
+
+    if (alloc_stats_num_allocs() != num_allocs) {
+        printf("%s:%d: %llu allocations\n", __FILE__, __LINE__,
+               (unsigned long long)(alloc_stats_num_allocs() - num_allocs));
+        test_fail(t);
+    }
+
+    game_free(game);
+}
+
+
+// bench_positions are positions of build/bench: the placement, the movements
+// and a near trap.
+static const char *bench_positions[] = {
+    "GGG.T/GG.../GGT../GG.T./GGT.. g 8",
+    "GGGGT/.GGTG/GGGTG/GGG../GGG.T g 0",
+    "GGGGT/GGGTG/GGG.G/GGG.T/GGGT. g 0"
+};
+
+
+// bench_games returns the games of `bench_positions`.
+static void bench_games(game_t **games) {
+    for (int i = 0; i < ARRAY_LEN(bench_positions); i++) {
+        games[i] = game_new();
+        notation_parse_position(bench_positions[i], games[i]);
+    }
+}
+
+
+static void bench_free_games(game_t **games) {
+    for (int i = 0; i < ARRAY_LEN(bench_positions); i++) {
+        game_free(games[i]);
+    }
+}
+
+
+static void bench_get_mvts(bench_t *b) {
+    game_t *games[ARRAY_LEN(bench_positions)];
+    mvt_t  mvts[GAME_MAX_NUM_MVTS];
+
+    bench_games(games);
+    for (long i = 0; i < b->num_iterations; i++) {
+        b->result += game_get_mvts(games[i % ARRAY_LEN(games)], mvts);
+    }
+    bench_free_games(games);
+}
+
+
+// bench_apply_legal_mvt times a movement done and undone as searches do.
+static void bench_apply_legal_mvt(bench_t *b) {
+    game_t *games[ARRAY_LEN(bench_positions)];
+    mvt_t  mvts[ARRAY_LEN(bench_positions)][GAME_MAX_NUM_MVTS];
+    int    num_mvts[ARRAY_LEN(bench_positions)];
+
+    bench_games(games);
+    for (int i = 0; i < ARRAY_LEN(games); i++) {
+        num_mvts[i] = game_get_mvts(games[i], mvts[i]);
+    }
+
+    for (long i = 0; i < b->num_iterations; i++) {
+        int   g          = i % ARRAY_LEN(games);
+        mvt_t mvt        = mvts[g][i % num_mvts[g]];
+        int   eaten_goat = game_apply_legal_mvt(games[g], mvt);
+        game_unapply_legal_mvt(games[g], mvt, eaten_goat);
+    }
+    bench_free_games(games);
+}
+
+
+// bench_do_mvt times a movement done and undone as human inputs are.
+static void bench_do_mvt(bench_t *b) {
+    game_t *games[ARRAY_LEN(bench_positions)];
+    mvt_t  mvts[ARRAY_LEN(bench_positions)][GAME_MAX_NUM_MVTS];
+    int    num_mvts[ARRAY_LEN(bench_positions)];
+
+    bench_games(games);
+    for (int i = 0; i < ARRAY_LEN(games); i++) {
+        num_mvts[i] = game_get_mvts(games[i], mvts[i]);
+    }
+
+    for (long i = 0; i < b->num_iterations; i++) {
+        int g = i % ARRAY_LEN(games);
+        game_do_mvt(games[g], mvts[g][i % num_mvts[g]]);
+        game_undo(games[g]);
+    }
+    bench_free_games(games);
+}
+
+
+static void bench_perft(bench_t *b) {
+    game_t *games[ARRAY_LEN(bench_positions)];
+
+    bench_games(games);
+    for (long i = 0; i < b->num_iterations; i++) {
+        b->result += game_perft(games[i % ARRAY_LEN(games)], 3);
+    }
+    bench_free_games(games);
 }
 
 
@@ -374,8 +846,26 @@ int main(int argc, char **argv) {
     test_function_t tests[] = {
         TEST_FUNCTION(test_game_begin),
         TEST_FUNCTION(test_ai_rand),
-        TEST_FUNCTION(test_undo)
+        TEST_FUNCTION(test_undo),
+        TEST_FUNCTION(test_get_mvts),
+        TEST_FUNCTION(test_apply_legal_mvt),
+        TEST_FUNCTION(test_movable_tigers),
+        TEST_FUNCTION(test_features),
+        TEST_FUNCTION(test_threats),
+        TEST_FUNCTION(test_perft),
+        TEST_FUNCTION(test_no_allocations)
+    };
+    bench_function_t benchs[] = {
+        BENCH_FUNCTION(bench_get_mvts),
+        BENCH_FUNCTION(bench_apply_legal_mvt),
+        BENCH_FUNCTION(bench_do_mvt),
+        BENCH_FUNCTION(bench_perft)
     };
 
+    int status = bench_main(argc, argv, benchs, ARRAY_LEN(benchs));
+    if (status >= 0) {
+        return status;
+    }
+
     return test_run(tests, ARRAY_LEN(tests));
 }
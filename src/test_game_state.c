@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "game.h"
+#include "game_state.h"
+#include "ai_rand.h"
+#include "tools.h"
+
+#define NUM_GAMES    20
+#define MAX_PLIES    200
+
+
+static bool mvt_equals(mvt_t m1, mvt_t m2) {
+    return position_equals(m1.from, m2.from) &&
+           (position_equals(m1.to, m2.to) ||
+            (!position_is_set(m1.to) && !position_is_set(m2.to)));
+}
+
+
+static bool state_equals(game_state_t *s1, game_state_t *s2) {
+    return s1->hash == s2->hash && s1->tigers == s2->tigers &&
+           s1->goats == s2->goats && s1->turn == s2->turn &&
+           s1->num_goats_to_put == s2->num_goats_to_put &&
+           s1->num_eaten_goats == s2->num_eaten_goats;
+}
+
+
+// check_state checks that the state copied along the game matches the game.
+static void check_state(test_t *t, game_t *game, game_state_t *state,
+                        int ply) {
+    game_state_t     expected;
+    mvt_t            mvts[GAME_MAX_NUM_MVTS];
+    game_state_mvt_t state_mvts[GAME_MAX_NUM_MVTS];
+
+    game_state_from_game(game, &expected);
+    if (!state_equals(&expected, state)) {
+        printf("%s:%d: Ply %d: the state doesn't match the game\n", __FILE__,
+               __LINE__, ply);
+        test_fail(t);
+    }
+
+    if (game_state_is_done(state) != game_is_done(game)) {
+        printf("%s:%d: Ply %d: game_state_is_done differs\n", __FILE__,
+               __LINE__, ply);
+        test_fail(t);
+    }
+
+    int num_mvts = game_get_mvts(game, mvts);
+    if (game_state_get_mvts(state, state_mvts) != num_mvts) {
+        printf("%s:%d: Ply %d: the number of movements differs\n", __FILE__,
+               __LINE__, ply);
+        test_fail(t);
+        return;
+    }
+
+    for (int i = 0; i < num_mvts; i++) {
+        if (!mvt_equals(game_state_to_mvt(state_mvts[i]), mvts[i])) {
+            printf("%s:%d: Ply %d: movement %d differs\n", __FILE__, __LINE__,
+                   ply, i);
+            test_fail(t);
+        }
+    }
+}
+
+
+static void test_copy_make(test_t *t) {
+    game_t *game = game_new();
+
+    for (int i = 0; i < NUM_GAMES; i++) {
+        game_state_t state;
+
+        game_reset(game);
+        game_state_from_game(game, &state);
+
+        for (int ply = 0; (ply < MAX_PLIES) && !game_is_done(game); ply++) {
+            game_state_mvt_t mvts[GAME_MAX_NUM_MVTS];
+
+            check_state(t, game, &state, ply);
+
+            int num_mvts = game_state_get_mvts(&state, mvts);
+            if (num_mvts == 0) {
+                break;
+            }
+
+            game_state_mvt_t mvt = mvts[rand() % num_mvts];
+            game_state_play(&state, mvt, &state);
+            if (!game_do_mvt(game, game_state_to_mvt(mvt))) {
+                printf("%s:%d: Ply %d: movement refused by the game\n",
+                       __FILE__, __LINE__, ply);
+                test_fail(t);
+                break;
+            }
+        }
+    }
+
+    game_free(game);
+}
+
+
+static void test_to_game(test_t *t) {
+    game_t       *game = game_new();
+    game_t       *copy = game_new();
+    game_state_t state, copied;
+
+    for (int ply = 0; (ply < MAX_PLIES) && !game_is_done(game); ply++) {
+        game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+    }
+
+    game_state_from_game(game, &state);
+    game_do_mvt(copy, ai_rand_get_mvt(NULL, copy));
+    game_state_to_game(&state, copy);
+    game_state_from_game(copy, &copied);
+
+    if (!state_equals(&state, &copied) ||
+        memcmp(&game->board, &copy->board, sizeof(board_t))) {
+        printf("%s:%d: The game doesn't match the state\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    if (!stack_is_empty(copy->history)) {
+        printf("%s:%d: The history is not cleared\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    game_free(game);
+    game_free(copy);
+}
+
+
+static void test_playout(test_t *t) {
+    game_t       *game = game_new();
+    game_state_t root, state;
+    uint64_t     seed = 42;
+    int          num_done = 0;
+
+    game_state_from_game(game, &root);
+
+    for (int i = 0; i < 100; i++) {
+        game_state_mvt_t mvts[GAME_MAX_NUM_MVTS];
+
+        state = root;
+        if (!game_state_playout(&state, MAX_PLIES, &seed)) {
+            continue;
+        }
+
+        num_done++;
+        if (!game_state_is_done(&state) &&
+            (game_state_get_mvts(&state, mvts) > 0)) {
+            printf("%s:%d: The playout stopped before the end\n", __FILE__,
+                   __LINE__);
+            test_fail(t);
+        }
+    }
+
+    if (num_done == 0) {
+        printf("%s:%d: No playout finished\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    game_free(game);
+}
+
+
+int main(int argc, char **argv) {
+    test_function_t tests[] = {
+        TEST_FUNCTION(test_copy_make),
+        TEST_FUNCTION(test_to_game),
+        TEST_FUNCTION(test_playout)
+    };
+
+    return test_run(tests, ARRAY_LEN(tests));
+}
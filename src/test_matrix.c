@@ -162,6 +162,85 @@ static void test_matrix_copy(test_t *t) {
 }
 
 
+// make_bench_matrix returns a matrix of the given size filled with values
+// that don't depend on the run.
+static matrix_t *make_bench_matrix(int rows, int cols) {
+    matrix_t *m = make_matrix(rows, cols, 0);
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            matrix_set_value(m, r, c, ((r * cols + c) % 17 - 8) / 8.);
+        }
+    }
+
+    return m;
+}
+
+
+// bench_matrix_product_layer times the product of a layer of the network of
+// build/bench with an input.
+static void bench_matrix_product_layer(bench_t *b) {
+    matrix_t *weights = make_bench_matrix(128, 3 * 5 * 5);
+    matrix_t *in      = make_bench_matrix(3 * 5 * 5, 1);
+    matrix_t *out     = make_matrix(0, 0, 0);
+
+    for (long i = 0; i < b->num_iterations; i++) {
+        matrix_product(weights, in, out);
+    }
+    b->result = matrix_get_value(out, 0, 0);
+
+    free_matrix(weights);
+    free_matrix(in);
+    free_matrix(out);
+}
+
+
+static void bench_matrix_product_square(bench_t *b) {
+    matrix_t *m1  = make_bench_matrix(32, 32);
+    matrix_t *m2  = make_bench_matrix(32, 32);
+    matrix_t *out = make_matrix(0, 0, 0);
+
+    for (long i = 0; i < b->num_iterations; i++) {
+        matrix_product(m1, m2, out);
+    }
+    b->result = matrix_get_value(out, 0, 0);
+
+    free_matrix(m1);
+    free_matrix(m2);
+    free_matrix(out);
+}
+
+
+static void bench_matrix_add(bench_t *b) {
+    matrix_t *m1  = make_bench_matrix(128, 1);
+    matrix_t *m2  = make_bench_matrix(128, 1);
+    matrix_t *out = make_matrix(0, 0, 0);
+
+    for (long i = 0; i < b->num_iterations; i++) {
+        matrix_add(m1, m2, out);
+    }
+    b->result = matrix_get_value(out, 0, 0);
+
+    free_matrix(m1);
+    free_matrix(m2);
+    free_matrix(out);
+}
+
+
+static void bench_matrix_apply(bench_t *b) {
+    matrix_t *in  = make_bench_matrix(128, 1);
+    matrix_t *out = make_matrix(0, 0, 0);
+
+    for (long i = 0; i < b->num_iterations; i++) {
+        matrix_apply(in, out, tanh);
+    }
+    b->result = matrix_get_value(out, 0, 0);
+
+    free_matrix(in);
+    free_matrix(out);
+}
+
+
 int main(int argc, char **argv) {
     test_function_t tests[] = {
         TEST_FUNCTION(test_matrix_creation),
@@ -170,6 +249,17 @@ int main(int argc, char **argv) {
         TEST_FUNCTION(test_matrix_apply),
         TEST_FUNCTION(test_matrix_copy)
     };
+    bench_function_t benchs[] = {
+        BENCH_FUNCTION(bench_matrix_product_layer),
+        BENCH_FUNCTION(bench_matrix_product_square),
+        BENCH_FUNCTION(bench_matrix_add),
+        BENCH_FUNCTION(bench_matrix_apply)
+    };
+
+    int status = bench_main(argc, argv, benchs, ARRAY_LEN(benchs));
+    if (status >= 0) {
+        return status;
+    }
 
     return test_run(tests, ARRAY_LEN(tests));
 }
@@ -25,7 +25,7 @@ void test_neuralnet_creation(test_t *t) {
         print_matrix(net->biases[i]);
     }
 
-    free(net);
+    free_neuralnet(net);
 }
 
 
@@ -75,8 +75,8 @@ void test_save_and_load(test_t *t) {
         }
     }
 
-    free(net1);
-    free(net2);
+    free_neuralnet(net1);
+    free_neuralnet(net2);
 }
 
 
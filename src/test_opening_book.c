@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "game.h"
+#include "opening_book.h"
+#include "symmetry.h"
+#include "zobrist.h"
+#include "ai_rand.h"
+#include "tools.h"
+
+#define TEST_BOOK_FILENAME    "/tmp/test_opening_book.bin"
+
+
+static void test_symmetry_inverse(test_t *t) {
+    for (int sym = 0; sym < NUM_SYMMETRIES; sym++) {
+        for (int cell = 0; cell < 5 * 5; cell++) {
+            int image = symmetry_cell(sym, cell);
+
+            if (symmetry_cell(symmetry_inverse(sym), image) != cell) {
+                printf("%s:%d: Symmetry %d is not undone on cell %d\n",
+                       __FILE__, __LINE__, sym, cell);
+                test_fail(t);
+            }
+
+            position_t pos = { cell % 5, cell / 5 };
+            if (position_has_diagonal(pos) !=
+                position_has_diagonal((position_t){image % 5, image / 5 })) {
+                printf("%s:%d: Symmetry %d doesn't keep the diagonals\n",
+                       __FILE__, __LINE__, sym);
+                test_fail(t);
+            }
+        }
+    }
+}
+
+
+static void test_canonical_hash(test_t *t) {
+    game_t *game      = game_new();
+    game_t *symmetric = game_new();
+
+    // The 4 goat placements on the corners' neighbours are all symmetric.
+    game_do_mvt(game, (mvt_t){{ 1, 0 }, { POSITION_NOT_SET, POSITION_NOT_SET } });
+    game_do_mvt(symmetric, (mvt_t){{ 4, 3 }, { POSITION_NOT_SET, POSITION_NOT_SET } });
+
+    if (zobrist_canonical_hash(game, NULL) !=
+        zobrist_canonical_hash(symmetric, NULL)) {
+        printf("%s:%d: Symmetric positions should have the same hash\n",
+               __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    if (zobrist_hash_game(game) == zobrist_hash_game(symmetric)) {
+        printf("%s:%d: Different positions should have different hashes\n",
+               __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    game_free(game);
+    game_free(symmetric);
+}
+
+
+static void test_book_probe(test_t *t) {
+    game_t *game = game_new();
+
+    // The book says the goat should be put on b0 after the tiger moved from
+    // a0 to a1.
+    game_do_mvt(game, (mvt_t){{ 2, 2 }, { POSITION_NOT_SET, POSITION_NOT_SET } });
+    game_do_mvt(game, (mvt_t){{ 0, 0 }, { 0, 1 } });
+
+    mvt_t                best    = { { 1, 0 }, { POSITION_NOT_SET, POSITION_NOT_SET } };
+    opening_book_entry_t entries[] = {
+        opening_book_make_entry(game, best, 4, 1.5)
+    };
+
+    if (opening_book_write(TEST_BOOK_FILENAME, entries, ARRAY_LEN(entries))) {
+        printf("%s:%d: Cannot write the book\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    opening_book_t *book = opening_book_open(TEST_BOOK_FILENAME);
+    if (book == NULL) {
+        printf("%s:%d: Cannot open the book\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    mvt_t  mvt;
+    double score;
+    if (!opening_book_probe(book, game, &mvt, &score) ||
+        !position_equals(mvt.from, best.from) || (score != 1.5)) {
+        printf("%s:%d: The book should give the stored movement\n",
+               __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    // The symmetric game (transposed board) must get the transposed movement.
+    game_t *symmetric = game_new();
+    game_do_mvt(symmetric, (mvt_t){{ 2, 2 }, { POSITION_NOT_SET, POSITION_NOT_SET } });
+    game_do_mvt(symmetric, (mvt_t){{ 0, 0 }, { 1, 0 } });
+
+    if (!opening_book_probe(book, symmetric, &mvt, NULL) ||
+        !position_equals(mvt.from, (position_t){0, 1 })) {
+        printf("%s:%d: The book should give the symmetric movement\n",
+               __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    game_undo(symmetric);
+    if (opening_book_probe(book, symmetric, &mvt, NULL)) {
+        printf("%s:%d: The position should not be in the book\n",
+               __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    opening_book_close(book);
+
+    // A number of entries whose size wraps around to the one of the file
+    // must be rejected. It follows the magic key and the entry size.
+    uint64_t num_entries = ARRAY_LEN(entries) +
+                           (UINT64_MAX / sizeof(opening_book_entry_t) + 1);
+    FILE     *f          = fopen(TEST_BOOK_FILENAME, "r+b");
+    if ((f == NULL) || (fseek(f, 2 * sizeof(uint32_t), SEEK_SET) != 0) ||
+        (fwrite(&num_entries, sizeof(num_entries), 1, f) != 1)) {
+        printf("%s:%d: Cannot corrupt the book\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+    if (f != NULL) {
+        fclose(f);
+    }
+
+    book = opening_book_open(TEST_BOOK_FILENAME);
+    if (book != NULL) {
+        printf("%s:%d: A corrupt book is opened\n", __FILE__, __LINE__);
+        opening_book_close(book);
+        test_fail(t);
+    }
+
+    game_free(symmetric);
+    game_free(game);
+    remove(TEST_BOOK_FILENAME);
+}
+
+
+// BENCH_NUM_ENTRIES is the number of entries of the book of the benchmarks.
+#define BENCH_NUM_ENTRIES    100000
+
+// open_random_book writes a book of the openings of random games, of
+// `num_entries` entries, to TEST_BOOK_FILENAME and opens it.
+// Returns NULL on failure.
+static opening_book_t *open_random_book(int num_entries) {
+    opening_book_entry_t *entries = malloc(num_entries * sizeof(opening_book_entry_t));
+    game_t               *game    = game_new();
+    opening_book_t       *book    = NULL;
+
+    if ((entries != NULL) && (game != NULL)) {
+        srand(0);
+        for (int i = 0; i < num_entries; i++) {
+            if (game_is_done(game) || (game->num_goats_to_put == 0)) {
+                game_reset(game);
+            }
+
+            mvt_t mvt = ai_rand_get_mvt(NULL, game);
+            entries[i] = opening_book_make_entry(game, mvt, 1, 0);
+            game_do_mvt(game, mvt);
+        }
+
+        if (opening_book_write(TEST_BOOK_FILENAME, entries, num_entries) == 0) {
+            book = opening_book_open(TEST_BOOK_FILENAME);
+        }
+    }
+
+    if (game != NULL) {
+        game_free(game);
+    }
+    free(entries);
+    return book;
+}
+
+
+static void test_book_random_games(test_t *t) {
+    opening_book_t *book = open_random_book(BENCH_NUM_ENTRIES);
+    game_t         *game = game_new();
+    mvt_t          mvt;
+
+    if ((book == NULL) || !opening_book_probe(book, game, &mvt, NULL)) {
+        printf("%s:%d: The start position should be in the book\n",
+               __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    opening_book_close(book);
+    game_free(game);
+    remove(TEST_BOOK_FILENAME);
+}
+
+
+static void bench_book_probe(bench_t *b) {
+    // The book is written once: it is mapped, the file can go.
+    static opening_book_t *book = NULL;
+
+    if (book == NULL) {
+        book = open_random_book(BENCH_NUM_ENTRIES);
+        remove(TEST_BOOK_FILENAME);
+    }
+
+    game_t *game = game_new();
+    for (long i = 0; (book != NULL) && (i < b->num_iterations); i++) {
+        mvt_t mvt;
+
+        b->result += opening_book_probe(book, game, &mvt, NULL);
+    }
+    game_free(game);
+}
+
+
+int main(int argc, char **argv) {
+    test_function_t tests[] = {
+        TEST_FUNCTION(test_symmetry_inverse),
+        TEST_FUNCTION(test_canonical_hash),
+        TEST_FUNCTION(test_book_probe),
+        TEST_FUNCTION(test_book_random_games)
+    };
+    bench_function_t benchs[] = {
+        BENCH_FUNCTION(bench_book_probe)
+    };
+
+    int status = bench_main(argc, argv, benchs, ARRAY_LEN(benchs));
+    if (status >= 0) {
+        return status;
+    }
+
+    return test_run(tests, ARRAY_LEN(tests));
+}
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "game.h"
+#include "notation.h"
+#include "pn_search.h"
+#include "tools.h"
+
+#define TEST_TABLE_SIZE    (1 << 20)
+
+
+static void test_notation(test_t *t) {
+    game_t *game = game_new();
+    char   str[NOTATION_POSITION_LEN];
+    mvt_t  mvt;
+
+    notation_format_position(game, str);
+    if (strcmp(str, "T...T/...../...../...../T...T g 20")) {
+        printf("%s:%d: Unexpected initial position %s\n", __FILE__, __LINE__,
+               str);
+        test_fail(t);
+    }
+
+    if (notation_parse_position("TG..T/...../..G../...../T...T t 15", game) ||
+        (game->turn != TIGER_TURN) || (game->num_goats_to_put != 15) ||
+        (game->num_eaten_goats != 3) ||
+        (board_get_cell(&game->board, (position_t){2, 2 }) != GOAT_CELL)) {
+        printf("%s:%d: Position badly parsed\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    notation_format_position(game, str);
+    if (strcmp(str, "TG..T/...../..G../...../T...T t 15")) {
+        printf("%s:%d: Position badly formatted: %s\n", __FILE__, __LINE__,
+               str);
+        test_fail(t);
+    }
+
+    if (!notation_parse_position("TG..T/...../...../T...T t 15", game) ||
+        !notation_parse_position("TG..T/...../...../...../T...T x 15", game) ||
+        !notation_parse_position("TG..T/...../...../...../T...T t 20", game) ||
+        !notation_parse_position("TG..T/...../...../...../T..TT t 15", game) ||
+        !notation_parse_position("TG..T/...../...../...../....T t 15", game) ||
+        !notation_parse_position("TG..T...../...../...../T...T/ t 15", game) ||
+        !notation_parse_position("TG..T/...../...../...../T...TG t 15", game)) {
+        printf("%s:%d: Invalid positions parsed\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    if (notation_parse_mvt("a1-c3", &mvt) || (mvt.from.c != 0) ||
+        (mvt.from.r != 0) || (mvt.to.c != 2) || (mvt.to.r != 2)) {
+        printf("%s:%d: Movement badly parsed\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    notation_format_mvt(mvt, str);
+    if (strcmp(str, "a1-c3")) {
+        printf("%s:%d: Movement badly formatted: %s\n", __FILE__, __LINE__,
+               str);
+        test_fail(t);
+    }
+
+    if (notation_parse_mvt("e5", &mvt) || position_is_set(mvt.to) ||
+        (mvt.from.c != 4) || (mvt.from.r != 4)) {
+        printf("%s:%d: Placement badly parsed\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    if (!notation_parse_mvt("f1", &mvt) || !notation_parse_mvt("a1c3", &mvt)) {
+        printf("%s:%d: Invalid movements parsed\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    game_free(game);
+}
+
+
+// check_solved checks that the position is won by `expected` and that the
+// solution line begins with `first_mvt` if it is not NULL.
+static void check_solved(test_t *t, pn_solver_t *solver, const char *position,
+                         pn_result_t expected, const char *first_mvt,
+                         int line) {
+    game_t     *game = game_new();
+    pn_stats_t stats;
+    mvt_t      mvts[PN_MAX_LINE_LEN];
+    char       str[NOTATION_MVT_LEN];
+    char       before[NOTATION_POSITION_LEN], after[NOTATION_POSITION_LEN];
+
+    notation_parse_position(position, game);
+    notation_format_position(game, before);
+
+    pn_result_t result = pn_solve(solver, game, 100000, &stats);
+    if (result != expected) {
+        printf("%s:%d: %s: result %d instead of %d\n", __FILE__, line,
+               position, result, expected);
+        test_fail(t);
+    }
+
+    int len = pn_solution_line(solver, game, mvts, PN_MAX_LINE_LEN);
+    if (len == 0) {
+        printf("%s:%d: %s: no solution line\n", __FILE__, line, position);
+        test_fail(t);
+    } else if (first_mvt != NULL) {
+        notation_format_mvt(mvts[0], str);
+        if (strcmp(str, first_mvt)) {
+            printf("%s:%d: %s: line begins with %s instead of %s\n", __FILE__,
+                   line, position, str, first_mvt);
+            test_fail(t);
+        }
+    }
+
+    notation_format_position(game, after);
+    if (strcmp(before, after)) {
+        printf("%s:%d: %s: position changed by the search: %s\n", __FILE__,
+               line, position, after);
+        test_fail(t);
+    }
+
+    // The solution line ends the game.
+    for (int i = 0; i < len; i++) {
+        game_do_mvt(game, mvts[i]);
+    }
+    if ((len > 0) && !game_is_done(game)) {
+        printf("%s:%d: %s: the solution line doesn't end the game\n",
+               __FILE__, line, position);
+        test_fail(t);
+    }
+
+    pn_result_t probed;
+    notation_parse_position(position, game);
+    if (!pn_probe(solver, game, &probed) || (probed != expected)) {
+        printf("%s:%d: %s: the result is not in the table\n", __FILE__, line,
+               position);
+        test_fail(t);
+    }
+
+    game_free(game);
+}
+
+
+static void test_solve(test_t *t) {
+    pn_solver_t *solver = pn_solver_new(TEST_TABLE_SIZE);
+
+    // Tigers eat their fifth goat.
+    check_solved(t, solver, "TG..T/...../...../...../T...T t 15",
+                 PN_TIGERS_WIN, "a1-c1", __LINE__);
+
+    // Goats block the last tiger which can move.
+    check_solved(t, solver, "GGTGG/TGGGG/G.GGT/GTG.G/GGGGG g 0",
+                 PN_GOATS_WIN, "d5-d4", __LINE__);
+
+    // Goats cannot protect both goats.
+    check_solved(t, solver, "GGGGG/GT.T./GGGGG/GGG../TGTG. g 0",
+                 PN_TIGERS_WIN, NULL, __LINE__);
+
+    pn_solver_free(solver);
+}
+
+
+static void test_max_nodes(test_t *t) {
+    pn_solver_t *solver = pn_solver_new(TEST_TABLE_SIZE);
+    game_t      *game   = game_new();
+    pn_stats_t  stats;
+
+    // The initial position is far from being solved.
+    if (pn_solve_player(solver, game, TIGER_TURN, 1000, NULL, &stats)) {
+        printf("%s:%d: The initial position is proven\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    // The budget is checked once the children of a position are evaluated.
+    if ((stats.num_nodes < 1000) || (stats.num_nodes > 1000 + PN_MAX_LINE_LEN)) {
+        printf("%s:%d: %llu nodes searched\n", __FILE__, __LINE__,
+               (unsigned long long)stats.num_nodes);
+        test_fail(t);
+    }
+
+    pn_result_t result;
+    if (pn_probe(solver, game, &result) || pn_probe(NULL, game, &result)) {
+        printf("%s:%d: The initial position is probed\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    // A cancelled search stops like one out of nodes: as soon as it checks.
+    ai_cancel_t cancel;
+    ai_cancel_reset(&cancel);
+    ai_cancel_set(&cancel);
+    pn_solver_clear(solver);
+    pn_solve_player(solver, game, TIGER_TURN, 1000000, &cancel, &stats);
+    if (stats.num_nodes > PN_MAX_LINE_LEN) {
+        printf("%s:%d: %llu nodes searched once cancelled\n", __FILE__,
+               __LINE__, (unsigned long long)stats.num_nodes);
+        test_fail(t);
+    }
+
+    game_free(game);
+    pn_solver_free(solver);
+}
+
+
+int main(int argc, char **argv) {
+    test_function_t tests[] = {
+        TEST_FUNCTION(test_notation),
+        TEST_FUNCTION(test_solve),
+        TEST_FUNCTION(test_max_nodes)
+    };
+
+    return test_run(tests, ARRAY_LEN(tests));
+}
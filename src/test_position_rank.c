@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "bitboard.h"
+#include "position_rank.h"
+#include "symmetry.h"
+#include "tools.h"
+
+static int materials[][2] = {
+    { 4, 20 }, { 4, 16 }, { 4, 10 }, { 4, 1 }, { 1, 3 }, { 2, 0 }
+};
+
+
+static void test_rank_bijection(test_t *t) {
+    for (int m = 0; m < ARRAY_LEN(materials); m++) {
+        int      num_tigers = materials[m][0];
+        int      num_goats  = materials[m][1];
+        uint64_t count      = position_rank_count(num_tigers, num_goats);
+
+        for (uint64_t rank = 0; rank < count; rank += 1 + count / 100000) {
+            bitboard_t tigers, goats;
+            position_unrank(num_tigers, num_goats, rank, &tigers, &goats);
+
+            if ((bitboard_count(tigers) != num_tigers) ||
+                (bitboard_count(goats) != num_goats) || (tigers & goats) ||
+                (position_rank(num_tigers, num_goats, tigers, goats) != rank)) {
+                printf("%s:%d: Rank %llu of %d tigers, %d goats is not a bijection\n",
+                       __FILE__, __LINE__, (unsigned long long)rank,
+                       num_tigers, num_goats);
+                test_fail(t);
+            }
+        }
+    }
+
+    if (position_rank_count(4, 20) != 12650 * 21) {
+        printf("%s:%d: Wrong number of positions\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+}
+
+
+static void test_board_rank(test_t *t) {
+    board_t board;
+
+    for (uint64_t rank = 0; rank < position_rank_count(4, 3); rank += 997) {
+        board_unrank(&board, 4, 3, rank);
+        if (board_rank(&board, 4, 3) != rank) {
+            printf("%s:%d: Board rank %llu is not a bijection\n",
+                   __FILE__, __LINE__, (unsigned long long)rank);
+            test_fail(t);
+        }
+    }
+}
+
+
+static void test_rank_symmetric(test_t *t) {
+    srand(0);
+
+    for (int m = 0; m < ARRAY_LEN(materials); m++) {
+        int      num_tigers = materials[m][0];
+        int      num_goats  = materials[m][1];
+        uint64_t count      = position_rank_count(num_tigers, num_goats);
+        uint64_t sym_count  = position_rank_count_symmetric(num_tigers, num_goats);
+
+        if ((sym_count * NUM_SYMMETRIES < count) || (sym_count >= count)) {
+            printf("%s:%d: Wrong number of symmetric ranks %llu for %llu ranks\n",
+                   __FILE__, __LINE__, (unsigned long long)sym_count,
+                   (unsigned long long)count);
+            test_fail(t);
+        }
+
+        for (int i = 0; i < 10000; i++) {
+            bitboard_t tigers, goats;
+            uint64_t   rank = ((uint64_t)rand() * RAND_MAX + rand()) % count;
+            position_unrank(num_tigers, num_goats, rank, &tigers, &goats);
+
+            int      sym;
+            uint64_t sym_rank = position_rank_symmetric(num_tigers, num_goats,
+                                                        tigers, goats, &sym);
+            if (sym_rank >= sym_count) {
+                printf("%s:%d: Symmetric rank out of range\n", __FILE__, __LINE__);
+                test_fail(t);
+            }
+
+            for (int s = 0; s < NUM_SYMMETRIES; s++) {
+                if (position_rank_symmetric(num_tigers, num_goats,
+                                            symmetry_bitboard(s, tigers),
+                                            symmetry_bitboard(s, goats),
+                                            NULL) != sym_rank) {
+                    printf("%s:%d: Symmetric positions have different ranks\n",
+                           __FILE__, __LINE__);
+                    test_fail(t);
+                }
+            }
+
+            bitboard_t canonical_tigers, canonical_goats;
+            position_unrank_symmetric(num_tigers, num_goats, sym_rank,
+                                      &canonical_tigers, &canonical_goats);
+            if ((symmetry_bitboard(sym, tigers) != canonical_tigers) ||
+                (symmetry_bitboard(sym, goats) != canonical_goats)) {
+                printf("%s:%d: The symmetry doesn't give the representative\n",
+                       __FILE__, __LINE__);
+                test_fail(t);
+            }
+        }
+    }
+}
+
+
+// BENCH_NUM_TIGERS, BENCH_NUM_GOATS and BENCH_NUM_POSITIONS define the
+// positions the benchmarks go through.
+#define BENCH_NUM_TIGERS       4
+#define BENCH_NUM_GOATS        16
+#define BENCH_NUM_POSITIONS    4096
+
+// bench_rank_of returns the rank of the `i`th benchmark position, spread over
+// the class.
+static uint64_t bench_rank_of(long i) {
+    uint64_t count = position_rank_count(BENCH_NUM_TIGERS, BENCH_NUM_GOATS);
+
+    return (i % BENCH_NUM_POSITIONS) * 7919ULL % count;
+}
+
+
+// bench_positions sets `positions` to the tigers and goats of the benchmark
+// positions.
+static void bench_positions(bitboard_t positions[][2]) {
+    for (int i = 0; i < BENCH_NUM_POSITIONS; i++) {
+        position_unrank(BENCH_NUM_TIGERS, BENCH_NUM_GOATS, bench_rank_of(i),
+                        &positions[i][0], &positions[i][1]);
+    }
+}
+
+
+static void bench_unrank(bench_t *b) {
+    for (long i = 0; i < b->num_iterations; i++) {
+        bitboard_t tigers, goats;
+
+        position_unrank(BENCH_NUM_TIGERS, BENCH_NUM_GOATS, bench_rank_of(i),
+                        &tigers, &goats);
+        b->result += tigers ^ goats;
+    }
+}
+
+
+static void bench_rank(bench_t *b) {
+    bitboard_t positions[BENCH_NUM_POSITIONS][2];
+
+    bench_positions(positions);
+    for (long i = 0; i < b->num_iterations; i++) {
+        bitboard_t *p = positions[i % BENCH_NUM_POSITIONS];
+
+        b->result += position_rank(BENCH_NUM_TIGERS, BENCH_NUM_GOATS, p[0],
+                                   p[1]);
+    }
+}
+
+
+static void bench_rank_symmetric(bench_t *b) {
+    bitboard_t positions[BENCH_NUM_POSITIONS][2];
+
+    position_rank_symmetric_init(BENCH_NUM_TIGERS);
+    bench_positions(positions);
+    for (long i = 0; i < b->num_iterations; i++) {
+        bitboard_t *p = positions[i % BENCH_NUM_POSITIONS];
+
+        b->result += position_rank_symmetric(BENCH_NUM_TIGERS, BENCH_NUM_GOATS,
+                                             p[0], p[1], NULL);
+    }
+}
+
+
+int main(int argc, char **argv) {
+    test_function_t tests[] = {
+        TEST_FUNCTION(test_rank_bijection),
+        TEST_FUNCTION(test_board_rank),
+        TEST_FUNCTION(test_rank_symmetric)
+    };
+    bench_function_t benchs[] = {
+        BENCH_FUNCTION(bench_unrank),
+        BENCH_FUNCTION(bench_rank),
+        BENCH_FUNCTION(bench_rank_symmetric)
+    };
+
+    int status = bench_main(argc, argv, benchs, ARRAY_LEN(benchs));
+    if (status >= 0) {
+        return status;
+    }
+
+    return test_run(tests, ARRAY_LEN(tests));
+}
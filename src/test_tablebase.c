@@ -0,0 +1,688 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "game.h"
+#include "bitboard.h"
+#include "tablebase.h"
+#include "tablebase_gen.h"
+#include "tablebase_compressed.h"
+#include "ai_rand.h"
+#include "tools.h"
+
+#define TEST_DIRECTORY    "/tmp"
+
+// Small material classes with a single tiger. They follow the same rules as
+// the real ones but are solved in a few milliseconds.
+static tb_material_t small_class   = { 1, 2, 4 };
+static tb_material_t smaller_class = { 1, 3, 3 };
+
+
+static void test_bitboard_rules(test_t *t) {
+    game_t *game = game_new();
+
+    srand(0);
+    for (int i = 0; i < 200; i++) {
+        game_reset(game);
+
+        while (!game_is_done(game)) {
+            bitboard_t tigers = bitboard_from_board(&game->board, TIGER_CELL);
+            bitboard_t goats  = bitboard_from_board(&game->board, GOAT_CELL);
+
+            if (bitboard_tigers_blocked(tigers, goats)) {
+                printf("%s:%d: Tigers should not be blocked\n",
+                       __FILE__, __LINE__);
+                test_fail(t);
+            }
+
+            game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+        }
+
+        bitboard_t tigers = bitboard_from_board(&game->board, TIGER_CELL);
+        bitboard_t goats  = bitboard_from_board(&game->board, GOAT_CELL);
+        if ((game->num_eaten_goats < GOATS_EATEN_TO_WIN) &&
+            !bitboard_tigers_blocked(tigers, goats)) {
+            printf("%s:%d: Tigers should be blocked\n", __FILE__, __LINE__);
+            test_fail(t);
+        }
+    }
+
+    game_free(game);
+}
+
+
+// reachable returns the cells of `open` reached from `seeds` by a breadth
+// first search over the neighbours tables.
+static bitboard_t reachable(bitboard_t seeds, bitboard_t open) {
+    int        queue[5 * 5];
+    int        head = 0, tail = 0;
+    bitboard_t seen = seeds & open;
+
+    for (bitboard_t s = seen; s; s &= s - 1) {
+        queue[tail++] = bitboard_first(s);
+    }
+
+    while (head < tail) {
+        const bitboard_neighbours_t *n = bitboard_neighbours(queue[head++]);
+
+        for (int i = 0; i < n->num_neighbours; i++) {
+            int to = n->neighbours[i];
+            if (bitboard_has(open, to) && !bitboard_has(seen, to)) {
+                seen         |= bitboard_cell(to);
+                queue[tail++] = to;
+            }
+        }
+    }
+
+    return seen;
+}
+
+
+static void test_bitboard_regions(test_t *t) {
+    game_t *game = game_new();
+
+    for (int cell = 0; cell < 5 * 5; cell++) {
+        if (bitboard_dilate(bitboard_cell(cell)) !=
+            bitboard_neighbours(cell)->mask) {
+            printf("%s:%d: Wrong neighbours of %d\n", __FILE__, __LINE__, cell);
+            test_fail(t);
+        }
+    }
+
+    srand(0);
+    for (int i = 0; i < 200; i++) {
+        game_reset(game);
+
+        while (!game_is_done(game)) {
+            bitboard_t tigers = bitboard_from_board(&game->board, TIGER_CELL);
+            bitboard_t goats  = bitboard_from_board(&game->board, GOAT_CELL);
+            bitboard_t empty  = ~(tigers | goats) & BITBOARD_ALL;
+            bitboard_t regions[5 * 5];
+            bitboard_t area = game_get_tiger_regions(game, regions);
+            bitboard_t expected_area = 0;
+
+            for (bitboard_t m = tigers; m; m &= m - 1) {
+                int                         cell   = bitboard_first(m);
+                const bitboard_neighbours_t *n     = bitboard_neighbours(cell);
+                bitboard_t                  jumped = 0;
+
+                for (int j = 0; j < n->num_jumps; j++) {
+                    if (bitboard_has(goats, n->jumps[j].over)) {
+                        jumped |= bitboard_cell(n->jumps[j].to);
+                    }
+                }
+
+                bitboard_t expected = reachable(n->mask | jumped, empty);
+                if (regions[cell] != expected) {
+                    printf("%s:%d: Wrong region of tiger %d\n",
+                           __FILE__, __LINE__, cell);
+                    test_fail(t);
+                }
+
+                if ((regions[cell] == 0) !=
+                    !bitboard_tiger_can_move(cell, tigers, goats)) {
+                    printf("%s:%d: Tiger %d should move in its region\n",
+                           __FILE__, __LINE__, cell);
+                    test_fail(t);
+                }
+                expected_area |= expected;
+            }
+
+            if (area != expected_area) {
+                printf("%s:%d: Wrong free area\n", __FILE__, __LINE__);
+                test_fail(t);
+            }
+
+            game_do_mvt(game, ai_rand_get_mvt(NULL, game));
+        }
+    }
+
+    game_free(game);
+}
+
+
+static void test_tablebase_index(test_t *t) {
+    tb_material_t materials[] = {
+        small_class, smaller_class, tablebase_material(0), tablebase_material(4)
+    };
+
+    for (int m = 0; m < ARRAY_LEN(materials); m++) {
+        uint64_t num_positions = tablebase_num_positions(materials[m]);
+
+        for (uint64_t i = 0; i < num_positions; i += 1 + num_positions / 10000) {
+            bitboard_t tigers, goats;
+            tablebase_position(materials[m], i, &tigers, &goats);
+
+            if ((bitboard_count(tigers) != materials[m].num_tigers) ||
+                (bitboard_count(goats) != materials[m].num_goats) ||
+                (tigers & goats) ||
+                (tablebase_index(materials[m], tigers, goats) != i)) {
+                printf("%s:%d: Index %llu is not a bijection\n",
+                       __FILE__, __LINE__, (unsigned long long)i);
+                test_fail(t);
+            }
+        }
+    }
+}
+
+
+// child_value sets the value of the current game for the player who plays.
+static bool child_value(tablebase_class_t *classes[], game_t *game,
+                        tb_value_t *value) {
+    if (game_is_done(game)) {
+        *value = TB_VALUE_LOSS;
+        return true;
+    }
+
+    for (int i = 0; classes[i] != NULL; i++) {
+        if (classes[i]->material.num_eaten_goats == game->num_eaten_goats) {
+            *value = tablebase_class_get(classes[i], game->turn,
+                                         bitboard_from_board(&game->board, TIGER_CELL),
+                                         bitboard_from_board(&game->board, GOAT_CELL));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+// expected_value computes the value of the game from the values of the
+// positions reached by `game_do_mvt`.
+static tb_value_t expected_value(tablebase_class_t *classes[], game_t *game) {
+    if (game_is_done(game)) {
+        return TB_VALUE_LOSS;
+    }
+
+    possible_positions_t possible_from, possible_to;
+    mvt_t                mvt;
+    int                  win  = -1;
+    int                  loss = -1;
+    bool                 draw = false;
+
+    game_get_possible_from_positions(game, &possible_from);
+    for (int from = 0; from < 5 * 5; from++) {
+        mvt.from = (position_t){ from % 5, from / 5 };
+        if (!is_position_possible(&possible_from, mvt.from)) {
+            continue;
+        }
+
+        game_get_possible_to_positions(game, mvt.from, &possible_to);
+        for (int to = 0; to < 5 * 5; to++) {
+            mvt.to = (position_t){ to % 5, to / 5 };
+            if (!is_position_possible(&possible_to, mvt.to)) {
+                continue;
+            }
+
+            tb_value_t value = TB_VALUE_DRAW;
+            game_do_mvt(game, mvt);
+            child_value(classes, game, &value);
+            game_undo(game);
+
+            int dtr = tb_value_dtr(value) + 1;
+            switch (tb_value_result(value)) {
+            case TB_VALUE_LOSS:
+                win = (win < 0 || dtr < win) ? dtr : win;
+                break;
+
+            case TB_VALUE_WIN:
+                loss = dtr > loss ? dtr : loss;
+                break;
+
+            default:
+                draw = true;
+            }
+        }
+    }
+
+    if (win >= 0) {
+        return TB_VALUE_WIN | win;
+    }
+    if (draw) {
+        return TB_VALUE_DRAW;
+    }
+    return TB_VALUE_LOSS | (loss < 0 ? 0 : loss);
+}
+
+
+// check_class checks that every value of the class is consistent with the
+// values of the positions reached with `game_do_mvt`.
+static bool check_class(tablebase_class_t *classes[]) {
+    game_t        *game    = game_new();
+    tb_material_t material = classes[0]->material;
+    bool          ok       = true;
+
+    for (uint64_t i = 0; ok && i < classes[0]->num_positions; i++) {
+        bitboard_t tigers, goats;
+        tablebase_position(material, i, &tigers, &goats);
+
+        for (int turn = GOAT_TURN; ok && turn <= TIGER_TURN; turn++) {
+            stack_reset(game->history);
+            bitboard_to_board(tigers, goats, &game->board);
+            game->num_goats_to_put = 0;
+            game->num_eaten_goats  = material.num_eaten_goats;
+            game->turn             = turn;
+            game_update_status(game);
+
+            tb_value_t got      = classes[0]->values[turn][i];
+            tb_value_t expected = expected_value(classes, game);
+            if (got != expected) {
+                printf("%s:%d: Position %llu (turn %d): got 0x%x, expected 0x%x\n",
+                       __FILE__, __LINE__, (unsigned long long)i, turn,
+                       got, expected);
+                ok = false;
+            }
+        }
+    }
+
+    game_free(game);
+    return ok;
+}
+
+
+static void test_tablebase_generate(test_t *t) {
+    char                  filename[1024];
+    tablebase_gen_stats_t stats;
+
+    if (tablebase_generate(small_class, TEST_DIRECTORY, 1, &stats)) {
+        printf("%s:%d: Cannot generate the class\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+    printf("%llu wins, %llu losses, %llu draws, max distance %d\n",
+           (unsigned long long)stats.num_wins,
+           (unsigned long long)stats.num_losses,
+           (unsigned long long)stats.num_draws, stats.max_dtr);
+
+    if (tablebase_generate(smaller_class, TEST_DIRECTORY, 4, &stats)) {
+        printf("%s:%d: Cannot generate the class\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+    printf("%llu wins, %llu losses, %llu draws, max distance %d\n",
+           (unsigned long long)stats.num_wins,
+           (unsigned long long)stats.num_losses,
+           (unsigned long long)stats.num_draws, stats.max_dtr);
+
+    tablebase_class_t *classes[3] = { NULL, NULL, NULL };
+    tablebase_filename(smaller_class, TEST_DIRECTORY, filename, sizeof(filename));
+    classes[0] = tablebase_class_open(filename);
+    tablebase_filename(small_class, TEST_DIRECTORY, filename, sizeof(filename));
+    classes[1] = tablebase_class_open(filename);
+
+    if ((classes[0] == NULL) || (classes[1] == NULL)) {
+        printf("%s:%d: Cannot open the classes\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    bool ok = check_class(classes + 1) && check_class(classes);
+
+    // The same class generated with another number of threads must be the same.
+    tb_value_t *values = malloc(2 * classes[0]->num_positions * sizeof(tb_value_t));
+    memcpy(values, classes[0]->values[GOAT_TURN],
+           2 * classes[0]->num_positions * sizeof(tb_value_t));
+    tablebase_class_close(classes[0]);
+
+    tablebase_generate(smaller_class, TEST_DIRECTORY, 1, NULL);
+    tablebase_filename(smaller_class, TEST_DIRECTORY, filename, sizeof(filename));
+    classes[0] = tablebase_class_open(filename);
+    if (memcmp(values, classes[0]->values[GOAT_TURN],
+               2 * classes[0]->num_positions * sizeof(tb_value_t))) {
+        printf("%s:%d: Threads changed the result\n", __FILE__, __LINE__);
+        ok = false;
+    }
+
+    free(values);
+    tablebase_class_close(classes[0]);
+    tablebase_class_close(classes[1]);
+    remove(filename);
+    tablebase_filename(small_class, TEST_DIRECTORY, filename, sizeof(filename));
+
+    // A class under the name of another one is not loaded.
+    char          misnamed[1024];
+    tb_material_t material = tablebase_material(small_class.num_eaten_goats);
+    tablebase_filename(material, TEST_DIRECTORY, misnamed, sizeof(misnamed));
+    rename(filename, misnamed);
+    tablebase_t *tb = tablebase_open(TEST_DIRECTORY);
+    if ((tb != NULL) && (tb->classes[small_class.num_eaten_goats] != NULL)) {
+        printf("%s:%d: A misnamed class is loaded\n", __FILE__, __LINE__);
+        ok = false;
+    }
+    tablebase_close(tb);
+    remove(misnamed);
+
+    if (!ok) {
+        test_fail(t);
+    }
+}
+
+
+// read_class returns a copy of the values of the class file, or NULL.
+static tb_value_t *read_class(tb_material_t material, uint64_t *num_positions) {
+    char filename[1024];
+
+    tablebase_filename(material, TEST_DIRECTORY, filename, sizeof(filename));
+    tablebase_class_t *tb_class = tablebase_class_open(filename);
+    if (tb_class == NULL) {
+        return NULL;
+    }
+
+    *num_positions = tb_class->num_positions;
+    tb_value_t *values = malloc(2 * *num_positions * sizeof(tb_value_t));
+    memcpy(values, tb_class->values[GOAT_TURN],
+           2 * *num_positions * sizeof(tb_value_t));
+    tablebase_class_close(tb_class);
+
+    return values;
+}
+
+
+static void test_tablebase_generate_out_of_core(test_t *t) {
+    char     filename[1024];
+    uint64_t num_positions;
+    bool     ok = true;
+
+    tablebase_generate(small_class, TEST_DIRECTORY, 1, NULL);
+    tablebase_generate(smaller_class, TEST_DIRECTORY, 1, NULL);
+    tb_value_t *expected_small   = read_class(small_class, &num_positions);
+    tb_value_t *expected_smaller = read_class(smaller_class, &num_positions);
+
+    // The memory cap is small enough to stream the class by several chunks.
+    size_t memory_cap = 32 * 1024;
+    if (tablebase_generate_out_of_core(small_class, TEST_DIRECTORY, 1,
+                                       memory_cap, 0, NULL) ||
+        tablebase_generate_out_of_core(smaller_class, TEST_DIRECTORY, 3,
+                                       memory_cap, 0, NULL)) {
+        printf("%s:%d: Cannot generate the class\n", __FILE__, __LINE__);
+        test_fail(t);
+    }
+
+    tb_value_t *values = read_class(smaller_class, &num_positions);
+    if ((values == NULL) || (expected_smaller == NULL) ||
+        memcmp(values, expected_smaller, 2 * num_positions * sizeof(tb_value_t))) {
+        printf("%s:%d: Generations differ\n", __FILE__, __LINE__);
+        ok = false;
+    }
+    free(values);
+
+    values = read_class(small_class, &num_positions);
+    if ((values == NULL) || (expected_small == NULL) ||
+        memcmp(values, expected_small, 2 * num_positions * sizeof(tb_value_t))) {
+        printf("%s:%d: Generations differ\n", __FILE__, __LINE__);
+        ok = false;
+    }
+    free(values);
+
+    // Interrupted generations resume from the last partition.
+    tablebase_filename(smaller_class, TEST_DIRECTORY, filename, sizeof(filename));
+    remove(filename);
+    int num_runs = 1;
+    while (tablebase_generate_out_of_core(smaller_class, TEST_DIRECTORY, 2,
+                                          memory_cap, 3, NULL) == 6) {
+        num_runs++;
+    }
+    printf("Generated in %d runs\n", num_runs);
+
+    values = read_class(smaller_class, &num_positions);
+    if ((num_runs < 2) || (values == NULL) ||
+        memcmp(values, expected_smaller, 2 * num_positions * sizeof(tb_value_t))) {
+        printf("%s:%d: Resumed generation differs\n", __FILE__, __LINE__);
+        ok = false;
+    }
+    free(values);
+
+    if (tablebase_generate_out_of_core(smaller_class, TEST_DIRECTORY, 1,
+                                       1024, 0, NULL) != 5) {
+        printf("%s:%d: Memory cap should be too small\n", __FILE__, __LINE__);
+        ok = false;
+    }
+
+    free(expected_small);
+    free(expected_smaller);
+    remove(filename);
+    tablebase_filename(small_class, TEST_DIRECTORY, filename, sizeof(filename));
+    remove(filename);
+
+    if (!ok) {
+        test_fail(t);
+    }
+}
+
+
+// read_file returns the content of the file, to be freed, or NULL.
+static uint8_t *read_file(const char *filename, size_t *size) {
+    FILE *f = fopen(filename, "rb");
+
+    if (f == NULL) {
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    uint8_t *data = malloc(*size);
+    rewind(f);
+    if ((data != NULL) && (fread(data, 1, *size, f) != *size)) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+
+// corrupt_offset_rejected returns true if the compressed class file can't be
+// opened once the offset of its first block points past its end.
+static bool corrupt_offset_rejected(const char *filename) {
+    size_t        size;
+    uint8_t       *data = read_file(filename, &size);
+    tb_material_t material;
+
+    if (data == NULL) {
+        return false;
+    }
+
+    // The offsets follow the 40 bytes of the header.
+    uint64_t offset = size + 1;
+    memcpy(data + 40, &offset, sizeof(offset));
+    tb_compressed_t *compressed = tb_compressed_open(data, size, &material);
+
+    tb_compressed_close(compressed);
+    free(data);
+    return compressed == NULL;
+}
+
+
+// corrupt_block_rejected returns true if the first position of the compressed
+// class file can't be probed once the header of its first block is corrupt:
+// too many symbols, then a code length out of range.
+static bool corrupt_block_rejected(const char *filename) {
+    size_t        size;
+    uint8_t       *data = read_file(filename, &size);
+    tb_material_t material;
+    bool          rejected = true;
+
+    if (data == NULL) {
+        return false;
+    }
+
+    uint64_t offset;
+    memcpy(&offset, data + 40, sizeof(offset));
+    uint16_t num_symbols;
+    memcpy(&num_symbols, data + offset, sizeof(num_symbols));
+
+    uint16_t corrupt_symbols = UINT16_MAX;
+    memcpy(data + offset, &corrupt_symbols, sizeof(corrupt_symbols));
+    tb_compressed_t *compressed = tb_compressed_open(data, size, &material);
+    rejected &= (compressed != NULL) &&
+                (tb_compressed_get(compressed, GOAT_TURN, 0) == TB_VALUE_INVALID);
+    tb_compressed_close(compressed);
+
+    memcpy(data + offset, &num_symbols, sizeof(num_symbols));
+    if (num_symbols > 1) {
+        // The lengths follow the number of symbols and the symbols.
+        data[offset + 2 + 2 * num_symbols] = 17;
+        compressed = tb_compressed_open(data, size, &material);
+        rejected  &= (compressed != NULL) &&
+                     (tb_compressed_get(compressed, GOAT_TURN, 0) ==
+                      TB_VALUE_INVALID);
+        tb_compressed_close(compressed);
+    }
+
+    free(data);
+    return rejected;
+}
+
+
+static void test_tablebase_compress(test_t *t) {
+    char                filename[1024];
+    uint64_t            num_positions;
+    tb_compress_stats_t stats;
+    bool                ok = true;
+
+    tablebase_generate(small_class, TEST_DIRECTORY, 1, NULL);
+    tablebase_generate(smaller_class, TEST_DIRECTORY, 1, NULL);
+    tb_value_t *expected = read_class(smaller_class, &num_positions);
+
+    tablebase_filename(smaller_class, TEST_DIRECTORY, filename, sizeof(filename));
+    if (tablebase_compress(filename, filename, &stats)) {
+        printf("%s:%d: Cannot compress the class\n", __FILE__, __LINE__);
+        test_fail(t);
+        return;
+    }
+
+    if (stats.compressed_size >= stats.raw_size) {
+        printf("%s:%d: The class is not smaller compressed\n", __FILE__,
+               __LINE__);
+        ok = false;
+    }
+
+    tablebase_class_t *tb_class = tablebase_class_open(filename);
+    if ((tb_class == NULL) || (tb_class->compressed == NULL)) {
+        printf("%s:%d: Cannot open the compressed class\n", __FILE__, __LINE__);
+        test_fail(t);
+        return;
+    }
+
+    // Positions are probed in an order which doesn't follow the blocks.
+    for (uint64_t n = 0; ok && n < 2 * num_positions; n++) {
+        uint64_t      i    = (n * 7919) % (2 * num_positions);
+        player_turn_t turn = i < num_positions ? GOAT_TURN : TIGER_TURN;
+        bitboard_t    tigers, goats;
+
+        tablebase_position(smaller_class, i % num_positions, &tigers, &goats);
+        if (tablebase_class_get(tb_class, turn, tigers, goats) != expected[i]) {
+            printf("%s:%d: Wrong value for position %llu\n", __FILE__, __LINE__,
+                   (unsigned long long)i);
+            ok = false;
+        }
+    }
+
+    tablebase_class_close(tb_class);
+
+    if (!corrupt_offset_rejected(filename)) {
+        printf("%s:%d: A corrupt class is opened\n", __FILE__, __LINE__);
+        ok = false;
+    }
+
+    if (!corrupt_block_rejected(filename)) {
+        printf("%s:%d: A corrupt block is decoded\n", __FILE__, __LINE__);
+        ok = false;
+    }
+
+    if (tablebase_compress(filename, filename, NULL) == 0) {
+        printf("%s:%d: Compressed twice\n", __FILE__, __LINE__);
+        ok = false;
+    }
+
+    // The generator reads compressed classes.
+    tablebase_filename(small_class, TEST_DIRECTORY, filename, sizeof(filename));
+    tablebase_compress(filename, filename, NULL);
+    tablebase_generate(smaller_class, TEST_DIRECTORY, 2, NULL);
+    tb_value_t *values = read_class(smaller_class, &num_positions);
+    if ((values == NULL) ||
+        memcmp(values, expected, 2 * num_positions * sizeof(tb_value_t))) {
+        printf("%s:%d: Generation differs\n", __FILE__, __LINE__);
+        ok = false;
+    }
+
+    free(values);
+    free(expected);
+    remove(filename);
+    tablebase_filename(smaller_class, TEST_DIRECTORY, filename, sizeof(filename));
+    remove(filename);
+
+    if (!ok) {
+        test_fail(t);
+    }
+}
+
+
+// bench_class returns the class of the benchmarks, raw or compressed. It is
+// generated on the first call and stays open: the file is mapped, it can go.
+// Returns NULL on failure.
+static tablebase_class_t *bench_class(bool compressed) {
+    static tablebase_class_t *classes[2] = { NULL, NULL };
+    char                     filename[1024];
+
+    if (classes[compressed] != NULL) {
+        return classes[compressed];
+    }
+
+    tablebase_generate(small_class, TEST_DIRECTORY, 1, NULL);
+    tablebase_generate(smaller_class, TEST_DIRECTORY, 1, NULL);
+    tablebase_filename(smaller_class, TEST_DIRECTORY, filename, sizeof(filename));
+    if (!compressed || (tablebase_compress(filename, filename, NULL) == 0)) {
+        classes[compressed] = tablebase_class_open(filename);
+    }
+
+    remove(filename);
+    tablebase_filename(small_class, TEST_DIRECTORY, filename, sizeof(filename));
+    remove(filename);
+    return classes[compressed];
+}
+
+
+// bench_probe probes the positions of the class of the benchmarks in order.
+static void bench_probe(bench_t *b, bool compressed) {
+    tablebase_class_t *tb_class = bench_class(compressed);
+
+    for (long i = 0; (tb_class != NULL) && (i < b->num_iterations); i++) {
+        uint64_t   n = i % (2 * tb_class->num_positions);
+        bitboard_t tigers, goats;
+
+        tablebase_position(tb_class->material, n / 2, &tigers, &goats);
+        b->result += tablebase_class_get(tb_class, n % 2, tigers, goats);
+    }
+}
+
+
+static void bench_probe_raw(bench_t *b) {
+    bench_probe(b, false);
+}
+
+
+static void bench_probe_compressed(bench_t *b) {
+    bench_probe(b, true);
+}
+
+
+int main(int argc, char **argv) {
+    test_function_t tests[] = {
+        TEST_FUNCTION(test_bitboard_rules),
+        TEST_FUNCTION(test_bitboard_regions),
+        TEST_FUNCTION(test_tablebase_index),
+        TEST_FUNCTION(test_tablebase_generate),
+        TEST_FUNCTION(test_tablebase_generate_out_of_core),
+        TEST_FUNCTION(test_tablebase_compress)
+    };
+    bench_function_t benchs[] = {
+        BENCH_FUNCTION(bench_probe_raw),
+        BENCH_FUNCTION(bench_probe_compressed)
+    };
+
+    int status = bench_main(argc, argv, benchs, ARRAY_LEN(benchs));
+    if (status >= 0) {
+        return status;
+    }
+
+    return test_run(tests, ARRAY_LEN(tests));
+}
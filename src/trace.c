@@ -0,0 +1,166 @@
+#include "trace.h"
+
+#ifdef TRACE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TRACE_DEFAULT_FILE    "trace.json"
+
+// trace_event_t is a recorded zone.
+typedef struct {
+    const char *name;
+    uint64_t   begin;
+    uint64_t   duration;
+} trace_event_t;
+
+// trace_buffer_t is the ring buffer of a thread. The buffer of a thread that
+// ended is taken over by the next new thread: the AI workers, one thread per
+// search, share a row of the trace and memory stays bounded.
+typedef struct trace_buffer {
+    trace_event_t       events[TRACE_BUFFER_SIZE];
+    uint64_t            num_events; // Recorded since the start, not kept.
+    int                 tid;
+    int                 in_use;
+    struct trace_buffer *next;
+} trace_buffer_t;
+
+static pthread_once_t          once = PTHREAD_ONCE_INIT;
+static pthread_key_t           key; // Releases the buffer of a thread.
+static trace_buffer_t          *buffers;
+static int                     num_buffers;
+static __thread trace_buffer_t *buffer;
+
+
+static uint64_t now() {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+
+// first_event returns the index of the oldest zone kept in the buffer.
+static uint64_t first_event(trace_buffer_t *b) {
+    return b->num_events > TRACE_BUFFER_SIZE ?
+           b->num_events - TRACE_BUFFER_SIZE : 0;
+}
+
+
+// write_trace writes the zones of every thread to the trace file. Times start
+// at the oldest zone kept.
+static void write_trace() {
+    char     *filename = getenv("TRACE_FILE");
+    FILE     *f        = fopen(filename != NULL ? filename : TRACE_DEFAULT_FILE,
+                               "w");
+    bool     first     = true;
+    uint64_t origin    = UINT64_MAX;
+
+    if (f == NULL) {
+        return;
+    }
+
+    for (trace_buffer_t *b = __atomic_load_n(&buffers, __ATOMIC_ACQUIRE);
+         b != NULL; b = b->next) {
+        for (uint64_t i = first_event(b); i < b->num_events; i++) {
+            if (b->events[i % TRACE_BUFFER_SIZE].begin < origin) {
+                origin = b->events[i % TRACE_BUFFER_SIZE].begin;
+            }
+        }
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (trace_buffer_t *b = __atomic_load_n(&buffers, __ATOMIC_ACQUIRE);
+         b != NULL; b = b->next) {
+        for (uint64_t i = first_event(b); i < b->num_events; i++) {
+            trace_event_t *e = &b->events[i % TRACE_BUFFER_SIZE];
+
+            fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                    "\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n", e->name,
+                    b->tid, (e->begin - origin) / 1e3, e->duration / 1e3);
+            first = false;
+        }
+    }
+    fprintf(f, "\n]}\n");
+
+    fclose(f);
+}
+
+
+static void release_buffer(void *b) {
+    __atomic_store_n(&((trace_buffer_t *)b)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+
+static void init() {
+    pthread_key_create(&key, release_buffer);
+    atexit(write_trace);
+}
+
+
+// get_buffer returns the buffer of the calling thread, or NULL if it can't be
+// allocated.
+static trace_buffer_t *get_buffer() {
+    if (buffer != NULL) {
+        return buffer;
+    }
+
+    pthread_once(&once, init);
+
+    for (trace_buffer_t *b = __atomic_load_n(&buffers, __ATOMIC_ACQUIRE);
+         (b != NULL) && (buffer == NULL); b = b->next) {
+        int unused = 0;
+        if (__atomic_compare_exchange_n(&b->in_use, &unused, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            buffer = b;
+        }
+    }
+
+    if (buffer == NULL) {
+        buffer = calloc(1, sizeof(trace_buffer_t));
+        if (buffer == NULL) {
+            return NULL;
+        }
+
+        buffer->in_use = 1;
+        buffer->tid    = __atomic_fetch_add(&num_buffers, 1, __ATOMIC_RELAXED);
+        buffer->next   = __atomic_load_n(&buffers, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&buffers, &buffer->next, buffer,
+                                            false, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED)) {
+        }
+    }
+
+    pthread_setspecific(key, buffer);
+    return buffer;
+}
+
+
+// See header.
+trace_zone_t trace_zone_begin(const char *name) {
+    // The thread gets its buffer, and its row in the trace, with its first
+    // zone.
+    get_buffer();
+    return (trace_zone_t){ name, now() };
+}
+
+
+// See header.
+void trace_zone_end(trace_zone_t *zone) {
+    uint64_t       end = now();
+    trace_buffer_t *b  = buffer;
+
+    if (b == NULL) {
+        return;
+    }
+
+    b->events[b->num_events % TRACE_BUFFER_SIZE] = (trace_event_t){
+        zone->name, zone->begin, end - zone->begin
+    };
+    b->num_events++;
+}
+
+#endif
@@ -0,0 +1,50 @@
+// trace records how long zones of code take, thread by thread, and writes
+// them at exit in the Chrome trace event format: the file opens in
+// chrome://tracing or https://ui.perfetto.dev.
+//
+// Zones are compiled in with `make trace` (-DTRACE) only. Otherwise the
+// macros expand to nothing and nothing is recorded.
+//
+// The trace is written to `trace.json`, or to the file of the TRACE_FILE
+// environment variable. Each thread records its last TRACE_BUFFER_SIZE zones.
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#ifdef TRACE
+
+#include <stdint.h>
+
+// TRACE_BUFFER_SIZE is the number of zones kept per thread: older ones are
+// overwritten.
+#define TRACE_BUFFER_SIZE    65536
+
+// trace_zone_t is a zone being recorded.
+typedef struct {
+    const char *name;
+    uint64_t   begin; // In nanoseconds.
+} trace_zone_t;
+
+// trace_zone_begin starts recording a zone. `name` must live until the exit.
+trace_zone_t trace_zone_begin(const char *name);
+
+// trace_zone_end records the zone in the buffer of the calling thread.
+void trace_zone_end(trace_zone_t *zone);
+
+// TRACE_ZONE records a zone from this point to the end of the enclosing
+// block.
+#define TRACE_ZONE(name)                                    \
+    trace_zone_t __trace_zone                               \
+    __attribute__((cleanup(trace_zone_end), unused)) =      \
+        trace_zone_begin(name)
+
+#else
+
+#define TRACE_ZONE(name)
+
+#endif
+
+// TRACE_FUNCTION records a zone named after the function until it returns.
+#define TRACE_FUNCTION()    TRACE_ZONE(__func__)
+
+#endif
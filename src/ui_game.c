@@ -5,6 +5,8 @@
 #include "ui_game.h"
 #include "graphics.h"
 #include "ui_pause_menu.h"
+#include "ai_worker.h"
+#include "trace.h"
 
 static void input_append_position(mvt_t                *input,
                                   possible_positions_t *possible_positions,
@@ -84,15 +86,58 @@ static void update_possible_positions(game_state_to_draw_t *state) {
 }
 
 
+// UI_GAME_POLL_TIMEOUT_MS is how long events are waited for between two
+// checks of the AI worker.
+#define UI_GAME_POLL_TIMEOUT_MS    50
+
+// play_ai_mvt plays the movement of the AI of the current player once found.
+// The search runs on `worker`, or synchronously if there is no worker or its
+// thread cannot start. `info` is then set to the description of the search
+// (see `ai_get_info_callback_t`).
+// Returns true if a movement is played.
+static bool play_ai_mvt(ai_worker_t *worker, ai_callbacks_t *ai,
+                        void *ai_context, game_t *game, char *info) {
+    mvt_t mvt;
+
+    if ((worker != NULL) && !ai_worker_is_running(worker)) {
+        ai_worker_start(worker, ai, ai_context, game);
+    }
+
+    if ((worker != NULL) && ai_worker_is_running(worker)) {
+        if (!ai_worker_poll(worker, &mvt)) {
+            return false;
+        }
+        strcpy(info, ai_worker_info(worker));
+    } else {
+        if (ai->set_cancel != NULL) {
+            ai->set_cancel(ai_context, NULL); // The token of the worker.
+        }
+        mvt = game->turn == TIGER_TURN ? ai->get_tiger_mvt(ai_context, game) :
+              ai->get_goat_mvt(ai_context, game);
+        info[0] = '\0';
+        if (ai->get_info != NULL) {
+            ai->get_info(ai_context, info);
+        }
+    }
+
+    game_do_mvt(game, mvt);
+    return true;
+}
+
+
 bool ui_game_main(void                 *graphics_context,
                   graphics_callbacks_t graphics,
                   ai_callbacks_t       *tiger_ai,
                   ai_callbacks_t       *goat_ai,
                   char                 *winner) {
-    char                 msg[256] = "";
-    game_state_to_draw_t state    = {
+    TRACE_FUNCTION();
+
+    char                 msg[256]          = "";
+    char                 info[AI_INFO_LEN] = "";
+    game_state_to_draw_t state             = {
         .game = game_new(),
-        .msg  = msg
+        .msg  = msg,
+        .info = info
     };
 
     void *tiger_ai_context = NULL;
@@ -105,82 +150,117 @@ bool ui_game_main(void                 *graphics_context,
         goat_ai_context = goat_ai->new();
     }
 
+    // The AIs search on the worker while the events are polled.
+    ai_worker_t *worker = NULL;
+    if ((tiger_ai != NULL) || (goat_ai != NULL)) {
+        worker = ai_worker_new();
+    }
+
     event_t event;
     input_reset(&state.input);
 
     bool stop = false;
 
     while (!game_is_done(state.game) && !stop) {
+        bool           tiger_turn = state.game->turn == TIGER_TURN;
+        ai_callbacks_t *ai        = tiger_turn ? tiger_ai : goat_ai;
+        void           *ai_context = tiger_turn ? tiger_ai_context :
+                                     goat_ai_context;
+
         reset_possible_positions(&state.possible_positions);
+        if (ai == NULL) {
+            update_possible_positions(&state);
+        }
         graphics.draw_game(graphics_context, &state);
 
-        if ((tiger_ai != NULL) && (state.game->turn == TIGER_TURN)) {
-            game_do_mvt(state.game, tiger_ai->get_tiger_mvt(tiger_ai_context, state.game));
-        } else if ((goat_ai != NULL) && (state.game->turn == GOAT_TURN)) {
-            game_do_mvt(state.game, goat_ai->get_goat_mvt(goat_ai_context, state.game));
+        if (ai != NULL) {
+            if (play_ai_mvt(worker, ai, ai_context, state.game, info)) {
+                continue;
+            }
+            if (!graphics.poll_event_game(graphics_context, &event,
+                                          UI_GAME_POLL_TIMEOUT_MS)) {
+                continue;
+            }
         } else {
-            update_possible_positions(&state);
-            graphics.draw_game(graphics_context, &state);
-
+            // The AI of the opponent thinks meanwhile.
+            ai_callbacks_t *opponent = tiger_turn ? goat_ai : tiger_ai;
+            if ((worker != NULL) && (opponent != NULL) &&
+                !ai_worker_is_pondering(worker)) {
+                ai_worker_ponder(worker, opponent,
+                                 tiger_turn ? goat_ai_context : tiger_ai_context,
+                                 state.game);
+            }
             graphics.wait_event_game(graphics_context, &event);
-            switch (event.type) {
-            case EVENT_QUIT:
-                stop = ui_pause_menu(graphics_context, graphics);
-                break;
+        }
 
-            case EVENT_REDRAW:
-                break;
+        switch (event.type) {
+        case EVENT_QUIT:
+            ai_worker_cancel(worker);
+            stop = ui_pause_menu(graphics_context, graphics);
+            break;
 
-            case EVENT_POSITION:
+        case EVENT_REDRAW:
+            break;
+
+        case EVENT_POSITION:
+            if (ai == NULL) {
                 input_append_position(&state.input,
                                       &state.possible_positions,
                                       event.position);
-                break;
+            }
+            break;
+
+        case EVENT_KEY:
+            switch (event.key) {
+            case KEY_CH:
+                switch (event.ch) {
+                case 'Q':
+                    stop = true;
+                    break;
 
-            case EVENT_KEY:
-                switch (event.key) {
-                case KEY_CH:
-                    switch (event.ch) {
-                    case 'Q':
-                        stop = true;
-                        break;
-
-                    case 'U':
-                        if ((tiger_ai != NULL) || (goat_ai != NULL)) {
-                            game_undo(state.game);
-                        }
+                case 'U':
+                    // During a search, the movement of the other player is
+                    // undone. Otherwise the one of the AI is undone too.
+                    ai_worker_cancel(worker);
+                    if ((ai == NULL) && ((tiger_ai != NULL) || (goat_ai != NULL))) {
                         game_undo(state.game);
-                        break;
+                    }
+                    game_undo(state.game);
+                    break;
 
-                    default:
+                default:
+                    if (ai == NULL) {
                         input_append_from_tag(&state.input,
                                               &state.possible_positions,
                                               event.ch);
                     }
-                    break;
+                }
+                break;
 
-                case KEY_BACKSPACE:
+            case KEY_BACKSPACE:
+                if (ai == NULL) {
                     input_backspace(&state.input);
-                    break;
+                }
+                break;
 
-                case KEY_ESC:
-                    stop = ui_pause_menu(graphics_context, graphics);
-                    break;
+            case KEY_ESC:
+                ai_worker_cancel(worker);
+                stop = ui_pause_menu(graphics_context, graphics);
+                break;
 
-                default:
-                    // To remove gcc warning telling that other cases are not
-                    // being handled.
-                    break;
-                }
+            default:
+                // To remove gcc warning telling that other cases are not
+                // being handled.
                 break;
             }
+            break;
+        }
 
-            if (input_is_complete(&state)) {
-                if (!game_do_mvt(state.game, state.input)) {
-                    strcpy(msg, "Invalid movement");
-                }
-                input_reset(&state.input);
+        if ((ai == NULL) && input_is_complete(&state)) {
+            if (!game_do_mvt(state.game, state.input)) {
+                strcpy(msg, "Invalid movement");
             }
+            input_reset(&state.input);
         }
     }
 
@@ -189,6 +269,7 @@ bool ui_game_main(void                 *graphics_context,
         sprintf(winner, "%s", state.game->turn == TIGER_TURN ? "Goats" : "Tigers");
     }
 
+    ai_worker_free(worker);
 
     if (tiger_ai) {
         tiger_ai->free(tiger_ai_context);
@@ -0,0 +1,140 @@
+#include <stdbool.h>
+
+#include "zobrist.h"
+#include "symmetry.h"
+
+#define ZOBRIST_SEED    0x42616768436861ULL
+
+// Keys are indexed by [cell][token] with token 0 for goats and 1 for tigers.
+static uint64_t cell_keys[5 * 5][2];
+static uint64_t turn_key;
+static uint64_t num_goats_to_put_keys[21];
+static uint64_t num_eaten_goats_keys[21];
+static bool     initialized = false;
+
+
+// splitmix64 returns the next value of the splitmix64 generator.
+// See: http://xoshiro.di.unimi.it/splitmix64.c
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+static void zobrist_init() {
+    uint64_t state = ZOBRIST_SEED;
+
+    for (int i = 0; i < 5 * 5; i++) {
+        cell_keys[i][0] = splitmix64(&state);
+        cell_keys[i][1] = splitmix64(&state);
+    }
+
+    turn_key = splitmix64(&state);
+
+    for (int i = 0; i < 21; i++) {
+        num_goats_to_put_keys[i] = splitmix64(&state);
+        num_eaten_goats_keys[i]  = splitmix64(&state);
+    }
+
+    initialized = true;
+}
+
+
+// See header.
+uint64_t zobrist_cell_key(int cell, cell_state_t state) {
+    if (!initialized) {
+        zobrist_init();
+    }
+
+    switch (state) {
+    case GOAT_CELL:
+        return cell_keys[cell][0];
+
+    case TIGER_CELL:
+        return cell_keys[cell][1];
+
+    default:
+        return 0;
+    }
+}
+
+
+// See header.
+uint64_t zobrist_turn_key() {
+    if (!initialized) {
+        zobrist_init();
+    }
+
+    return turn_key;
+}
+
+
+// See header.
+uint64_t zobrist_goats_key(int num_goats_to_put, int num_eaten_goats) {
+    if (!initialized) {
+        zobrist_init();
+    }
+
+    return num_goats_to_put_keys[num_goats_to_put] ^
+           num_eaten_goats_keys[num_eaten_goats];
+}
+
+
+// See header.
+uint64_t zobrist_hash_board(board_t *board) {
+    uint64_t hash = 0;
+
+    for (int i = 0; i < 5 * 5; i++) {
+        hash ^= zobrist_cell_key(i, board->tab[i]);
+    }
+
+    return hash;
+}
+
+
+// zobrist_hash_extra returns the part of the hash which doesn't depend on the
+// board.
+static uint64_t zobrist_hash_extra(game_t *game) {
+    uint64_t hash = zobrist_goats_key(game->num_goats_to_put,
+                                      game->num_eaten_goats);
+
+    if (game->turn == TIGER_TURN) {
+        hash ^= zobrist_turn_key();
+    }
+
+    return hash;
+}
+
+
+// See header.
+uint64_t zobrist_hash_game(game_t *game) {
+    return zobrist_hash_board(&game->board) ^ zobrist_hash_extra(game);
+}
+
+
+// See header.
+uint64_t zobrist_canonical_hash(game_t *game, int *sym) {
+    uint64_t extra    = zobrist_hash_extra(game);
+    uint64_t best     = zobrist_hash_board(&game->board) ^ extra;
+    int      best_sym = SYMMETRY_IDENTITY;
+    board_t  board;
+
+    for (int s = 1; s < NUM_SYMMETRIES; s++) {
+        symmetry_board(s, &game->board, &board);
+
+        uint64_t hash = zobrist_hash_board(&board) ^ extra;
+        if (hash < best) {
+            best     = hash;
+            best_sym = s;
+        }
+    }
+
+    if (sym != NULL) {
+        *sym = best_sym;
+    }
+
+    return best;
+}
@@ -0,0 +1,41 @@
+#ifndef __ZOBRIST_H__
+#define __ZOBRIST_H__
+
+#include <stdint.h>
+
+#include "models.h"
+#include "game.h"
+
+// Zobrist hashing gives every (cell, token) pair, the player turn and the goat
+// counters a random 64 bits key. The hash of a position is the xor of the keys
+// of what is on the board, so it can be updated in a few operations when a
+// movement is done.
+// See: https://en.wikipedia.org/wiki/Zobrist_hashing
+//
+// Keys are generated from a fixed seed: hashes are stable from one run to
+// another and can be stored in files.
+
+// zobrist_cell_key returns the key of the cell index `cell` (r * 5 + c) holding
+// `state`. Empty cells have a null key.
+uint64_t zobrist_cell_key(int cell, cell_state_t state);
+
+// zobrist_turn_key returns the key xored in when tigers have to play.
+uint64_t zobrist_turn_key();
+
+// zobrist_goats_key returns the key of the goat counters.
+uint64_t zobrist_goats_key(int num_goats_to_put, int num_eaten_goats);
+
+// zobrist_hash_board returns the hash of the tokens on the board.
+uint64_t zobrist_hash_board(board_t *board);
+
+// zobrist_hash_game returns the hash of the whole game state: board, turn and
+// goat counters.
+uint64_t zobrist_hash_game(game_t *game);
+
+// zobrist_canonical_hash returns the smallest hash of the game among all its
+// symmetric versions. Symmetric positions then share the same hash.
+// If `sym` is not NULL, it is set to the symmetry which transforms the game
+// into the one with the canonical hash.
+uint64_t zobrist_canonical_hash(game_t *game, int *sym);
+
+#endif